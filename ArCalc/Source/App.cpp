@@ -8,7 +8,6 @@
 
 namespace ArCalc {
 	App::App() : 
-		m_pParser{std::make_unique<Parser>(std::cout)}, 
 		hConsole{GetStdHandle(STD_OUTPUT_HANDLE)}
 	{
 		constexpr auto error = [](auto const message) {
@@ -27,13 +26,14 @@ namespace ArCalc {
 	}
 
 	void App::Run() {
+		auto& parser{m_Session.GetParser()};
 
 		for (;;) {
 			constexpr auto Tab{"...."};
 			auto const indentation = [&, this] {
 				auto res = std::string{};
 				// Indent the code inside the defination.
-				if (m_pParser->IsParsingFunction()) { 
+				if (parser.IsParsingFunction()) { 
 					res.append(Tab);
 				}
 
@@ -42,15 +42,17 @@ namespace ArCalc {
 
 			constexpr auto errorPrefix{"ERROR: "};
 
-			IO::PrintStd("{:0>3} | ", m_pParser->GetLineNumber());
+			m_OutputSink.Flush();
+			IO::PrintStd("{:0>3} | ", parser.GetLineNumber());
 			IO::OutputStd(indentation);
 
 			try { 
-				m_pParser->ParseLine(IO::GetLineStd());
+				m_Session.ParseLine(IO::GetLineStd());
 				continue;
 			} 
 #ifndef NDEBUG
 			catch (DebugAssertionError const& err) {
+				m_OutputSink.Flush();
 				err.PrintMessage(errorPrefix);
 			}
 #endif // ^^^^ Debug mode only.
@@ -59,15 +61,16 @@ namespace ArCalc {
 					// Exceptions that get thrown one level deep do not encounter 
 					// a try-catch block in the way, which means nothing sets their 
 					// line number to anything.
-					err.SetLineNumber(m_pParser->GetLineNumber());
+					err.SetLineNumber(parser.GetLineNumber());
 				}
 
+				m_OutputSink.Flush();
 				err.PrintMessage(errorPrefix);
 			} catch (std::exception const& err) {
 				IO::Print(std::cerr, "Caught a std::exception {}.\n", err.what());
 				std::terminate();
 			}
-			m_pParser->ExceptionReset();
+			parser.ExceptionReset();
 		}
 	}
 }
\ No newline at end of file
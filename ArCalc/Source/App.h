@@ -2,7 +2,8 @@
 
 #include "Core.h"
 #include "Util/Util.h"
-#include "Parser.h"
+#include "Engine.h"
+#include "Util/OutputSink.h"
 
 /** Conventions:
  *
@@ -22,7 +23,12 @@ namespace ArCalc {
 		void Run();
 
 	private:
-		std::unique_ptr<Parser> m_pParser{};
+		// Results are only written out before prompting for the next line, or reporting an error.
+		OutputSink m_OutputSink{std::cout};
+		std::ostream m_Output{&m_OutputSink};
+
+		Engine m_Engine{};
+		Engine::Session m_Session{m_Engine.CreateSession(m_Output)};
 		HANDLE hConsole{};
 	};
 }
\ No newline at end of file
@@ -1,10 +1,47 @@
 #include "PostfixMathEvaluator.h"
 #include "App.h"
+#include "Server.h"
+#include "ShardedSweep.h"
 #include "Exception/ArCalcException.h"
 
-int main() {
+namespace {
+	// Runs until "stop" is entered, or the standard input is closed.
+	void Serve(ArCalc::fs::path const& socketPath, ArCalc::Server::Options const& options) {
+		auto server = ArCalc::Server{socketPath, options};
+		auto serving = std::jthread{[&] { server.Run(); }};
+
+		std::cout << std::format("Serving on [{}]. Enter \"stats\" to see how it is doing, "
+			"or \"stop\" to stop.\n", socketPath.string());
+		for (auto line = std::string{}; std::getline(std::cin, line) && line != "stop";) {
+			if (line == "stats") {
+				server.PrintReport(std::cout);
+			}
+		}
+
+		server.Stop();
+		serving.join();
+		server.PrintReport(std::cout);
+	}
+}
+
+// ArCalc                                   => interactive console.
+// ArCalc --serve <socket path> [workers]   => server, see ArCalc::Server.
+// ArCalc --sweep-shard <directory> <shard> => worker, see ArCalc::ShardedSweep.
+int main(int argc, char* argv[]) {
 	namespace calc = ArCalc;
+	auto const args{std::span{argv, static_cast<size_t>(argc)}};
 	try {
+		if (args.size() >= 3U && args[1] == std::string_view{"--serve"}) {
+			auto options = calc::Server::Options{};
+			if (args.size() >= 4U) {
+				options.WorkerCount = std::stoul(args[3]);
+			}
+			Serve(args[2], options);
+			return 0;
+		} else if (args.size() >= 4U && args[1] == calc::ShardedSweep::sc_WorkerArg) {
+			return calc::ShardedSweep::RunWorker(args[2], std::stoul(args[3]));
+		}
+
 		calc::App app{};
 		app.Run();
 	} catch (calc::ArCalcException const& err) {
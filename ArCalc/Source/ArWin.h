@@ -4,4 +4,9 @@
 #define NOMINMAX
 #endif // NOMINMAX
 
+// Also keeps the old winsock.h out, which would clash with winsock2.h (see LocalSocket).
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+
 #include <Windows.h>
\ No newline at end of file
@@ -30,6 +30,20 @@
 #include <stacktrace>
 #include <random>
 #include <charconv>
+#include <memory_resource>
+#include <span>
+#include <bit>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <semaphore>
+#include <deque>
+#include <utility>
+#include <iterator>
+#include <chrono>
+#include <climits>
 
 namespace ArCalc {
 	using size_t    = std::size_t;
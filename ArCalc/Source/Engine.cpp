@@ -0,0 +1,23 @@
+#include "Engine.h"
+
+namespace ArCalc {
+	Engine::Session::Session(std::ostream& os, std::seed_seq& seeds, ThreadPool& pool) 
+		: m_Parser{os}, m_Rng{seeds} 
+	{
+		m_Parser.SetThreadPool(&pool);
+	}
+
+	void Engine::Session::ParseLine(std::string_view line) {
+		auto const boundRng{Random::ScopedGenerator{m_Rng}};
+		m_Parser.ParseLine(line);
+	}
+
+	Engine::Engine() : Engine{std::random_device{}()} {}
+
+	Engine::Engine(std::uint32_t seed, size_t workerCount) : m_Seed{seed}, m_Pool{workerCount} {}
+
+	Engine::Session Engine::CreateSession(std::ostream& os) {
+		auto seeds = std::seed_seq{m_Seed, m_SessionCount.fetch_add(1U, std::memory_order_relaxed)};
+		return Session{os, seeds, m_Pool};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Core.h"
+#include "Parser.h"
+#include "Util/Random.h"
+#include "Util/ThreadPool.h"
+
+namespace ArCalc {
+	/// Runs any number of independent sessions, each one being a Parser with its own
+	/// literals, functions, output and random number generator. The sessions share the
+	/// thread pool of the engine, to spread their work between cores.
+	///
+	/// Thread safety:
+	///  - The operator, constant and keyword tables are constexpr, so every session
+	///    reads the same tables without any synchronization.
+	///  - CreateSession can be called from several threads at the same time.
+	///  - A session must only be used by one thread at a time, but different sessions
+	///    can run on different threads at the same time, without taking any locks.
+	///  - The thread pool can be used from any thread.
+	///  - Categories, snapshots and the script cache are files shared by all sessions,
+	///    saving to the same one from two sessions at the same time is not synchronized.
+	class Engine {
+	public:
+		class Session {
+		public:
+			Session(std::ostream& os, std::seed_seq& seeds, ThreadPool& pool);
+
+		public:
+			// Same as Parser::ParseLine, with Random using the session's generator.
+			void ParseLine(std::string_view line);
+
+			Parser& GetParser() { return m_Parser; }
+			Random::Generator& GetGenerator() { return m_Rng; }
+
+		private:
+			Parser m_Parser;
+			Random::Generator m_Rng;
+		};
+
+	public:
+		Engine();
+		// A [workerCount] of 0 means one worker per core.
+		Engine(std::uint32_t seed, size_t workerCount = 0U);
+		Engine(Engine const&)            = delete;
+		Engine(Engine&&)                 = delete;
+		Engine& operator=(Engine const&) = delete;
+		Engine& operator=(Engine&&)      = delete;
+
+	public:
+		// The n-th session of engines made with the same seed starts with the same random state.
+		Session CreateSession(std::ostream& os);
+
+		constexpr std::uint32_t GetSeed() const {
+			return m_Seed;
+		}
+
+		ThreadPool& GetPool() {
+			return m_Pool;
+		}
+
+	private:
+		std::uint32_t m_Seed;
+		std::atomic<std::uint32_t> m_SessionCount{};
+		ThreadPool m_Pool;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "EvaluatorPool.h"
+
+namespace ArCalc {
+	EvaluatorPool::Lease::Lease(std::unique_ptr<PostfixMathEvaluator>&& pEval)
+		: m_pEval{std::move(pEval)}
+	{
+	}
+
+	EvaluatorPool::Lease::~Lease() {
+		if (m_pEval) { // Moved-from leases own nothing.
+			EvaluatorPool::Release(std::move(m_pEval));
+		}
+	}
+
+	EvaluatorPool::Lease EvaluatorPool::Acquire(LiteralManager& litMan, FunctionManager& funMan,
+		std::pmr::memory_resource& tempMem) 
+	{
+		auto pEval = [&] {
+			if (s_Idle.empty()) {
+				return std::make_unique<PostfixMathEvaluator>(litMan, funMan);
+			}
+
+			auto res{std::move(s_Idle.back())};
+			s_Idle.pop_back();
+			return res;
+		}(/*)(*/);
+
+		pEval->Rebind(litMan, funMan, tempMem);
+		return Lease{std::move(pEval)};
+	}
+
+	size_t EvaluatorPool::IdleCount() {
+		return s_Idle.size();
+	}
+
+	void EvaluatorPool::Release(std::unique_ptr<PostfixMathEvaluator>&& pEval) {
+		// An evaluator that threw mid-expression is left in an arbitrary state.
+		pEval->Reset();
+		s_Idle.push_back(std::move(pEval));
+	}
+}
\ No newline at end of file
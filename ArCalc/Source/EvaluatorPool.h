@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Core.h"
+#include "PostfixMathEvaluator.h"
+
+namespace ArCalc {
+	/// Hands out already warmed-up evaluators, so their string accumulators and value
+	/// stacks keep their capacity from one expression to the next.
+	///
+	/// The pool is per-thread, which means that the sub-parsers created for every
+	/// function call share it with the parser that made the call. An evaluator is
+	/// only idle while nobody holds a lease on it, so the pool never grows bigger
+	/// than the deepest chain of nested calls seen on that thread.
+	class EvaluatorPool {
+	public:
+		/// Owns an evaluator until it goes out of scope, then resets it and gives
+		/// it back to the pool (even when unwinding).
+		class Lease {
+		public:
+			Lease(std::unique_ptr<PostfixMathEvaluator>&& pEval);
+			Lease(Lease const&)            = delete;
+			Lease(Lease&&)                 = default;
+			Lease& operator=(Lease const&) = delete;
+			Lease& operator=(Lease&&)      = delete;
+			~Lease();
+
+		public:
+			PostfixMathEvaluator& operator*()  { return *m_pEval; }
+			PostfixMathEvaluator* operator->() { return m_pEval.get(); }
+
+		private:
+			std::unique_ptr<PostfixMathEvaluator> m_pEval;
+		};
+
+	public:
+		EvaluatorPool() = delete;
+
+	public:
+		static Lease Acquire(LiteralManager& litMan, FunctionManager& funMan, 
+			std::pmr::memory_resource& tempMem = *std::pmr::get_default_resource());
+		static size_t IdleCount();
+
+	private:
+		static void Release(std::unique_ptr<PostfixMathEvaluator>&& pEval);
+
+	private:
+		inline static thread_local std::vector<std::unique_ptr<PostfixMathEvaluator>> s_Idle{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	class ArCalcException;
+
+	/// Receives what the lines given to a parser produce, as values rather than text, so 
+	/// embedders do not have to parse the output back. TextResultSink prints them the way 
+	/// the parser always has.
+	/// 
+	/// Values and literals are only reported when they would have been printed, i.e. not for 
+	/// lines ending with a semicolon, nor while output is toggled off. Functions defined in 
+	/// the script and errors are always reported. Nothing that happens inside function 
+	/// calls is reported.
+	class IResultSink {
+	public:
+		virtual ~IResultSink() = default;
+
+	public:
+		// Empty for expressions that return None.
+		virtual void OnValue(size_t lineNumber, std::optional<double> value) = 0;
+		virtual void OnLiteralSet(size_t lineNumber, std::string_view name, double value) = 0;
+
+		// One point of a _Sweep, the arguments in the order the parameters were swept. Ignored 
+		// unless overridden, so sinks written before sweeps existed keep working.
+		virtual void OnSweepPoint(size_t /* lineNumber */, std::span<double const> /* args */, 
+			double /* value */) {}
+
+		// [lineNumber] is the one of the header.
+		virtual void OnFunctionDefined(size_t lineNumber, std::string_view name) = 0;
+
+		// [err] is thrown out of Parser::ParseLine right after this returns.
+		virtual void OnError(size_t lineNumber, ArCalcException const& err) = 0;
+	};
+}
\ No newline at end of file
@@ -47,20 +47,49 @@ namespace ArCalc {
 		Elif,
 
 		/*
-			_Save [constant or function name] [category]
+			_Save [constant or function name] [category] [format]
 
 			Serializes a constant or a function to disc, so it is ready to use in 
-			the next session.
+			the next session. The format is either binary (the default), or text
+			which is meant for exporting.
 		*/
 		Save,
 
 		/*
 			_Load [category]
 
-			Loads an already serialized set of values from disc.
+			Loads an already serialized set of values from disc, in either format.
+			The functions of binary categories are only read when first called.
+			--------------------------------------------------------------------
+			_Load [category] [name]
+
+			Loads only [name] from a binary category, along with the functions it calls 
+			that were saved in the same category.
 		*/
 		Load,
 
+		/*
+			_Compact [category]
+
+			Rewrites the category with only the latest save of each name, _Save 
+			also does it on its own once binary categories grow stale enough.
+		*/
+		Compact,
+
+		/*
+			_Snapshot [name]
+
+			Saves every literal and function of the session in one file.
+			--------------------------------------------------------------------
+			_Restore [name]
+
+			Maps a snapshot into memory and defines everything in it, without
+			reading the function bodies until they are called. Processes that
+			restore the same snapshot share its pages.
+		*/
+		Snapshot,
+		Restore,
+
 		/*
 			_Unscope 
 
@@ -94,6 +123,26 @@ namespace ArCalc {
 		Sum,
 		Mul,
 
+		/*
+			_Sweep [function] {[parameter] [first] [last (inclusive)] [step]}... [file, opt] 
+				[process count, opt]
+
+			Calls the function with every combination of the values of its parameters, 
+			each of which must be swept exactly once, and none of which may be by reference.
+			The last parameter of the line changes the fastest. Every point is reported as
+			the values of the parameters in the order of the line, followed by the result, 
+			either to the result sink or, if given, to [file] (one point per line).
+
+			The function is only prepared once, and the points are split between threads, 
+			but still come out in order. The first point to fail stops the sweep.
+
+			Given a [process count], the points are split into shards run by that many
+			ArCalc processes at a time (see ShardedSweep). A shard that fails or crashes is
+			reported once the others are done, and running the line again only runs the 
+			shards that did not finish.
+		*/
+		Sweep,
+
 		/*
 			_Set [Name] [Make]
 
@@ -1,10 +1,18 @@
 #include "Parser.h"
 #include "KeywordType.h"
 #include "Util/Util.h"
-#include "PostfixMathEvaluator.h"
+#include "EvaluatorPool.h"
+#include "ShardedSweep.h"
+#include "StatementGraph.h"
+#include "Sweep.h"
 #include "Util/FunctionManager.h"
 #include "Util/Str.h"
 #include "Util/IO.h"
+#include "Util/CategoryFile.h"
+#include "Util/MappedFile.h"
+#include "Util/OutputSink.h"
+#include "Util/ScriptCache.h"
+#include "Util/LineReader.h"
 #include "Util/MathConstant.h"
 #include "Util/MathOperator.h"
 
@@ -31,6 +39,38 @@ namespace ArCalc {
 		FoundRightCurly = Secret::FormatBit | 2,
 	};
 
+	namespace Secret {
+		// Batches smaller than twice this are not worth splitting between threads.
+		constexpr size_t sc_BatchGrainSize{2048U};
+
+		// Copies of the scope that a chunk of a parallel batch evaluates in, so that nothing 
+		// of the parser is shared between threads.
+		struct BatchScope {
+			BatchScope(LiteralManager const& litMan, FunctionManager const& funMan) 
+				: LitMan{litMan}, FunMan{funMan}, Eval{EvaluatorPool::Acquire(LitMan, FunMan, Arena.Resource())}
+			{
+				Eval->CacheSymbols();
+			}
+
+			LiteralManager LitMan;
+			FunctionManager FunMan;
+			LineArena Arena{};
+			EvaluatorPool::Lease Eval;
+		};
+
+		void EvalBatchItem(PostfixMathEvaluator& eval, LineArena& arena, std::string_view expr, 
+			EvalResult& result) 
+		{
+			try {
+				result.Value = eval.Eval(expr);
+			} catch (ArCalcException const&) {
+				result.pError = std::current_exception();
+				eval.Reset();
+			}
+			arena.Reset();
+		}
+	}
+
 	void Parser::ConditionInfo::Unreset() {
 		ARCALC_DA(!m_bAvail, "Unreset may only be called on reset condition");
 		m_bAvail = true;
@@ -42,7 +82,7 @@ namespace ArCalc {
 	}
 
 	Parser::Parser(std::ostream& os) 
-		: m_CurrState{St::Default}, m_pOutStream{&os}, m_FunMan{os}, m_LitMan{os}
+		: m_CurrState{St::Default}, m_pOutStream{&os}, m_TextSink{os}, m_FunMan{os}, m_LitMan{os}
 	{
 		m_LitMan.SetLast(0.0);
 	}
@@ -54,20 +94,35 @@ namespace ArCalc {
 		IncrementLineNumber();
 		m_FunMan.CopyMapFrom(funMan);
 		m_LitMan.SetMap(litMap);
+		SetThreadPool(funMan.GetThreadPool());
 	}
 
 	void Parser::ParseFile(fs::path const& filePath) {
-		if (std::ifstream file{filePath}; file.is_open()) {
-			ParseIStream(file);
-		} else {
-			throw ParseError{"Parser::ParseFile on Invalid file [{}]", filePath.string()};
-		}
+		ParseFile(filePath, std::cout);
 	}
 
 	void Parser::ParseFile(fs::path const& filePath, fs::path const& outFilePath) {
-		if (std::ifstream file{filePath}; file.is_open()) {
-			std::ofstream outFile{outFilePath};
-			ParseIStream(file, outFile);
+		std::ofstream outFile{outFilePath};
+		ParseFile(filePath, outFile);
+	}
+
+	void Parser::ParseFile(fs::path const& filePath, std::ostream& resultOStream) {
+		ParseFile(filePath, resultOStream, nullptr);
+	}
+
+	void Parser::ParseFile(fs::path const& filePath, std::ostream& resultOStream, ThreadPool* pPool) {
+		// Regular files are mapped rather than read, so they can be hashed up front to look 
+		// for a cached script, without holding a copy of them in memory.
+		if (fs::is_regular_file(filePath)) {
+			MappedFile const file{filePath};
+			auto const text{file.GetBytes()};
+
+			LineReader reader{text};
+			ParseLines(reader, resultOStream, text.size() <= ScriptCache::sc_MaxScriptSize 
+				? std::optional{ScriptCache::KeyOf(text)} : std::nullopt, 
+				text.size() >= ScriptPipeline::sc_MinAsyncScriptSize, pPool);
+		} else if (std::ifstream file{filePath}; file.is_open()) {
+			ParseIStream(file, resultOStream, pPool);
 		} else {
 			throw ParseError{"Parser::ParseFile on Invalid file [{}]", filePath.string()};
 		}
@@ -78,15 +133,277 @@ namespace ArCalc {
 	}
 
 	void Parser::ParseIStream(std::istream& is, std::ostream& resultOStream) {
-		auto const streamBytes{IO::IStreamToString(is)};
+		ParseIStream(is, resultOStream, nullptr);
+	}
+
+	void Parser::ParseIStream(std::istream& is, std::ostream& resultOStream, ThreadPool* pPool) {
+		// Streams may not be seekable (e.g. pipes), so they are run as they are read, and 
+		// can only be looked up in the cache the next time they are run as a file. They are 
+		// not read ahead either, as the next line might only come after this one's output, 
+		// unless given a pool to run the statements in between with.
+		LineReader reader{is};
+		ParseLines(reader, resultOStream, std::nullopt, false, pPool);
+	}
+
+	void Parser::ParseLines(LineReader& reader, std::ostream& resultOStream, 
+		std::optional<ScriptCache::SourceKey> sourceKey, bool bPipelined, ThreadPool* pPool) 
+	{
+		// Results are written in large chunks, on another thread when lines are read on one 
+		// too. Whatever was printed before an error still gets written by the destructor.
+		OutputSink sink{resultOStream, bPipelined};
+		std::ostream output{&sink};
+		reader.SetFlushBeforeWaiting(&output);
+		ScriptPipeline lines{reader, bPipelined};
+
+		// Function definitions are validated by running their bodies, which only has to be 
+		// done the first time a script is run.
+		auto subParser = Parser{output};
+		subParser.SetThreadPool(pPool);
+		auto graph = std::optional<StatementGraph>{};
+		if (pPool) {
+			graph.emplace(output, subParser.m_LitMan, subParser.m_FunMan);
+		}
+
+		auto const pGraph{graph ? &*graph : nullptr};
+		if (sourceKey) {
+			if (auto const cachedFunctions{ScriptCache::FindScript(*sourceKey)}) {
+				subParser.ReplayLines(lines, *cachedFunctions, pGraph);
+				sink.Flush();
+				return;
+			}
+		}
+
+		// The reader is only done once the pipeline handed out every line.
+		auto const functions{subParser.RecordLines(lines, pGraph)};
+		sink.Flush();
+		if (!functions.empty() && reader.GetSize() <= ScriptCache::sc_MaxScriptSize) {
+			try { ScriptCache::StoreScript({.Hash{reader.GetHash()}, .Size{reader.GetSize()}}, functions); } 
+			catch (std::exception const&) {
+				// The cache only makes the next run faster, so failing to write it is fine.
+			}
+		}
+	}
+
+	std::vector<ScriptCache::CachedFunction> Parser::RecordLines(ScriptPipeline& lines, StatementGraph* pGraph) {
+		std::vector<ScriptCache::CachedFunction> res{};
+		auto funcName = std::string{};
+		auto firstLine = size_t{};
+
+		while (auto const pLine{lines.Next()}) {
+			if (pGraph && DeferLine(*pGraph, pLine->Text)) {
+				continue;
+			}
+
+			auto const i{pLine->Index};
+			auto const bWasDefining{GetState() == St::Val_LineCollection};
+			ParseLine(*pLine);
+
+			if (auto const bDefining{GetState() == St::Val_LineCollection}; !bWasDefining && bDefining) {
+				funcName = m_FunMan.CurrFunctionName();
+				firstLine = i;
+			} else if (bWasDefining && !bDefining && m_FunMan.IsDefined(funcName)) {
+				// Definitions that got unscoped are not cached, so they are parsed again.
+				std::string record{};
+				BinaryWriter out{record};
+				m_FunMan.SerializeBinary(funcName, out);
+				res.push_back({
+					.FirstLine{static_cast<std::uint32_t>(firstLine)},
+					.LineCount{static_cast<std::uint32_t>(i + 1U - firstLine)},
+					.Record{std::move(record)},
+					.CalleesHash{ScriptCache::HashCallees(m_FunMan, funcName)},
+				});
+			}
+		}
+
+		if (pGraph) {
+			RunDeferred(*pGraph);
+		}
+		return res;
+	}
+
+	void Parser::ReplayLines(ScriptPipeline& lines, std::span<ScriptCache::CachedFunction const> functions, 
+		StatementGraph* pGraph) 
+	{
+		auto funcIt{functions.begin()};
+		while (auto const pLine{lines.Next()}) {
+			if (pGraph && DeferLine(*pGraph, pLine->Text)) {
+				continue;
+			}
+
+			auto const i{pLine->Index};
+			while (funcIt != functions.end() && funcIt->FirstLine < i) { // Only if corrupted.
+				++funcIt;
+			}
 
-		auto subParser = Parser{resultOStream};
-		for (auto const& line : Str::SplitOn<std::string_view>(streamBytes, "\n", false)) {
-			subParser.ParseLine(line);
+			if (funcIt != functions.end() && funcIt->FirstLine == i) {
+				if (auto const& func{*funcIt++}; DefineCachedFunction(lines, pLine->Text, func)) {
+					continue;
+				}
+			}
+
+			ParseLine(*pLine);
+		}
+
+		if (pGraph) {
+			RunDeferred(*pGraph);
 		}
 	}
 
+	bool Parser::DeferLine(StatementGraph& graph, std::string_view line) {
+		auto const bDeferred = [&] {
+			if (GetState() != St::Default) {
+				return false;
+			}
+
+			auto expr{Str::Trim<std::string_view>(line)};
+			auto const bSemiColon{!expr.empty() && expr.back() == ';'};
+			if (bSemiColon) {
+				expr.remove_suffix(1U);
+			}
+
+			// Only _Sets that can not fail or warn before evaluating their value are taken.
+			auto target = std::string_view{};
+			if (auto const keyword{Keyword::FromString(Str::GetFirstToken<std::string_view>(expr))}) {
+				if (*keyword == KeywordType::Set) {
+					Str::ChopFirstToken<std::string_view>(expr);
+					target = Str::ChopFirstToken<std::string_view>(expr);
+					if (target.empty() || !IsValidIdentifier(target) || m_FunMan.IsDefined(target)
+						|| MathConstant::IsValid(target) || MathOperator::IsValid(target))
+					{
+						return false;
+					}
+				} else if (*keyword != KeywordType::Last) {
+					return false;
+				}
+			}
+
+			if (graph.GetSize() == StatementGraph::sc_MaxSize) {
+				RunDeferred(graph);
+			}
+			return graph.Add(Str::Trim<std::string_view>(expr), target, bSemiColon);
+		}(/*)(*/);
+
+		if (!bDeferred) {
+			RunDeferred(graph);
+		}
+		return bDeferred;
+	}
+
+	void Parser::RunDeferred(StatementGraph& graph) {
+		if (graph.IsEmpty()) {
+			return;
+		}
+
+		graph.Run(*m_pPool);
+		for (auto const& stmt : graph.GetStatements()) {
+			m_bSemiColon = stmt.bSemiColon;
+			if (stmt.IsBlank()) {
+				IncrementLineNumber();
+				continue;
+			}
+			m_bConditionRegister.Reset();
+
+			if (stmt.pError) {
+				auto const pError{stmt.pError};
+				graph.Clear();
+				try { std::rethrow_exception(pError); } 
+				catch (ArCalcException& err) {
+					err.SetLineNumber(GetLineNumber());
+					GetResultSink().OnError(GetLineNumber(), err);
+					throw;
+				}
+			}
+
+			ARCALC_DA(stmt.Value.has_value(), "Applying statement [{}] that never ran", stmt.Text);
+			if (stmt.Target.empty()) {
+				m_LitMan.SetLast(*stmt.Value);
+				if (IsResultShown()) {
+					GetResultSink().OnValue(GetLineNumber(), stmt.Value);
+				}
+			} else {
+				if (m_LitMan.IsVisible(stmt.Target)) {
+					*m_LitMan.Get(stmt.Target) = *stmt.Value;
+				} else {
+					m_LitMan.Add(stmt.Target, *stmt.Value);
+				}
+
+				if (IsResultShown()) {
+					GetResultSink().OnLiteralSet(GetLineNumber(), stmt.Target, *stmt.Value);
+				}
+			}
+			IncrementLineNumber();
+		}
+		graph.Clear();
+	}
+
+	bool Parser::DefineCachedFunction(ScriptPipeline& lines, std::string_view headerLine, 
+		ScriptCache::CachedFunction const& func) 
+	{
+		if (GetState() != St::Default || func.Record.empty() || func.LineCount == 0U) {
+			return false;
+		}
+
+		BinaryReader in{func.Record};
+		if (static_cast<char>(in.ReadU8()) != CategoryFile::sc_FunctionTag) {
+			return false;
+		}
+
+		// Whether the header is valid depends on what ran before it, so those checks are not
+		// skipped; the definition is parsed again to report the error instead.
+		auto const funcName = [&] {
+			try { return BinaryReader{in}.ReadString(); } 
+			catch (IOError const&) { return std::string_view{}; }
+		}(/*)(*/);
+
+		if (funcName.empty() || m_LitMan.IsVisible(funcName) || m_FunMan.IsDefined(funcName)) {
+			return false;
+		}
+
+		try { m_FunMan.DeserializeBinary(in); } 
+		catch (IOError const&) { return false; }
+
+		// Nor is it valid if what it calls changed since (e.g. in a loaded category).
+		auto const bSameCallees = [&] {
+			try { return ScriptCache::HashCallees(m_FunMan, funcName) == func.CalleesHash; } 
+			catch (ArCalcException const&) { return false; }
+		}(/*)(*/);
+
+		if (!bSameCallees) {
+			m_FunMan.Delete(funcName);
+			return false;
+		}
+
+		// The rest of the definition is skipped, only its last line matters for the semicolon.
+		auto const endsWithSemiColon = [](std::string_view line) {
+			return Str::TrimRight<std::string_view>(line).ends_with(';');
+		};
+
+		m_bSemiColon = endsWithSemiColon(headerLine);
+		for ([[maybe_unused]] auto const _ : view::iota(1U, func.LineCount)) {
+			if (auto const pLine{lines.Next()}) {
+				m_bSemiColon = endsWithSemiColon(pLine->Text);
+			} else break;
+		}
+		PrintShadowingWarnings(funcName);
+		if (!IsExecutingFunction()) {
+			GetResultSink().OnFunctionDefined(GetLineNumber(), funcName);
+		}
+
+		IncrementLineNumber(func.LineCount);
+		return true;
+	}
+
 	void Parser::ParseLine(std::string_view line) {
+		try { ParseLineImpl(line); } 
+		catch (ArCalcException const& err) {
+			if (!IsExecutingFunction()) {
+				GetResultSink().OnError(err.GetLineNumber() ? err.GetLineNumber() : GetLineNumber(), err);
+			}
+			throw;
+		}
+	}
+
+	void Parser::ParseLineImpl(std::string_view line) {
 		m_bJustHitReturn = {}; // Reset the return statement flag.
 
 		m_CurrentLine = Str::Trim<std::string_view>(line);
@@ -134,10 +451,30 @@ namespace ArCalc {
 		}
 
 		IncrementLineNumber();
+		m_pLineArena->Reset();
+	}
+
+	void Parser::ParseLine(ScriptPipeline::Line const& line) {
+		m_pPreparedExpr = line.Expr.Source.empty() ? nullptr : &line.Expr;
+		try { ParseLine(line.Text); } 
+		catch (...) {
+			m_pPreparedExpr = {};
+			throw;
+		}
+		m_pPreparedExpr = {};
 	}
 
 	void Parser::SetOStream(std::ostream& toWhat) {
 		m_pOutStream = &toWhat;
+		m_TextSink.SetOStream(toWhat);
+	}
+
+	void Parser::SetResultSink(IResultSink* pSink) {
+		m_pCustomSink = pSink;
+	}
+
+	IResultSink& Parser::GetResultSink() {
+		return m_pCustomSink ? *m_pCustomSink : m_TextSink;
 	}
 
 	std::ostream& Parser::GetOStream() {
@@ -172,6 +509,7 @@ namespace ArCalc {
 
 	void Parser::ExceptionReset() {
 		IncrementLineNumber();
+		m_pLineArena->Reset();
 	}
 
 	void Parser::ToggleOutput() {
@@ -181,7 +519,7 @@ namespace ArCalc {
 	}
 
 	void Parser::HandleFirstToken() {
-		auto const firstToken{Str::GetFirstToken(m_CurrentLine)};
+		auto const firstToken{Str::GetFirstToken<std::string_view>(m_CurrentLine)};
 		if (auto const keyword{Keyword::FromString(firstToken)}; !keyword) {
 			m_bConditionRegister.Reset();
 			// Assume it's a normal expression and show its result in the next line.
@@ -196,31 +534,89 @@ namespace ArCalc {
 			}
 
 			switch (*keyword) {
-			case KT::Set:     HandleSetKeyword(); break;
-			case KT::Last:    HandleNormalExpression(); break;
-			case KT::List:    HandleListKeyword(); break;
-			case KT::Func:    HandleFuncKeyword(); break;
-			case KT::Return:  HandleReturnKeyword(); break;
+			case KT::Set:      HandleSetKeyword(); break;
+			case KT::Last:     HandleNormalExpression(); break;
+			case KT::List:     HandleListKeyword(); break;
+			case KT::Func:     HandleFuncKeyword(); break;
+			case KT::Return:   HandleReturnKeyword(); break;
 			case KT::If:
 			case KT::Else:
-			case KT::Elif:    HandleSelectionKeyword(); break;
-			case KT::Save:    HandleSaveKeyword(); break;
-			case KT::Load:    HandleLoadKeyword(); break;
-			case KT::Unscope: HandleUnscopeKeyword(); break;
-			case KT::Err:     HandleErrKeyword(); break;
-			default:         ARCALC_UNREACHABLE_CODE();
+			case KT::Elif:     HandleSelectionKeyword(); break;
+			case KT::Save:     HandleSaveKeyword(); break;
+			case KT::Load:     HandleLoadKeyword(); break;
+			case KT::Compact:  HandleCompactKeyword(); break;
+			case KT::Snapshot: HandleSnapshotKeyword(); break;
+			case KT::Restore:  HandleRestoreKeyword(); break;
+			case KT::Unscope:  HandleUnscopeKeyword(); break;
+			case KT::Err:      HandleErrKeyword(); break;
+			case KT::Sweep:    HandleSweepKeyword(); break;
+			default:           ARCALC_UNREACHABLE_CODE();
 			}
 		}
 	}
 
 	std::optional<double> Parser::Eval(std::string_view exprString) {
-		try { return PostfixMathEvaluator{m_LitMan, m_FunMan}.Eval(exprString); } 
+		auto& tempMem{m_pLineArena->Resource()};
+		try {
+			auto eval{EvaluatorPool::Acquire(m_LitMan, m_FunMan, tempMem)};
+
+			// The tokens are only used when they are of the exact same view, not just an equal 
+			// string, so they can never belong to another part of the line.
+			if (m_pPreparedExpr && m_pPreparedExpr->Source.data() == exprString.data() 
+				&& m_pPreparedExpr->Source.size() == exprString.size()) 
+			{
+				return eval->Eval(*m_pPreparedExpr);
+			}
+			return eval->Eval(exprString);
+		} 
 		catch (ArCalcException& err) {
 			err.SetLineNumber(GetLineNumber());
 			throw;
 		}
 	}
 
+	std::span<EvalResult const> Parser::EvalBatch(std::span<std::string_view const> exprs) {
+		if (IsParsingFunction()) {
+			throw SyntaxError{"Evaluating a batch in the middle of a function definition"};
+		}
+
+		m_BatchResults.assign(exprs.size(), EvalResult{});
+
+		// Every chunk gets copies of the scope, which only works when no expression can 
+		// change anything in it, see FunctionManager::CanCallFromCopiesInParallel.
+		if (m_pPool && exprs.size() >= 2U * Secret::sc_BatchGrainSize 
+			&& m_FunMan.CanCallFromCopiesInParallel()) 
+		{
+			m_pPool->ForEach(exprs.size(), Secret::sc_BatchGrainSize, 
+				[this] { return Secret::BatchScope{m_LitMan, m_FunMan}; },
+				[&](Secret::BatchScope& scope, size_t i) {
+					Secret::EvalBatchItem(*scope.Eval, scope.Arena, exprs[i], m_BatchResults[i]);
+				});
+			return m_BatchResults;
+		}
+
+		// One evaluator for the whole batch. Nothing in it can add or remove literals or 
+		// functions of this scope, so every name only has to be looked up once.
+		auto& arena{*m_pLineArena};
+		auto eval{EvaluatorPool::Acquire(m_LitMan, m_FunMan, arena.Resource())};
+		eval->CacheSymbols();
+
+		for (auto const i : view::iota(size_t{}, exprs.size())) {
+			Secret::EvalBatchItem(*eval, arena, exprs[i], m_BatchResults[i]);
+		}
+
+		return m_BatchResults;
+	}
+
+	void Parser::SetThreadPool(ThreadPool* pPool) {
+		m_pPool = pPool;
+		m_FunMan.SetThreadPool(pPool);
+	}
+
+	ThreadPool* Parser::GetThreadPool() const {
+		return m_pPool;
+	}
+
 	void Parser::HandleSetKeyword() {
 		auto const state{GetState()}; 
 		ARCALC_NOT_POSSIBLE(state != St::Default && state != St::Val_SubParser && !IsSelSt(state));
@@ -253,7 +649,9 @@ namespace ArCalc {
 		}
 
 		if (state == St::Default || IsSelSt(state)) {
-			Print("{} = {}\n", litName, value);
+			if (IsResultShown()) {
+				GetResultSink().OnLiteralSet(GetLineNumber(), litName, value);
+			}
 			if (MathConstant::IsValid(litName)) {
 				Print("Shadowing constant [{} ({})]\n", litName, MathConstant::ValueOf(litName));
 			} else if (MathOperator::IsValid(litName)) {
@@ -279,7 +677,7 @@ namespace ArCalc {
 			return;
 		}
 
-		auto const tokens{Str::SplitOnSpaces(m_CurrentLine)};
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
 		Print("{");
 		if (tokens.size() < 2) { 
 			m_LitMan.List();
@@ -299,7 +697,7 @@ namespace ArCalc {
 			};
 		}
 
-		auto const tokens{Str::SplitOnSpaces<std::string_view>(m_CurrentLine)};
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
 		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Func);
 		
 		if (tokens.size() == 1) {
@@ -386,7 +784,7 @@ namespace ArCalc {
 		}(/*)(*/);
 
 		// Check function body for syntax errors.
-		m_pValSubParser = std::make_unique<Parser>(std::cout, m_FunMan, paramMap);
+		m_pValSubParser = std::make_unique<Parser>(GetOStream(), m_FunMan, paramMap);
 		m_pValSubParser->ToggleOutput();
 		m_pValSubParser->SetState(St::Val_SubParser);
 		SetState(St::Val_LineCollection);
@@ -468,14 +866,11 @@ namespace ArCalc {
 			m_FunMan.SetReturnType(subParser.m_ReturnTypeRegister.value_or(FuncReturnType::None));
 			subParser.m_ReturnTypeRegister.reset();
 
-			// The following warnings will not be output when the return ends with a ; xd
-			if (auto const funcName{m_FunMan.CurrFunctionName()}; MathConstant::IsValid(funcName)) {
-				Print("This function shadows constant [{} ({})].\n", 
-					funcName, MathConstant::ValueOf(funcName));
-			} else if (MathOperator::IsValid(funcName)) {
-				Print("This function shadows operator [{}].\n", funcName);
+			auto const& funcName{m_FunMan.CurrFunctionName()};
+			PrintShadowingWarnings(funcName);
+			if (!IsExecutingFunction()) {
+				GetResultSink().OnFunctionDefined(m_FunMan.CurrHeaderLineNumber(), funcName);
 			}
-
 			m_FunMan.EndDefination();
 			SetState(St::Default);
 			m_pValSubParser.reset();
@@ -483,6 +878,16 @@ namespace ArCalc {
 		}
 	}
 
+	void Parser::PrintShadowingWarnings(std::string_view funcName) {
+		// The following warnings will not be output when the return ends with a ; xd
+		if (MathConstant::IsValid(funcName)) {
+			Print("This function shadows constant [{} ({})].\n", 
+				funcName, MathConstant::ValueOf(funcName));
+		} else if (MathOperator::IsValid(funcName)) {
+			Print("This function shadows operator [{}].\n", funcName);
+		}
+	}
+
 	void Parser::HandleSelectionKeyword() {
 		if (!IsExecutingFunction()) {
 			// The flag must be turned on when creating the sub-parser for validation as well!!!
@@ -641,12 +1046,13 @@ namespace ArCalc {
 	}
 
 	void Parser::HandleSaveKeyword() {
-		auto const tokens{Str::SplitOnSpaces<std::string_view>(m_CurrentLine)};
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
 		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Save);
 
-		if (tokens.size() > 3) {
+		if (tokens.size() > 4) {
 			throw ParseError{
-				"Too many tokens in line, expected only the target name, and the category name"
+				"Too many tokens in line, expected only the target name, the category name, "
+				"and optionally the format"
 			};
 		} else if (tokens.size() < 2) {
 			throw ParseError{"Expected name of target to be saved, but found nothing"};
@@ -662,46 +1068,351 @@ namespace ArCalc {
 		auto const& categoryName{tokens[2]};
 		ExpectIdentifier(categoryName);
 
-		auto const saveDir{IO::GetSerializationPath()}; 
-		fs::create_directory(saveDir);
-		std::ofstream file{
-			saveDir / std::string{categoryName}.append(".txt"),
-			std::ios::app,
-		};
+		auto const format = [&] {
+			if (tokens.size() < 4) {
+				return CategoryFormat::Binary;
+			} else if (tokens[3] == "text") {
+				return CategoryFormat::Text;
+			} else if (tokens[3] == "binary") {
+				return CategoryFormat::Binary;
+			} 
+			else throw ParseError{"Unknown category format [{}], expected text or binary", tokens[3]};
+		}(/*)(*/);
 
-		if (m_LitMan.IsVisible(targetName)) {
-			m_LitMan.Serialize(targetName, file);
-		} else if (m_FunMan.IsDefined(targetName)) {
-			m_FunMan.Serialize(targetName, file);
-		} 
-		else throw ParseError{"Tried to save '{}' which does not refer to anything", targetName};
+		if (!m_LitMan.IsVisible(targetName) && !m_FunMan.IsDefined(targetName)) {
+			throw ParseError{"Tried to save '{}' which does not refer to anything", targetName};
+		}
+
+		if (format == CategoryFormat::Text) {
+			auto const filePath{CategoryFile::GetPath(categoryName, CategoryFormat::Text)};
+			fs::create_directory(filePath.parent_path());
+			std::ofstream file{filePath, std::ios::app};
+
+			if (m_LitMan.IsVisible(targetName)) {
+				m_LitMan.Serialize(targetName, file);
+			} else {
+				m_FunMan.Serialize(targetName, file);
+			}
+		} else {
+			std::string record{};
+			BinaryWriter out{record};
+
+			auto const bWorthCompacting = [&] {
+				if (m_LitMan.IsVisible(targetName)) {
+					m_LitMan.SerializeBinary(targetName, out);
+					return CategoryFile::AppendBinary(categoryName, targetName, 
+						CategoryFile::sc_LiteralTag, record);
+				} else {
+					m_FunMan.SerializeBinary(targetName, out);
+					return CategoryFile::AppendBinary(categoryName, targetName, 
+						CategoryFile::sc_FunctionTag, record, m_FunMan.GetCallees(targetName));
+				}
+			}(/*)(*/);
+
+			// Saving the same names over and over would otherwise grow the file forever. Only worth
+			// a try, the record is saved already; while other sessions still read from the file
+			// it is refused, and left to a later save.
+			if (bWorthCompacting) {
+				try { CompactBinaryCategory(CategoryFile::GetPath(categoryName, CategoryFormat::Binary)); } 
+				catch (IOError const&) {}
+			}
+		}
 	}
 
 	void Parser::HandleLoadKeyword() {
-		auto const tokens{Str::SplitOnSpaces<std::string_view>(m_CurrentLine)};
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
 		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Load);
 
-		if (tokens.size() > 2) {
+		if (tokens.size() > 3) {
 			throw ParseError{
-				"Too many tokens in line, expected only the category name"
+				"Too many tokens in line, expected only the category name, "
+				"and optionally the name of a single symbol"
 			};
 		} else if (tokens.size() < 2) {
 			throw ParseError{"Expected name of category, but found nothing"};
 		}
+
+		// Text categories are either exports, or were saved by an older version, so they are
+		// loaded first to let the binary category (the most recent saves) take precedence.
 		auto const& categoryName{tokens[1]};
-		auto const categoryFullPath{IO::GetSerializationPath() / std::string{categoryName}.append(".txt")};
-		if (!fs::exists(categoryFullPath)) {
+		auto const textPath{CategoryFile::GetPath(categoryName, CategoryFormat::Text)};
+		auto const binaryPath{CategoryFile::GetPath(categoryName, CategoryFormat::Binary)};
+		if (!fs::exists(textPath) && !fs::exists(binaryPath)) {
 			throw ParseError{"Loading non-existant category [{}]", categoryName};
 		}
 
-		std::ifstream file{categoryFullPath, std::ios::app};
-		if (!file.is_open()) {
-			throw ParseError{"Loading non-existant category [{}]", categoryName};
+		if (tokens.size() == 3) {
+			if (!fs::exists(binaryPath)) {
+				throw ParseError{
+					"Category [{}] is a text category, which can only be loaded as a whole", 
+					categoryName,
+				};
+			}
+
+			auto const& symbolName{tokens[2]};
+			ExpectIdentifier(symbolName);
+			LoadBinarySymbol(binaryPath, symbolName);
+			return;
+		}
+
+		if (fs::exists(textPath)) {
+			LoadTextCategory(textPath);
+		}
+
+		if (fs::exists(binaryPath)) {
+			LoadBinaryCategory(binaryPath);
 		}
+	}
+
+	void Parser::HandleCompactKeyword() {
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
+		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Compact);
+
+		if (tokens.size() > 2) {
+			throw ParseError{"Too many tokens in line, expected only the category name"};
+		} else if (tokens.size() < 2) {
+			throw ParseError{"Expected name of category, but found nothing"};
+		}
+
+		auto const& categoryName{tokens[1]};
+		ExpectIdentifier(categoryName);
 
-		for (bool bQuit{}; !(bQuit || file.eof());) switch (IO::Input<char>(file)) {
-			case 'C':   m_LitMan.Deserialize(file); break;
-			case 'F':   m_FunMan.Deserialize(file); break;
+		auto const textPath{CategoryFile::GetPath(categoryName, CategoryFormat::Text)};
+		auto const binaryPath{CategoryFile::GetPath(categoryName, CategoryFormat::Binary)};
+		if (!fs::exists(textPath) && !fs::exists(binaryPath)) {
+			throw ParseError{"Compacting non-existant category [{}]", categoryName};
+		}
+
+		// Binary first, as it is the one that can be refused (see CompactBinaryCategory).
+		auto freedByteCount = std::uintmax_t{};
+		if (fs::exists(binaryPath)) {
+			freedByteCount += CompactBinaryCategory(binaryPath);
+		}
+
+		if (fs::exists(textPath)) {
+			freedByteCount += CompactTextCategory(textPath);
+		}
+
+		Print("Compacted category [{}], freed {} bytes\n", categoryName, freedByteCount);
+	}
+
+	std::uintmax_t Parser::CompactTextCategory(fs::path const& filePath) {
+		struct LiveRecord {
+			std::string_view Name;
+			char Tag;
+			std::string_view Text;
+		};
+
+		auto const text{IO::FileToString(filePath)};
+		std::istringstream is{text};
+		auto const position = [&] {
+			auto const res{is.tellg()};
+			return res < 0 ? text.size() : static_cast<size_t>(res);
+		};
+
+		// Deserializing is the only way to know where the records end, so it is done into 
+		// managers that are thrown away after.
+		auto scratchLitMan = LiteralManager{GetOStream()};
+		auto scratchFunMan = FunctionManager{GetOStream()};
+
+		std::vector<LiveRecord> liveRecords{};
+		for (bool bQuit{}; !(bQuit || is.eof());) {
+			auto const begin{position()};
+			switch (auto const tag{IO::Input<char>(is)}; tag) {
+			case CategoryFile::sc_LiteralTag:
+			case CategoryFile::sc_FunctionTag: {
+				if (tag == CategoryFile::sc_LiteralTag) {
+					scratchLitMan.Deserialize(is);
+				} else {
+					scratchFunMan.Deserialize(is);
+				}
+
+				auto const record{Str::Trim<std::string_view>(
+					std::string_view{text}.substr(begin, position() - begin))};
+				auto afterTag{record.substr(1U)};
+				auto const name{Str::ChopFirstToken<std::string_view>(afterTag)};
+
+				// Later records supersede the earlier ones.
+				std::erase_if(liveRecords, [&](LiveRecord const& live) { return live.Name == name; });
+				liveRecords.push_back({name, tag, record});
+				break;
+			}
+			case '\n':  break;
+			case '\0':  bQuit = true; break;
+			default:
+				throw ParseError{
+					"File compaction failed; expected either C or F at the begining of the line"
+				};
+			}
+		}
+
+		std::string newText{};
+		for (auto const& live : liveRecords) {
+			newText.append(live.Text).append(live.Tag == CategoryFile::sc_FunctionTag ? "\n\n" : "\n");
+		}
+
+		IO::ReplaceFile(filePath, newText);
+		return text.size() - std::min(text.size(), newText.size());
+	}
+
+	std::uintmax_t Parser::CompactBinaryCategory(fs::path const& filePath) {
+		// Lazily loaded functions point into the file, and compacting moves the records. Those
+		// of other sessions are left alone, the file is not compacted while there are any.
+		m_FunMan.LoadStubsFrom(filePath);
+		return CategoryFile::Compact(filePath);
+	}
+
+	void Parser::HandleSnapshotKeyword() {
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
+		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Snapshot);
+
+		if (tokens.size() > 2) {
+			throw ParseError{"Too many tokens in line, expected only the snapshot name"};
+		} else if (tokens.size() < 2) {
+			throw ParseError{"Expected name of snapshot, but found nothing"};
+		}
+
+		auto const& snapshotName{tokens[1]};
+		ExpectIdentifier(snapshotName);
+
+		// Written next to the old snapshot, then replacing it, as sessions that restored it 
+		// may still have it mapped.
+		std::string records{};
+		auto index{SerializeAllBinary(m_LitMan, m_FunMan, records)};
+		CategoryFile::WriteWhole(CategoryFile::GetSnapshotPath(snapshotName), std::move(index), records);
+	}
+
+	CategoryFile::Index Parser::SerializeAllBinary(LiteralManager& litMan, FunctionManager& funMan,
+		std::string& records) 
+	{
+		BinaryWriter out{records};
+		CategoryFile::Index res{};
+		auto const addEntry = [&](std::string name, char tag, size_t offset, 
+			std::vector<std::string> dependencies = {}) 
+		{
+			res.push_back({
+				.Name{std::move(name)},
+				.Tag{tag},
+				.Offset{offset},
+				.Size{static_cast<std::uint32_t>(records.size() - offset)},
+				.Dependencies{std::move(dependencies)},
+			});
+		};
+
+		for (auto& name : litMan.GetNames()) {
+			auto const offset{records.size()};
+			litMan.SerializeBinary(name, out);
+			addEntry(std::move(name), CategoryFile::sc_LiteralTag, offset);
+		}
+
+		// Functions that were not called since they got loaded are read here.
+		for (auto& name : funMan.GetNames()) {
+			auto const offset{records.size()};
+			funMan.SerializeBinary(name, out);
+			auto callees{funMan.GetCallees(name)};
+			addEntry(std::move(name), CategoryFile::sc_FunctionTag, offset, std::move(callees));
+		}
+
+		return res;
+	}
+
+	void Parser::HandleRestoreKeyword() {
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
+		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Restore);
+
+		if (tokens.size() > 2) {
+			throw ParseError{"Too many tokens in line, expected only the snapshot name"};
+		} else if (tokens.size() < 2) {
+			throw ParseError{"Expected name of snapshot, but found nothing"};
+		}
+
+		auto const& snapshotName{tokens[1]};
+		ExpectIdentifier(snapshotName);
+
+		auto const filePath{CategoryFile::GetSnapshotPath(snapshotName)};
+		if (!fs::exists(filePath)) {
+			throw ParseError{"Restoring non-existant snapshot [{}]", snapshotName};
+		}
+
+		// Nothing is parsed or validated again; literals are copied out of the mapping, and 
+		// functions keep pointing into it until they are first called.
+		auto const pSnapshot{std::make_shared<MappedFile const>(filePath)};
+		auto const bytes{pSnapshot->GetBytes()};
+		for (auto const& entry : CategoryFile::ReadIndexFromBytes(bytes)) {
+			if (entry.Offset + entry.Size > bytes.size()) {
+				throw IOError{"Snapshot [{}] is shorter than its index says", snapshotName};
+			} else if (entry.Tag == CategoryFile::sc_FunctionTag) {
+				m_FunMan.AddStub(entry.Name, {
+					.pSnapshot{pSnapshot},
+					.Offset{entry.Offset},
+					.Size{entry.Size},
+				});
+			} else {
+				LoadBinaryRecords(bytes.substr(entry.Offset, entry.Size));
+			}
+		}
+	}
+
+	void Parser::LoadTextCategory(fs::path const& filePath) {
+		if (!fs::exists(filePath)) {
+			throw ParseError{"Could not open category file [{}]", filePath.string()};
+		}
+
+		// Text categories are converted to binary ones once, then loaded like those.
+		auto const text{IO::FileToString(filePath)};
+		if (auto const cachedPath{ScriptCache::FindCategory(text)}) {
+			LoadBinaryCategory(*cachedPath);
+			return;
+		}
+
+		// Deserialized apart first, so only the latest record of each name gets converted.
+		// Records are independent of each other, so large files are split between the threads 
+		// of the pool, and merged back in file order to keep the latest records.
+		struct Scratch {
+			LiteralManager LitMan;
+			FunctionManager FunMan;
+		};
+
+		auto const chunks{CategoryFile::SplitText(text, m_pPool ? m_pPool->GetWorkerCount() + 1U : 1U)};
+		std::vector<Scratch> scratches{};
+		scratches.reserve(chunks.size() + 1U);
+		for ([[maybe_unused]] auto const i : view::iota(0U, chunks.size() + 1U)) {
+			scratches.push_back({LiteralManager{GetOStream()}, FunctionManager{GetOStream()}});
+		}
+
+		auto const deserializeChunk = [&](size_t i) {
+			DeserializeTextRecords(chunks[i], scratches[i].LitMan, scratches[i].FunMan);
+		};
+
+		if (m_pPool) {
+			m_pPool->ForEach(chunks.size(), 1U, deserializeChunk);
+		} else {
+			range::for_each(view::iota(size_t{}, chunks.size()), deserializeChunk);
+		}
+
+		auto& merged{scratches.back()};
+		for (auto const i : view::iota(0U, chunks.size())) {
+			merged.LitMan.MergeFrom(std::move(scratches[i].LitMan));
+			merged.FunMan.MergeFrom(std::move(scratches[i].FunMan));
+		}
+
+		std::string records{};
+		auto index{SerializeAllBinary(merged.LitMan, merged.FunMan, records)};
+		LoadBinaryRecords(records);
+
+		try { ScriptCache::StoreCategory(text, std::move(index), records); } 
+		catch (std::exception const&) {
+			// The cache only makes the next load faster, so failing to write it is fine.
+		}
+	}
+
+	void Parser::DeserializeTextRecords(std::string_view text, LiteralManager& litMan, 
+		FunctionManager& funMan) 
+	{
+		std::istringstream is{std::string{text}};
+		for (bool bQuit{}; !(bQuit || is.eof());) switch (IO::Input<char>(is)) {
+			case CategoryFile::sc_LiteralTag:  litMan.Deserialize(is); break;
+			case CategoryFile::sc_FunctionTag: funMan.Deserialize(is); break;
 			case '\n':  break;
 			case '\0':  bQuit = true; break;
 			default:
@@ -711,8 +1422,78 @@ namespace ArCalc {
 		}
 	}
 
+	void Parser::LoadBinaryCategory(fs::path const& filePath) {
+		// Only what the index refers to is loaded, because older records with the same names 
+		// would be overriden anyway. Functions are read the first time they are called.
+		auto const index{CategoryFile::ReadIndex(filePath)};
+		auto const pFilePath{CategoryFile::SharePath(filePath)};
+
+		std::vector<CategoryFile::IndexEntry const*> literals{};
+		for (auto const& entry : index) {
+			if (entry.Tag == CategoryFile::sc_FunctionTag) {
+				m_FunMan.AddStub(entry.Name, {
+					.pCategoryPath{pFilePath},
+					.Offset{entry.Offset},
+					.Size{entry.Size},
+				});
+			} else {
+				literals.push_back(&entry);
+			}
+		}
+
+		for (auto const& record : CategoryFile::ReadRecords(filePath, literals)) {
+			LoadBinaryRecords(record);
+		}
+	}
+
+	void Parser::LoadBinarySymbol(fs::path const& filePath, std::string_view symbolName) {
+		auto const index{CategoryFile::ReadIndex(filePath)};
+		auto const findEntry = [&](std::string_view name) -> CategoryFile::IndexEntry const* {
+			auto const it{range::find(index, name, &CategoryFile::IndexEntry::Name)};
+			return it == index.end() ? nullptr : &*it;
+		};
+
+		auto const pRoot{findEntry(symbolName)};
+		if (!pRoot) {
+			throw ParseError{
+				"Loading [{}] which was never saved in category [{}]", 
+				symbolName, filePath.stem().string(),
+			};
+		}
+
+		// The functions called by the symbol (directly or not) must come along, otherwise 
+		// it could not be called. Those that were not saved in this category are assumed to 
+		// be defined some other way, like they were when it got saved.
+		std::vector<CategoryFile::IndexEntry const*> needed{pRoot};
+		for (size_t i{}; i < needed.size(); ++i) {
+			for (auto const& dependency : needed[i]->Dependencies) {
+				auto const pEntry{findEntry(dependency)};
+				if (pEntry && range::find(needed, pEntry) == needed.end()) {
+					needed.push_back(pEntry);
+				}
+			}
+		}
+
+		for (auto const& record : CategoryFile::ReadRecords(filePath, needed)) {
+			LoadBinaryRecords(record);
+		}
+	}
+
+	void Parser::LoadBinaryRecords(std::string_view records) {
+		BinaryReader in{records};
+		while (!in.IsAtEnd()) switch (auto const tag{static_cast<char>(in.ReadU8())}; tag) {
+			case CategoryFile::sc_LiteralTag:  m_LitMan.DeserializeBinary(in); break;
+			case CategoryFile::sc_FunctionTag: m_FunMan.DeserializeBinary(in); break;
+			default:
+				throw ParseError{
+					"File deserialization failed; found record tag [{:d}] at offset [{}]",
+					tag, in.GetPosition() - 1,
+				};
+		}
+	}
+
 	void Parser::HandleUnscopeKeyword() {
-		auto const tokens{Str::SplitOnSpaces<std::string_view>(m_CurrentLine)};
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
 		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Unscope);
 
 		auto const printUnshadowString = [this](auto name) {
@@ -857,6 +1638,79 @@ namespace ArCalc {
 		}
 	}
 
+	void Parser::HandleSweepKeyword() {
+		if (m_bInFunction) {
+			throw SyntaxError{
+				"Found keyword [{}] in an invalid context (inside a function)", 
+				KeywordType::Sweep,
+			};
+		}
+
+		auto const tokens{Str::SplitOnSpaces(m_pLineArena->Resource(), m_CurrentLine)};
+		KeywordDebugDoubleCheck(tokens.front(), KeywordType::Sweep);
+
+		if (tokens.size() < 2) {
+			throw ParseError{"Expected name of the function to sweep, but found nothing"};
+		} else if (auto const axisTokenCount{tokens.size() - 2U}; axisTokenCount % 4U == 3U) {
+			throw ParseError{
+				"Expected every parameter to be followed by its first value, last value, and "
+				"step, and optionally the name of the file for the results and the number of "
+				"processes after them"
+			};
+		}
+
+		auto const& funcName{tokens[1]};
+		ExpectIdentifier(funcName);
+
+		try {
+			auto sweep = Sweep{GetOStream(), m_FunMan, funcName};
+			for (size_t i{2U}; i + 4U <= tokens.size(); i += 4U) {
+				auto const& paramName{tokens[i]};
+				auto const bound = [&](std::string_view expr) {
+					if (auto const opt{Eval(expr)}; opt.has_value()) {
+						return *opt;
+					} else throw ParseError{
+						"Bound [{}] of parameter [{}] returns none", expr, paramName
+					};
+				};
+				sweep.AddAxis(paramName, bound(tokens[i + 1U]), bound(tokens[i + 2U]), bound(tokens[i + 3U]));
+			}
+
+			if (tokens.size() % 4U == 0U) { // Ends with a file and a process count.
+				auto const processCount = [&] {
+					auto const& expr{tokens.back()};
+					auto const opt{Eval(expr)};
+					if (!opt.has_value() || *opt < 1.0 || *opt != std::floor(*opt)) {
+						throw ParseError{"Expected a number of processes to sweep in, but found [{}]", expr};
+					}
+					return static_cast<size_t>(*opt);
+				}(/*)(*/);
+
+				auto sharded = ShardedSweep{sweep, m_FunMan, std::string{tokens[tokens.size() - 2U]}};
+				sharded.Run(processCount);
+			} else if (tokens.size() % 4U == 3U) { // Ends with a file.
+				auto const& filePath{tokens.back()};
+				std::ofstream file{std::string{filePath}};
+				if (!file.is_open()) {
+					throw IOError{"Could not open file [{}] for the results of the sweep", filePath};
+				}
+
+				// Written on another thread while the next block is evaluated.
+				OutputSink buffer{file, true};
+				std::ostream os{&buffer};
+				TextResultSink fileSink{os};
+				sweep.Run(&fileSink, GetLineNumber(), m_pPool);
+				buffer.Flush();
+			} else {
+				sweep.Run(IsResultShown() ? &GetResultSink() : nullptr, GetLineNumber(), m_pPool);
+			}
+		}
+		catch (ArCalcException& err) {
+			err.SetLineNumber(GetLineNumber());
+			throw;
+		}
+	}
+
 	void Parser::HandleErrKeyword() {
 		if (!IsExecutingFunction()) {
 			throw SyntaxError{
@@ -872,7 +1726,7 @@ namespace ArCalc {
 
 		auto const nNextChar = [this] {
 			for (size_t res{}; res < m_CurrentLine.size(); ++res) {
-				if (auto const ch{m_CurrentLine[res]}; !std::isspace(ch)) {
+				if (auto const ch{m_CurrentLine[res]}; Str::IsNotWhiteSpace(ch)) {
 					if (ch != '\'') {
 						throw SyntaxError{"Expected a single quote, but found [{}]", ch};
 					} else {
@@ -984,11 +1838,11 @@ namespace ArCalc {
 		auto const opt{Eval(m_CurrentLine)};
 		if (state == St::Default) {
 			if (opt.has_value()) {
-				auto const res{*opt};
-				m_LitMan.SetLast(res);
-				Print("{}\n", res);
-			} else {
-				Print("None.\n");
+				m_LitMan.SetLast(*opt);
+			}
+
+			if (IsResultShown()) {
+				GetResultSink().OnValue(GetLineNumber(), opt);
 			}
 		} 
 	}
@@ -1009,7 +1863,7 @@ namespace ArCalc {
 #endif
 
 	void Parser::ExpectIdentifier(std::string_view what) {
-		if (std::isdigit(what[0])) {
+		if (Str::IsDigit(what[0])) {
 			throw ParseError{
 				"Invalid identifier ({}); found digit [{}]", what, what[0]
 			};
@@ -1018,17 +1872,16 @@ namespace ArCalc {
 		} 
 
 		for (auto const c : what) {
-			if (!Str::IsAlNum(c) && c != '_') {
+			if (!Str::IsIdentChar(c)) {
 				throw ParseError{"Found invalid character [{}] in indentifier [{}]", c, what};
 			}
 		}
 	}
 
 	bool Parser::IsValidIdentifier(std::string_view what) {
-		return !std::isdigit(what[0]) 
+		return !Str::IsDigit(what[0]) 
 			&& !Keyword::IsValid(what) 
-			&& std::ranges::all_of(what, 
-				[](auto const c) { return std::isalnum(c) || c == '_'; });
+			&& std::ranges::all_of(what, Str::IsIdentChar);
 	}
 
 	void Parser::SubReset() {
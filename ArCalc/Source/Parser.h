@@ -4,6 +4,13 @@
 #include "Util/Keyword.h"
 #include "Util/FunctionManager.h"
 #include "Util/LiteralManager.h"
+#include "Util/LineArena.h"
+#include "Util/CategoryFile.h"
+#include "Util/ScriptCache.h"
+#include "Util/LineReader.h"
+#include "Util/ThreadPool.h"
+#include "ScriptPipeline.h"
+#include "TextResultSink.h"
 
 /* Minimum amount of features to start working on the console interface:
 	* Add a variation to the _Func keyword (This will probably never happen) {
@@ -49,6 +56,8 @@
 */
 
 namespace ArCalc {
+	class StatementGraph;
+
 	/*
 		_Set myVar 5 10 *
 		mVar = 15
@@ -124,6 +133,12 @@ namespace ArCalc {
 		inline constexpr size_t ResetMask{(1U << 16) - 1};
 	}
 
+	/// Outcome of one expression of Parser::EvalBatch.
+	struct EvalResult {
+		std::optional<double> Value{};
+		std::exception_ptr pError{}; // What the expression threw, instead of having a value.
+	};
+
 	class Parser {
 	private:
 		enum class St : size_t;
@@ -202,14 +217,38 @@ namespace ArCalc {
 
 		static void ParseFile(fs::path const& filePath);
 		static void ParseFile(fs::path const& filePath, fs::path const& outFilePath);
+		static void ParseFile(fs::path const& filePath, std::ostream& resultOStream);
 		static void ParseIStream(std::istream& is);
 		static void ParseIStream(std::istream& is, std::ostream& resultOStream);
+
+		// Same, except that consecutive expressions and _Sets are run on the threads of 
+		// [pPool] as far as what they read from each other allows (see StatementGraph), with
+		// their results still reported in order. Streams are read ahead for it.
+		static void ParseFile(fs::path const& filePath, std::ostream& resultOStream, ThreadPool* pPool);
+		static void ParseIStream(std::istream& is, std::ostream& resultOStream, ThreadPool* pPool);
 		
 		void ParseLine(std::string_view line);
 
+		// Evaluates every expression in [exprs] like a line of its own would be, except that
+		// nothing is printed or reported, and _Last is left alone. An expression that throws
+		// only fails its own result. The results are valid until the next call.
+		// Large batches are split between the threads of the pool, if there is one.
+		std::span<EvalResult const> EvalBatch(std::span<std::string_view const> exprs);
+
+		// Used to spread work between cores, down to sibling calls of pure functions (see 
+		// PostfixMathEvaluator), which has to outlive its use. Without one, everything runs 
+		// on the calling thread.
+		void SetThreadPool(ThreadPool* pPool);
+		ThreadPool* GetThreadPool() const;
+
 		void SetOStream(std::ostream& toWhat);
 		std::ostream& GetOStream();
 
+		// Results are printed to the output stream through a TextResultSink, unless given 
+		// another sink, which has to outlive its use. nullptr goes back to printing them.
+		void SetResultSink(IResultSink* pSink);
+		IResultSink& GetResultSink();
+
 		constexpr auto IsExecutingFunction() const { 
 			return m_bInFunction; 
 		}
@@ -247,6 +286,7 @@ namespace ArCalc {
 		void SubReset();
 
 	private:
+		void ParseLineImpl(std::string_view line);
 		void HandleFirstToken();
 		std::optional<double> Eval(std::string_view exprString);
 		constexpr void IncrementLineNumber(size_t inc = 1U) { 
@@ -260,6 +300,31 @@ namespace ArCalc {
 		void HandleFuncKeyword();
 		void HandleReturnKeyword();
 		void AddFunctionLine();
+		void PrintShadowingWarnings(std::string_view funcName);
+
+		// Looks [sourceKey] up in ScriptCache if it is known before the script runs.
+		static void ParseLines(LineReader& reader, std::ostream& resultOStream, 
+			std::optional<ScriptCache::SourceKey> sourceKey, bool bPipelined, ThreadPool* pPool);
+		void ParseLine(ScriptPipeline::Line const& line);
+
+		// Parses a whole script, and returns its function definitions for ScriptCache.
+		// Lines that [pGraph] takes are run with it, if there is one.
+		std::vector<ScriptCache::CachedFunction> RecordLines(ScriptPipeline& lines, StatementGraph* pGraph);
+
+		// Parses a whole script, defining [functions] directly instead of validating them again.
+		void ReplayLines(ScriptPipeline& lines, std::span<ScriptCache::CachedFunction const> functions, 
+			StatementGraph* pGraph);
+
+		// Adds [line] to [graph] instead of parsing it, if it is an expression or a _Set of 
+		// a literal that the graph can run. Returns false if it has to be parsed, after the 
+		// statements of the graph are run (see RunDeferred).
+		bool DeferLine(StatementGraph& graph, std::string_view line);
+
+		// Runs the statements of [graph], then applies and reports them in order, the same 
+		// way parsing them one by one would. Throws the first error, after reporting it.
+		void RunDeferred(StatementGraph& graph);
+		bool DefineCachedFunction(ScriptPipeline& lines, std::string_view headerLine, 
+			ScriptCache::CachedFunction const& func);
 
 		void HandleSelectionKeyword();
 		void HandleConditionalBody(KeywordType selKW, bool bExecute);
@@ -267,8 +332,24 @@ namespace ArCalc {
 
 		void HandleSaveKeyword();
 		void HandleLoadKeyword();
+		void LoadTextCategory(fs::path const& filePath);
+		static void DeserializeTextRecords(std::string_view text, LiteralManager& litMan, 
+			FunctionManager& funMan);
+		void LoadBinaryCategory(fs::path const& filePath);
+		void LoadBinarySymbol(fs::path const& filePath, std::string_view symbolName);
+		void LoadBinaryRecords(std::string_view records);
+
+		void HandleCompactKeyword();
+		std::uintmax_t CompactTextCategory(fs::path const& filePath);
+		std::uintmax_t CompactBinaryCategory(fs::path const& filePath);
+
+		void HandleSnapshotKeyword();
+		void HandleRestoreKeyword();
+		static CategoryFile::Index SerializeAllBinary(LiteralManager& litMan, FunctionManager& funMan,
+			std::string& records);
 
 		void HandleUnscopeKeyword();
+		void HandleSweepKeyword();
 
 		// Can not use the noreturn attribute, because this function actually returns in 
 		// function validation phase.
@@ -288,10 +369,17 @@ namespace ArCalc {
 			m_CurrState = newState; 
 		}
 
+		// Whether results go to the result sink, same as for Print.
+		constexpr bool IsResultShown() const {
+			return IsOutputEnabled() && !IsLineEndsWithSemiColon();
+		}
+
 		template <class... FormatArgs>
 		void Print(std::string_view fmtString, FormatArgs&&... fmtArgs) {
 			if (IsOutputEnabled() && !IsLineEndsWithSemiColon()) {
-				GetOStream() << std::vformat(
+				// Formatted straight into the stream's buffer (see OutputSink), no temporary.
+				std::vformat_to(
+					std::ostreambuf_iterator<char>{GetOStream()},
 					fmtString, 
 					std::make_format_args(std::forward<FormatArgs>(fmtArgs)...)
 				);
@@ -324,7 +412,19 @@ namespace ArCalc {
 
 		std::unique_ptr<Parser> m_pValSubParser{};
 
+		// Temporaries of the line being parsed, reset at the end of ParseLine.
+		std::unique_ptr<LineArena> m_pLineArena{std::make_unique<LineArena>()};
+
+		// Tokens of the line being parsed, if it came from a ScriptPipeline (see Eval).
+		LexedExpr const* m_pPreparedExpr{};
+
 		bool m_bSuppressOutput{};
 		std::ostream* m_pOutStream{};
+
+		std::vector<EvalResult> m_BatchResults{};
+		ThreadPool* m_pPool{};
+
+		TextResultSink m_TextSink;
+		IResultSink* m_pCustomSink{}; // Not pointing at m_TextSink, so moving the parser is fine.
 	};
 }
\ No newline at end of file
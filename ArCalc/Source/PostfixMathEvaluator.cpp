@@ -2,43 +2,126 @@
 #include "Util/MathOperator.h"
 #include "Util/MathConstant.h"
 #include "Util/Str.h"
+#include "Util/Lexer.h"
+#include "Util/NumberFormatter.h"
 #include "Exception/ArCalcException.h"
 #include "Parser.h"
 
 namespace ArCalc {
-	enum class PostfixMathEvaluator::St : std::size_t {
-		WhiteSpace,
-		FoundMinusSign,
-		HandledMinusSign,
-
-		ParsingIdentifier,
-
-		ParsingNumber,
-		ParsingOperator,
-	};
+	namespace Secret {
+		// Calls [call] for [func], with the line numbers of its errors counted from the 
+		// start of the script instead of the start of [func].
+		template <class Call>
+		std::optional<double> CallFrom(FuncData const& func, Call&& call) {
+			try {
+				return call();
+			} catch (ArCalcException& err) {
+				err.SetLineNumber(err.GetLineNumber() + func.HeaderLineNumber);
+
+				// So if we are deep in the stack, the functions above do not modify
+				// the line number to the line where the call of this function occurred.
+				err.LockNumberLine(); 
+				throw;
+			}
+		}
+	}
 
 	PostfixMathEvaluator::PostfixMathEvaluator(LiteralManager& litMan, FunctionManager& funMan) 
-		: m_LitMan{litMan}, m_FunMan{funMan}
+		: m_pLitMan{&litMan}, m_pFunMan{&funMan}
 	{
 	}
 
+	void PostfixMathEvaluator::Rebind(LiteralManager& litMan, FunctionManager& funMan, 
+		std::pmr::memory_resource& tempMem) 
+	{
+		Reset();
+		m_pLitMan  = &litMan;
+		m_pFunMan  = &funMan;
+		m_pTempMem = &tempMem;
+		m_bCacheSymbols = false;
+		m_Symbols.clear();
+	}
+
+	void PostfixMathEvaluator::CacheSymbols() {
+		m_bCacheSymbols = true;
+	}
+
 	std::optional<double> PostfixMathEvaluator::Eval(std::string_view exprString) {
 		if (exprString.empty()) {
 			throw ExprEvalError{"Evaluating empty expression"};
 		}
 		
-		for (auto const c : exprString) {
-			DoIteration(c); // To allow for recursive behaviour.
+		Lexer lexer{exprString};
+		try {
+			for (auto token{lexer.Next()}; token.Type != TokenType::End; token = lexer.Next()) {
+				if (token.Type == TokenType::Number) { // The sign is not part of the glyph.
+					m_Values.PushRValue(m_NumPar.Parse(token.Glyph) * (token.bMinus ? -1.0 : 1.0));
+				} else {
+					EvalToken(token);
+				}
+			}
+		} catch (...) {
+			JoinCalls(); // Their errors come first.
+			throw;
 		}
-		DoIteration(' '); // Cut any unfinished tokens.
 
-		if (m_Values.Size() > 1) { 
-			for (auto stackStr = std::string{};;) {
-				stackStr = std::to_string(*m_Values.Pop()) + ' ' + stackStr; 
-				if (m_Values.IsEmpty()) {
-					throw ExprEvalError{"Incomplete eval: {{ {}}}", stackStr};
+		return PopResult();
+	}
+
+	std::optional<double> PostfixMathEvaluator::Eval(LexedExpr const& expr) {
+		if (expr.Source.empty()) {
+			throw ExprEvalError{"Evaluating empty expression"};
+		}
+
+		auto numberIt{expr.Numbers.begin()};
+		try {
+			for (auto const& token : expr.Tokens) {
+				if (token.Type == TokenType::Number) {
+					ARCALC_DA(numberIt != expr.Numbers.end(), "LexedExpr is missing the value of a number");
+					m_Values.PushRValue(*numberIt++);
+				} else {
+					EvalToken(token);
 				}
 			}
+		} catch (...) {
+			JoinCalls(); // Their errors come first.
+			throw;
+		}
+
+		return PopResult();
+	}
+
+	void PostfixMathEvaluator::EvalToken(Token const& token) {
+		switch (token.Type) {
+		case TokenType::Identifier:
+			EvalIdentifier(token.Glyph, token.bMinus);
+			break;
+		case TokenType::Operator:
+			if (m_bCacheSymbols) { // Saves finding the operator more than once.
+				EvalIdentifier(token.Glyph, false);
+			} else {
+				EvalOperator(token.Glyph);
+			}
+			break;
+		default:
+			ARCALC_UNREACHABLE_CODE();
+		}
+	}
+
+	std::optional<double> PostfixMathEvaluator::PopResult() {
+		JoinCalls();
+		if (m_Values.Size() > 1) { 
+			std::pmr::vector<double> values{m_pTempMem};
+			while (!m_Values.IsEmpty()) {
+				values.push_back(*m_Values.Pop());
+			}
+
+			auto stackStr = std::string{};
+			for (auto const value : values | view::reverse) { // From the bottom of the stack.
+				NumberFormatter::Append(stackStr, value);
+				stackStr += ' ';
+			}
+			throw ExprEvalError{"Incomplete eval: {{ {}}}", stackStr};
 		} else {
 			auto const res = m_Values.IsEmpty() ? std::optional<double>{} : *m_Values.Pop();
 			Reset();
@@ -47,44 +130,23 @@ namespace ArCalc {
 	}
 
 	void PostfixMathEvaluator::Reset() {
-		ResetString();
+		ARCALC_DA(m_PendingCalls.empty(), "Resetting PostfixMathEvaluator with calls pending");
 		m_Values.Clear();
-		m_CurrState = St::WhiteSpace;
-		m_NumPar.Reset();
 	}
 
-	void PostfixMathEvaluator::DoIteration(char c) {
-		switch (GetState()) {
-		case St::WhiteSpace:        ParseWhiteSpace(c); break;
-		case St::ParsingIdentifier: ParseIdentifier(c); break;
-		case St::ParsingOperator:   ParseSymbolicOperator(c); break;
-		case St::ParsingNumber:     ParseNumber(c); break;
-		case St::FoundMinusSign:    ParseMinusSign(c); break;
+	void PostfixMathEvaluator::EvalIdentifier(std::string_view identifier, bool bMinus) {
+		if (!m_bCacheSymbols) {
+			return EvalSymbol(Resolve(identifier), identifier, bMinus);
 		}
-	}
 
-	void PostfixMathEvaluator::ParseWhiteSpace(char c) {
-		if (std::isspace(c)) {
-			return;
-		} else if (std::isalpha(c) || c == '_') {
-			SetState(St::ParsingIdentifier);
-			ParseIdentifier(c);
-		} else if (std::isdigit(c) || c == '.') {  
-			// The second condition allows ".5" instead of the long-winded "0.5".
-			SetState(St::ParsingNumber);
-			ParseNumber(c);
-		} else {
-			SetState(St::ParsingOperator);
-			ParseSymbolicOperator(c);
+		auto it{m_Symbols.find(identifier)};
+		if (it == m_Symbols.end()) {
+			it = m_Symbols.emplace(identifier, Resolve(identifier)).first;
 		}
+		EvalSymbol(it->second, identifier, bMinus);
 	}
 
-	void PostfixMathEvaluator::ParseIdentifier(char c) {
-		if (IsCharValidForIdent(c)) { // Parsing...
-			AddChar(c);
-			return;
-		}
-
+	PostfixMathEvaluator::Symbol PostfixMathEvaluator::Resolve(std::string_view identifier) {
 		/* **** Order of checks ****
 		 * 1) Literals (and the Last keyword).
 		 * 2) Functions.
@@ -93,134 +155,100 @@ namespace ArCalc {
 		 * Due to conventions, constant and operator names will never overlap, 
 		 * and thus the order of thier checks will not make a difference.
 		 */
+		using K = Symbol::Kind;
 
-		// Finished parsing, evaluating...
-		std::string identifier{GetString()};
-
-		auto const bMinus{identifier.front() == '-'};
-		if (bMinus) { // Strip the negative sign for lookup.
-			identifier = identifier.substr(1);
+		if (m_pLitMan->IsVisible(identifier)) {
+			return {.Type = K::Literal, .pValue = &m_pLitMan->Get(identifier)};
+		} else if (identifier == Keyword::ToStringView(KeywordType::Last)) {
+			return {.Type = K::Last, .pValue = &m_pLitMan->Get(identifier)};
+		} else if (m_pFunMan->IsDefined(identifier)) {
+			return {.Type = K::Function};
+		} else if (MathConstant::IsValid(identifier)) {
+			return {.Type = K::Constant, .Value = MathConstant::ValueOf(identifier)};
+		} else if (MathOperator::IsValid(identifier)) { 
+			return {.Type = OperatorKindOf(identifier)};
+		} else if (Keyword::IsValid(identifier)) {
+			return {.Type = K::Keyword};
+		} else {
+			return {.Type = K::Unknown};
 		}
+	}
+
+	void PostfixMathEvaluator::EvalSymbol(Symbol const& symbol, std::string_view identifier, bool bMinus) {
+		using K = Symbol::Kind;
 
-		if (m_LitMan.IsVisible(identifier)) {
+		switch (symbol.Type) {
+		case K::Literal:
 			if (bMinus) { // Minus sign turns it into an rvalue.
-				m_Values.PushRValue(*m_LitMan.Get(identifier) * -1.0);
+				m_Values.PushRValue(*symbol.pValue * -1.0);
 			} else {
-				m_Values.PushLValue(&m_LitMan.Get(identifier));
+				m_Values.PushLValue(symbol.pValue);
 			}
-		} else if (identifier == Keyword::ToStringView(KeywordType::Last)) {
+			break;
+		case K::Last:
 			// Is is always treated as an rvalue, the user can not pass it by reference.
-			m_Values.PushRValue(*m_LitMan.Get(identifier) * (bMinus ? -1.0 : 1.0));
-		} else if (m_FunMan.IsDefined(identifier)) {
+			m_Values.PushRValue(*symbol.pValue * (bMinus ? -1.0 : 1.0));
+			break;
+		case K::Function:
 			if (bMinus) {
-				throw ExprEvalError{"Found function name [{}] preceeded by a minus sign"};
-			} else {
-				EvalFunction();
+				throw ExprEvalError{"Found function name [{}] preceeded by a minus sign", identifier};
 			}
-		} else if (MathConstant::IsValid(identifier)) {
-			m_Values.PushRValue(MathConstant::ValueOf(identifier) * (bMinus ? -1.0 : 1.0));
-		} else if (MathOperator::IsValid(identifier)) { 
+			EvalFunction(identifier);
+			break;
+		case K::Constant:
+			m_Values.PushRValue(symbol.Value * (bMinus ? -1.0 : 1.0));
+			break;
+		case K::UnaryOperator:
+		case K::BinaryOperator:
+		case K::VariadicOperator:
 			if (bMinus) {
-				throw ExprEvalError{"Found operator name [{}] preceeded by a minus sign"};
-			} else {
-				EvalOperator();
+				throw ExprEvalError{"Found operator name [{}] preceeded by a minus sign", identifier};
 			}
-		} else if (Keyword::IsValid(identifier)) {
+			EvalOperator(identifier, symbol.Type);
+			break;
+		case K::Keyword:
 			// Only valid keyword in this context is _Last, which was already handled above.
 			throw SyntaxError{
 				"Found keyword [{}] in invalid context (in the middle of an expression)",
 				identifier
 			};
-		} else {
+		case K::Unknown:
 			throw ExprEvalError{"Used of invalid name [{}]", identifier};
-		} 
-
-		ResetString();
-		ResetState(c);
-	}
-
-	void PostfixMathEvaluator::ParseNumber(char c) {
-		if (auto const res{m_NumPar.Parse(c)}; res.IsDone) {
-			// When the string is not empty, a minus sign is assumed to be there.
-			m_Values.PushRValue(GetString().empty() ? res.Value : -res.Value);
-			ResetString();
-			ResetState(c);
-		}
-	}
-
-	void PostfixMathEvaluator::ParseSymbolicOperator(char op) {
-		if (std::isspace(op) || std::isalnum(op)) { // Operator token fully accumulated?
-			EvalOperator();
-			ResetString();
-			ResetState(op);
-		} else {
-			if (op == '-') { // Could be a negative number.
-				SetState(St::FoundMinusSign);
-			}
-			AddChar(op);
+		default:
+			ARCALC_UNREACHABLE_CODE();
 		}
 	}
 
-	void PostfixMathEvaluator::ParseMinusSign(char c) {
-		if (std::isspace(c)) {
-			EvalOperator();
-			ResetString();
-			ResetState(c);
-		} else if (std::isdigit(c) || c == '.') {
-			SetState(St::ParsingNumber);
-			ParseNumber(c);
-		} else if (IsCharValidForIdent(c)) {
-			SetState(St::ParsingIdentifier);
-			ParseIdentifier(c);
-		} 
-		else ARCALC_UNREACHABLE_CODE();
-	}
-
-	void PostfixMathEvaluator::PushLiteralValue() {
-		auto literalName{GetString()};
-
-		auto const bMinusSign{literalName.starts_with('-')};
-		if (bMinusSign) {
-			m_Values.PushRValue(*m_LitMan.Get(literalName.substr(1)) * -1.0);
-		} else {
-			m_Values.PushLValue(&m_LitMan.Get(literalName));
+	void PostfixMathEvaluator::EvalOperator(std::string_view glyph) {
+		if (!MathOperator::IsValid(glyph)) {
+			throw ExprEvalError{"Invalid operator [{}]", glyph};
 		}
-	}
 
-	void PostfixMathEvaluator::SetState(St newState) {
-		m_CurrState = newState;
+		EvalOperator(glyph, OperatorKindOf(glyph));
 	}
 
-	void PostfixMathEvaluator::ResetState(char c) {
-		SetState(St::WhiteSpace);
-		if (!std::isspace(c)) {
-			DoIteration(c);
-		}
-	}
-
-	PostfixMathEvaluator::St PostfixMathEvaluator::GetState() const noexcept {
-		return m_CurrState;
-	}
+	PostfixMathEvaluator::Symbol::Kind PostfixMathEvaluator::OperatorKindOf(std::string_view glyph) {
+		using K = Symbol::Kind;
 
-	void PostfixMathEvaluator::AddChar(char c) {
-		m_CurrStringAcc.push_back(c);
-	}
+		if (MathOperator::IsBinary(glyph)) {
+			return K::BinaryOperator;
+		} else if (MathOperator::IsUnary(glyph)) {
+			return K::UnaryOperator;
+		} else if (MathOperator::IsVariadic(glyph)) {
+			return K::VariadicOperator;
+		} 
 
-	std::string const& PostfixMathEvaluator::GetString() const {
-		return m_CurrStringAcc;
+		ARCALC_UNREACHABLE_CODE();
+		return K::Unknown;
 	}
 
-	void PostfixMathEvaluator::ResetString() {
-		m_CurrStringAcc.clear();
-	}
+	void PostfixMathEvaluator::EvalOperator(std::string_view glyph, Symbol::Kind arity) {
+		using K = Symbol::Kind;
 
-	void PostfixMathEvaluator::EvalOperator() {
-		auto const& glyph{GetString()};
-		if (!MathOperator::IsValid(glyph)) {
-			throw ExprEvalError{"Invalid operator [{}]", glyph};
-		}
+		JoinCallsBeforePopping(arity == K::BinaryOperator ? 2U 
+			: arity == K::UnaryOperator ? 1U : m_Values.Size());
 
-		if (MathOperator::IsBinary(glyph)) {
+		if (arity == K::BinaryOperator) {
 			if (m_Values.Size() == 0) {
 				throw ExprEvalError{"Found binary operator [{}] with no operands", glyph};
 			} else if (m_Values.Size() == 1) {
@@ -235,7 +263,7 @@ namespace ArCalc {
 			// Must pop here ^^^ because, lhs might be an lvalue, and the expression result 
 			// must be an rvalue.
 			m_Values.PushRValue(MathOperator::EvalBinary(glyph, lhs, rhs));
-		} else if (MathOperator::IsUnary(glyph)) {
+		} else if (arity == K::UnaryOperator) {
 			if (m_Values.Size() == 0) {
 				throw ExprEvalError{"Found unary operator [{}] with no operands", glyph};
 			}
@@ -243,13 +271,13 @@ namespace ArCalc {
 			auto const operand{*m_Values.Pop()};
 			// Must pop here ^^^, explained in the other branch.
 			m_Values.PushRValue(MathOperator::EvalUnary(glyph, operand));
-		} else if (MathOperator::IsVariadic(glyph)) {
+		} else if (arity == K::VariadicOperator) {
 			if (m_Values.Size() == 0) {
 				throw ExprEvalError{"Found variadic operator [{}] with no operands", glyph};
 			}
 
 			auto const operands = [&] {
-				std::vector<double> res{};
+				std::pmr::vector<double> res{m_pTempMem};
 				res.reserve(m_Values.Size());
 				while (!m_Values.IsEmpty()) {
 					res.push_back(*m_Values.Pop());
@@ -265,9 +293,22 @@ namespace ArCalc {
 		}
 	}
 
-	void PostfixMathEvaluator::EvalFunction() {
-		auto const funcName{GetString()};
-		auto& func{m_FunMan.Get(funcName)};
+	void PostfixMathEvaluator::EvalFunction(std::string_view funcName) {
+		if (m_pFunMan->GetThreadPool()) {
+			// Finding out may load functions, which forked calls must not see happen.
+			if (!m_PendingCalls.empty() && !m_pFunMan->IsPurityKnown(funcName)) {
+				JoinCalls();
+			}
+
+			if (m_pFunMan->IsPure(funcName)) {
+				return EvalPureFunction(funcName);
+			}
+
+			// Other calls may change what the pending ones read, and have to come after them.
+			JoinCalls();
+		}
+
+		auto& func{m_pFunMan->Get(funcName)};
 
 		if (auto& params{func.Params}; m_Values.Size() >= params.size()) {
 			for (auto const i : view::iota(0U, params.size()) | view::reverse) {
@@ -289,17 +330,10 @@ namespace ArCalc {
 			};
 		}
 
-		try {
-			if (auto const returnValue{m_FunMan.CallFunction(funcName)}; returnValue.has_value()) {
-				m_Values.PushRValue(*returnValue);
-			}
-		} catch (ArCalcException& err) {
-			err.SetLineNumber(err.GetLineNumber() + func.HeaderLineNumber);
-
-			// So if we are deep in the stack, the functions above do not modify
-			// the line number to the line where the call of this function occurred.
-			err.LockNumberLine(); 
-			throw;
+		if (auto const returnValue{Secret::CallFrom(func, [&] { return m_pFunMan->CallFunction(funcName); })};
+			returnValue.has_value()) 
+		{
+			m_Values.PushRValue(*returnValue);
 		}
 
 		// for (auto& param : func.Params | view::filter([](auto& p) { return !p.IsPassedByRef(); })) {
@@ -307,11 +341,102 @@ namespace ArCalc {
 		// }
 	}
 
-	bool PostfixMathEvaluator::IsCharValidForIdent(char c) {
-		return Str::IsAlNum(c) || c == '_';
+	void PostfixMathEvaluator::EvalPureFunction(std::string_view funcName) {
+		auto const& funMan{std::as_const(*m_pFunMan)};
+		auto const& func{funMan.Get(funcName)};
+		if (m_Values.Size() < func.Params.size()) {
+			throw ExprEvalError{
+				"Function [{}] Expects [{}] arguments, but only [{}] are available in the stack",
+				funcName, func.Params.size(), m_Values.Size()
+			};
+		}
+
+		JoinCallsBeforePopping(func.Params.size());
+		auto args = std::vector<double>(func.Params.size());
+		for (auto& arg : args | view::reverse) {
+			arg = *m_Values.Pop();
+		}
+
+		// This call runs later or right away, either way the pending ones can run meanwhile.
+		for (auto& call : m_PendingCalls) {
+			if (call.bForked) {
+				continue;
+			} else if (!CanFork()) {
+				break;
+			}
+
+			if (!m_ForkedCalls) {
+				m_ForkedCalls.emplace(*m_pFunMan->GetThreadPool());
+			}
+			call.bForked = true;
+			m_ForkedCalls->Run([&call, &funMan] { RunCall(call, funMan); });
+		}
+
+		if (func.ReturnType != FuncReturnType::Number) { // Has no result to hold the place of.
+			if (auto const returnValue{Secret::CallFrom(func, [&] { return funMan.CallFunction(funcName, args); })};
+				returnValue.has_value()) 
+			{
+				m_Values.PushRValue(*returnValue);
+			}
+			return;
+		}
+
+		m_PendingCalls.push_back({
+			.FuncName{funcName}, .pFunc{&func}, .StackIndex{m_Values.Size()}, .Args{std::move(args)},
+		});
+		m_Values.PushRValue(0.0);
 	}
 
-	bool PostfixMathEvaluator::IsCharValidForNumber(char c) {
-		return Str::IsDigit(c) || c == '\'' || c == '.';
+	void PostfixMathEvaluator::JoinCalls() {
+		if (m_PendingCalls.empty()) {
+			return;
+		}
+
+		for (auto& call : m_PendingCalls) {
+			if (!call.bForked) {
+				RunCall(call, *m_pFunMan);
+			}
+		}
+
+		if (m_ForkedCalls) {
+			m_ForkedCalls->Wait(); // Never throws, RunCall keeps the errors.
+			m_ForkedCalls.reset();
+		}
+
+		auto pError = std::exception_ptr{};
+		for (auto const& call : m_PendingCalls) {
+			if (call.pError) {
+				pError = pError ? pError : call.pError;
+			} else if (call.StackIndex < m_Values.Size()) { // Unless an error cleared it.
+				m_Values.At(call.StackIndex) = ValueStack::Entry::MakeRValue(*call.Result);
+			}
+		}
+
+		m_PendingCalls.clear();
+		if (pError) {
+			std::rethrow_exception(pError);
+		}
+	}
+
+	void PostfixMathEvaluator::JoinCallsBeforePopping(size_t popCount) {
+		if (!m_PendingCalls.empty() && m_PendingCalls.back().StackIndex + popCount >= m_Values.Size()) {
+			JoinCalls();
+		}
+	}
+
+	bool PostfixMathEvaluator::CanFork() const {
+		auto const& pool{*m_pFunMan->GetThreadPool()};
+		return pool.GetQueuedCount() < pool.GetWorkerCount();
+	}
+
+	void PostfixMathEvaluator::RunCall(PendingCall& call, FunctionManager const& funMan) {
+		try {
+			call.Result = Secret::CallFrom(*call.pFunc, [&] { return funMan.CallFunction(call.FuncName, call.Args); });
+			if (!call.Result.has_value()) {
+				throw ExprEvalError{"Function [{}] returned none", call.FuncName};
+			}
+		} catch (...) {
+			call.pError = std::current_exception();
+		}
 	}
 }
\ No newline at end of file
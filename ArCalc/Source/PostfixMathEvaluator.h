@@ -5,44 +5,82 @@
 #include "Util/LiteralManager.h"
 #include "Util/FunctionManager.h"
 #include "Util/NumberParser.h"
+#include "Util/Lexer.h"
+#include "Util/ThreadPool.h"
 
 namespace ArCalc {
 	class PostfixMathEvaluator : public IEvaluator {
-	private:
-		enum class St : std::size_t;
-
 	public:
 		PostfixMathEvaluator(LiteralManager& litMan, FunctionManager& funMan);
 
 		std::optional<double> Eval(std::string_view exprString);
+		std::optional<double> Eval(LexedExpr const& expr);
 		void Reset();
 
-	private:
-		void DoIteration(char c);
+		// Points the evaluator at another scope, keeping the capacity of its buffers.
+		// [tempMem] is where the per-expression temporaries will be allocated from.
+		void Rebind(LiteralManager& litMan, FunctionManager& funMan, 
+			std::pmr::memory_resource& tempMem = *std::pmr::get_default_resource());
 
-		void ParseWhiteSpace(char c);
-		void ParseIdentifier(char c);
-		void ParseSymbolicOperator(char op);
+		// Remembers what every name refers to the first time it is used, until the next Rebind.
+		// Only for as long as no literal or function of the scope is added or removed.
+		void CacheSymbols();
+
+	private:
+		// What a name refers to, in the order EvalIdentifier checks for it.
+		struct Symbol {
+			enum class Kind { 
+				Literal, Last, Function, Constant, 
+				UnaryOperator, BinaryOperator, VariadicOperator, 
+				Keyword, Unknown,
+			};
 
-		void ParseNumber(char c);
+			Kind Type;
+			double* pValue{}; // Literal and Last.
+			double Value{};   // Constant.
+		};
 
-		void ParseMinusSign(char c);
-		void PushLiteralValue();
+		// A call of a pure function (see FunctionManager::IsPure), whose result takes the 
+		// place of the value at [StackIndex] once it is joined. It is only forked to the 
+		// thread pool once another call comes after it, while its result is not needed yet, 
+		// so a lone call never pays for forking; otherwise it runs inline when joined.
+		struct PendingCall {
+			std::string_view FuncName;
+			FuncData const* pFunc;
+			size_t StackIndex;
+			std::vector<double> Args;
+			bool bForked{};
+			std::optional<double> Result{};
+			std::exception_ptr pError{};
+		};
 
 	private:
-		void SetState(St newState);
-		void ResetState(char c);
-		St GetState() const noexcept;
+		void EvalToken(Token const& token);
+		std::optional<double> PopResult();
 
-		void AddChar(char c);
-		std::string const& GetString() const;
-		void ResetString();
+		void EvalIdentifier(std::string_view identifier, bool bMinus);
+		Symbol Resolve(std::string_view identifier);
+		void EvalSymbol(Symbol const& symbol, std::string_view identifier, bool bMinus);
+		void EvalOperator(std::string_view glyph);
+		void EvalOperator(std::string_view glyph, Symbol::Kind arity);
+		static Symbol::Kind OperatorKindOf(std::string_view glyph);
+		void EvalFunction(std::string_view funcName);
+		void EvalPureFunction(std::string_view funcName);
 
-		bool IsCharValidForIdent(char c);
-		bool IsCharValidForNumber(char c);
+		// Runs the pending calls that were not forked, waits for the others, and puts their
+		// results in place. Throws the error of the first one that failed, if any, so errors
+		// are the same as when calling them one after the other.
+		void JoinCalls();
 
-		void EvalOperator();
-		void EvalFunction();
+		// Same, only if one of the top [popCount] values is the result of a pending call.
+		void JoinCallsBeforePopping(size_t popCount);
+
+		// Forking only pays off while some worker of the pool is out of work. Past that, 
+		// calls run inline, which keeps the many small calls at the bottom of a recursion 
+		// from being forked once every worker is busy.
+		bool CanFork() const;
+
+		static void RunCall(PendingCall& call, FunctionManager const& funMan);
 
 		constexpr void SetLineNumber(size_t toWhat) 
 			{ m_LineNumber = toWhat; }
@@ -50,15 +88,19 @@ namespace ArCalc {
 			{ return m_LineNumber; }
 
 	private:
-		std::string m_CurrStringAcc{};
-		St m_CurrState{};
-		
 		ValueStack m_Values{};
 		
 		size_t m_LineNumber{};
 
-		LiteralManager& m_LitMan;
-		FunctionManager& m_FunMan;
+		LiteralManager* m_pLitMan;
+		FunctionManager* m_pFunMan;
+		std::pmr::memory_resource* m_pTempMem{std::pmr::get_default_resource()};
 		NumberParser m_NumPar{};
+
+		bool m_bCacheSymbols{};
+		Util::StringMap<Symbol> m_Symbols{};
+
+		std::deque<PendingCall> m_PendingCalls{}; // Do not move while forked calls run.
+		std::optional<ThreadPool::TaskGroup> m_ForkedCalls{};
 	};
 }
\ No newline at end of file
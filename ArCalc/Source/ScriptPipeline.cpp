@@ -0,0 +1,150 @@
+#include "ScriptPipeline.h"
+#include "KeywordType.h"
+#include "Util/Keyword.h"
+#include "Util/Str.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	ScriptPipeline::ScriptPipeline(LineReader& reader, bool bAsync) 
+		: m_pReader{&reader}, m_bAsync{bAsync && std::thread::hardware_concurrency() > 1U}
+	{
+		if (m_bAsync) {
+			m_Producer = std::jthread{[this](std::stop_token stopToken) { Produce(stopToken); }};
+		} else {
+			m_Current.Lines.resize(1U);
+		}
+	}
+
+	ScriptPipeline::~ScriptPipeline() {
+		if (m_Producer.joinable()) {
+			m_Producer.request_stop();
+			m_Producer.join();
+		}
+	}
+
+	ScriptPipeline::Line const* ScriptPipeline::Next() {
+		if (!m_bAsync) {
+			return ReadLine(m_Current.Lines.front()) ? &m_Current.Lines.front() : nullptr;
+		}
+
+		if (m_NextIndex == m_Current.Count) {
+			std::unique_lock lock{m_Mutex};
+			if (!m_Current.Lines.empty()) {
+				m_Free.push_back(std::move(m_Current));
+				m_FreeCV.notify_one();
+			}
+
+			m_bConsumerWaiting = true;
+			m_ReadyCV.wait(lock, [&] { return !m_Ready.empty() || m_bDone; });
+			m_bConsumerWaiting = false;
+
+			if (m_Ready.empty()) {
+				if (m_pError) {
+					std::rethrow_exception(std::exchange(m_pError, {}));
+				}
+				m_Current = {};
+				return nullptr;
+			}
+
+			m_Current = std::move(m_Ready.front());
+			m_Ready.pop_front();
+			m_NextIndex = 0U;
+		}
+
+		return &m_Current.Lines[m_NextIndex++];
+	}
+
+	void ScriptPipeline::Produce(std::stop_token stopToken) {
+		auto const publish = [&](Batch&& batch) {
+			std::scoped_lock lock{m_Mutex};
+			m_Ready.push_back(std::move(batch));
+			m_ReadyCV.notify_one();
+		};
+
+		try {
+			for (bool bEnd{}; !bEnd && !stopToken.stop_requested();) {
+				auto batch = [&] {
+					std::unique_lock lock{m_Mutex};
+					if (m_Free.empty() && m_BatchCount < sc_MaxBatchCount) {
+						++m_BatchCount;
+						return Batch{.Lines = std::vector<Line>(sc_BatchSize)};
+					}
+
+					m_FreeCV.wait(lock, stopToken, [&] { return !m_Free.empty(); });
+					if (m_Free.empty()) { // Stopped.
+						return Batch{};
+					}
+
+					auto res{std::move(m_Free.back())};
+					m_Free.pop_back();
+					return res;
+				}(/*)(*/);
+
+				if (batch.Lines.empty()) {
+					break;
+				}
+
+				batch.Count = 0U;
+				while (batch.Count < batch.Lines.size()) {
+					if (!ReadLine(batch.Lines[batch.Count])) {
+						bEnd = true;
+						break;
+					}
+
+					Prepare(batch.Lines[batch.Count++]);
+					if (m_bConsumerWaiting.load(std::memory_order_relaxed)) {
+						break;
+					}
+				}
+
+				if (batch.Count > 0U) {
+					publish(std::move(batch));
+				}
+			}
+		} catch (...) {
+			std::scoped_lock lock{m_Mutex};
+			m_pError = std::current_exception();
+		}
+
+		std::scoped_lock lock{m_Mutex};
+		m_bDone = true;
+		m_ReadyCV.notify_one();
+	}
+
+	bool ScriptPipeline::ReadLine(Line& line) {
+		auto const text{m_pReader->Next()};
+		if (!text) {
+			return false;
+		}
+
+		line.Text.assign(*text);
+		line.Expr.Source = {};
+		line.Index = m_pReader->GetLineCount() - 1U;
+		return true;
+	}
+
+	void ScriptPipeline::Prepare(Line& line) {
+		// Cut the same way Parser::ParseLine and the keyword handlers cut the line, as Eval 
+		// only uses the tokens when it is given this exact part of the text.
+		auto expr{Str::Trim<std::string_view>(line.Text)};
+		if (!expr.empty() && expr.back() == ';') {
+			expr.remove_suffix(1U);
+		}
+
+		if (expr.empty()) {
+			return;
+		} else if (auto const keyword{Keyword::FromString(Str::GetFirstToken<std::string_view>(expr))}) {
+			if (*keyword != KeywordType::Set && *keyword != KeywordType::Last) {
+				return;
+			} else if (*keyword == KeywordType::Set) { // _Set name expr
+				Str::ChopFirstToken<std::string_view>(expr);
+				Str::ChopFirstToken<std::string_view>(expr);
+			}
+		}
+
+		try { Lexer::LexAll(expr, line.Expr); } 
+		catch (ArCalcException const&) {
+			// Left for the parser, which reports it when the line runs.
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Core.h"
+#include "Util/LineReader.h"
+#include "Util/Lexer.h"
+
+namespace ArCalc {
+	/// Hands out the lines of a script in order, like LineReader, except that reading and 
+	/// lexing them can happen ahead of time on a helper thread, while the parser is still 
+	/// running the lines before them.
+	/// 
+	/// Only what does not depend on the session is done ahead of time: lines are never 
+	/// resolved against literals or functions, so _Func, _Load or anything else changing what 
+	/// a name refers to can not make a prepared line stale. Everything else (including lexing 
+	/// anything the preparation did not guess right) still happens in order, on the thread 
+	/// running the parser. Lines that fail to lex are left for the parser as well, so their 
+	/// errors are reported in order.
+	class ScriptPipeline {
+	public:
+		struct Line {
+			std::string Text;
+			LexedExpr Expr; // Of the expression Parser::Eval will be given, if any.
+			size_t Index;   // Of the line in the script, starting at 0.
+		};
+
+	public:
+		ScriptPipeline(ScriptPipeline const&)            = delete;
+		ScriptPipeline(ScriptPipeline&&)                 = delete;
+		ScriptPipeline& operator=(ScriptPipeline const&) = delete;
+		ScriptPipeline& operator=(ScriptPipeline&&)      = delete;
+
+		// [reader] is only touched by the helper thread (if any) until Next returns nothing.
+		// There is no helper thread on single-core machines, where it would only get in the way.
+		ScriptPipeline(LineReader& reader, bool bAsync);
+		~ScriptPipeline();
+
+	public:
+		// The line is only valid until the next call.
+		Line const* Next();
+
+		// Lines smaller than this are not worth the thread.
+		constexpr static size_t sc_MinAsyncScriptSize{64U * 1024U};
+
+		// Lines are handed over in batches, so the threads rarely have to synchronize.
+		constexpr static size_t sc_BatchSize{64U};
+		constexpr static size_t sc_MaxBatchCount{8U};
+
+	private:
+		struct Batch {
+			std::vector<Line> Lines;
+			size_t Count{};
+		};
+
+		void Produce(std::stop_token stopToken);
+		bool ReadLine(Line& line);
+		static void Prepare(Line& line);
+
+	private:
+		LineReader* m_pReader;
+		bool m_bAsync;
+
+		Batch m_Current{};
+		size_t m_NextIndex{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable_any m_ReadyCV{};
+		std::condition_variable_any m_FreeCV{};
+		std::deque<Batch> m_Ready{};
+		std::vector<Batch> m_Free{};
+		size_t m_BatchCount{};
+		bool m_bDone{};
+		std::exception_ptr m_pError{};
+
+		// Set while Next is waiting, so the helper hands over what it has without filling 
+		// the batch first, which keeps output flowing when the script is slow to read.
+		std::atomic<bool> m_bConsumerWaiting{};
+
+		std::jthread m_Producer{}; // Last, so it is stopped before the rest is destroyed.
+	};
+}
\ No newline at end of file
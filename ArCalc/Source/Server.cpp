@@ -0,0 +1,248 @@
+#include "Server.h"
+#include "Exception/ArCalcException.h"
+#include "Util/IO.h"
+
+namespace ArCalc {
+	namespace Secret {
+		/// Counts latencies in buckets that get wider as the latencies get longer, so that
+		/// every bucket is within about 6% of the latencies in it, and a server running for 
+		/// months still only needs a few kilobytes for them.
+		class LatencyHistogram {
+		public:
+			void Record(std::uint64_t micros, size_t count) {
+				m_Counts[IndexOf(micros)] += count;
+				m_Total += count;
+				m_Max = std::max(m_Max, micros);
+			}
+
+			// Upper bound of the bucket the [fraction] quantile falls into.
+			std::uint64_t Quantile(double fraction) const {
+				if (m_Total == 0U) {
+					return 0U;
+				}
+
+				auto const rank{std::max<size_t>(1U, 
+					static_cast<size_t>(std::ceil(fraction * static_cast<double>(m_Total))))};
+				auto seen = size_t{};
+				for (auto const i : view::iota(size_t{}, sc_BucketCount)) {
+					seen += m_Counts[i];
+					if (seen >= rank) {
+						return std::min(UpperBoundOf(i), m_Max);
+					}
+				}
+
+				return m_Max;
+			}
+
+			constexpr size_t GetTotal() const { return m_Total; }
+			constexpr std::uint64_t GetMax() const { return m_Max; }
+
+		private:
+			// Values below sc_SubBucketCount get a bucket each, the rest get sc_SubBucketCount / 2 
+			// buckets per power of two.
+			constexpr static size_t sc_SubBucketCount{32U};
+			constexpr static size_t sc_HalfCount{sc_SubBucketCount / 2U};
+			constexpr static size_t sc_BucketCount{sc_SubBucketCount + 64U * sc_HalfCount};
+
+			constexpr static size_t IndexOf(std::uint64_t value) {
+				if (value < sc_SubBucketCount) {
+					return static_cast<size_t>(value);
+				}
+
+				auto const shift{static_cast<size_t>(std::bit_width(value)) - 5U};
+				auto const top{static_cast<size_t>(value >> shift)}; // In [16, 32).
+				return sc_SubBucketCount + (shift - 1U) * sc_HalfCount + (top - sc_HalfCount);
+			}
+
+			constexpr static std::uint64_t UpperBoundOf(size_t index) {
+				if (index < sc_SubBucketCount) {
+					return index;
+				}
+
+				auto const shift{(index - sc_SubBucketCount) / sc_HalfCount + 1U};
+				auto const top{(index - sc_SubBucketCount) % sc_HalfCount + sc_HalfCount};
+				return ((std::uint64_t{top} + 1U) << shift) - 1U;
+			}
+
+		private:
+			std::array<size_t, sc_BucketCount> m_Counts{};
+			size_t m_Total{};
+			std::uint64_t m_Max{};
+		};
+	}
+
+	struct Server::Connection {
+		Connection(Engine& engine, LocalSocket&& socket) 
+			: Socket{std::move(socket)}, Session{engine.CreateSession(Output)} {}
+
+		LocalSocket Socket;
+		std::ostringstream Output{}; // What the session printed for the current batch.
+		Engine::Session Session;
+		std::atomic<bool> bDone{};
+		std::jthread Thread{}; // Last, so it is stopped before the rest is destroyed.
+	};
+
+	Server::Server(fs::path const& socketPath) : Server{socketPath, Options{}} {}
+
+	Server::Server(fs::path const& socketPath, Options const& options) 
+		: m_Options{options}, m_Engine{std::random_device{}(), options.WorkerCount}, 
+		  m_Listener{socketPath}, 
+		  m_BatchSlots{static_cast<std::ptrdiff_t>(std::max<size_t>(m_Engine.GetPool().GetWorkerCount(), 1U))},
+		  m_pLatencies{std::make_unique<Secret::LatencyHistogram>()}
+	{
+	}
+
+	Server::~Server() {
+		Stop();
+	}
+
+	void Server::Run() {
+		while (!m_bStopping) {
+			ReapConnections();
+			auto socket{m_Listener.Accept(sc_PollInterval)};
+			if (!socket) {
+				continue;
+			}
+
+			auto& connection{*m_Connections.emplace_back(
+				std::make_unique<Connection>(m_Engine, std::move(*socket)))};
+			connection.Thread = std::jthread{[this, &connection](std::stop_token stopToken) {
+				try {
+					Serve(connection, stopToken);
+				} catch (...) {
+					// Whatever went wrong, it only takes this connection down.
+				}
+				connection.Socket.Shutdown();
+				connection.bDone = true;
+			}};
+
+			auto const lock{std::scoped_lock{m_StatsMutex}};
+			++m_ConnectionCount;
+		}
+
+		m_Connections.clear(); // Stops every connection thread, and waits for them.
+	}
+
+	void Server::Stop() {
+		m_bStopping = true;
+	}
+
+	Server::Report Server::GetReport() const {
+		using std::chrono::microseconds;
+
+		auto const lock{std::scoped_lock{m_StatsMutex}};
+		auto const elapsed{std::chrono::duration<double>{std::chrono::steady_clock::now() - m_StartTime}};
+		auto const& latencies{*m_pLatencies};
+		return Report{
+			.ConnectionCount   = m_ConnectionCount,
+			.EvictionCount     = m_EvictionCount,
+			.RequestCount      = latencies.GetTotal(),
+			.BatchCount        = m_BatchCount,
+			.RequestsPerSecond = static_cast<double>(latencies.GetTotal()) / std::max(elapsed.count(), 1e-9),
+			.LatencyP50        = microseconds{latencies.Quantile(0.50)},
+			.LatencyP90        = microseconds{latencies.Quantile(0.90)},
+			.LatencyP99        = microseconds{latencies.Quantile(0.99)},
+			.LatencyMax        = microseconds{latencies.GetMax()},
+		};
+	}
+
+	void Server::PrintReport(std::ostream& os) const {
+		auto const report{GetReport()};
+		IO::Print(os, "{} connections ({} evicted), {} requests in {} batches, {:.0f} requests/s.\n"
+			"Latency p50 {}, p90 {}, p99 {}, max {}.\n",
+			report.ConnectionCount, report.EvictionCount, report.RequestCount, report.BatchCount,
+			report.RequestsPerSecond, report.LatencyP50, report.LatencyP90, report.LatencyP99, 
+			report.LatencyMax);
+	}
+
+	void Server::Serve(Connection& connection, std::stop_token stopToken) {
+		auto buffer = std::vector<char>(sc_ReceiveSize);
+		auto pending = std::string{}; // Received, but not answered yet.
+		auto lastActive{std::chrono::steady_clock::now()};
+
+		while (!stopToken.stop_requested()) {
+			auto const received{connection.Socket.Receive(buffer, sc_PollInterval)};
+			auto const receivedAt{std::chrono::steady_clock::now()};
+			if (!received) {
+				if (receivedAt - lastActive >= m_Options.IdleTimeout) {
+					auto const lock{std::scoped_lock{m_StatsMutex}};
+					++m_EvictionCount;
+					return;
+				}
+				continue;
+			}
+
+			if (*received == 0U) {
+				return; // The client is done.
+			}
+
+			lastActive = receivedAt;
+			pending.append(buffer.data(), *received);
+			auto const batchEnd{pending.rfind('\n')};
+			if (batchEnd == std::string::npos) {
+				continue; // Not even one complete line yet.
+			}
+
+			auto lines = std::vector<std::string_view>{};
+			for (auto const line : std::string_view{pending}.substr(0U, batchEnd) | view::split('\n')) {
+				auto lineView{std::string_view{line}};
+				if (lineView.ends_with('\r')) {
+					lineView.remove_suffix(1U);
+				}
+				lines.push_back(lineView);
+			}
+
+			m_BatchSlots.acquire();
+			auto const answers = [&] {
+				try {
+					auto res{EvalBatch(connection, lines)};
+					m_BatchSlots.release();
+					return res;
+				} catch (...) {
+					m_BatchSlots.release();
+					throw;
+				}
+			}(/*)(*/);
+
+			// Counted before the client can see the answers, so a report it asks for next has them.
+			RecordBatch(lines.size(), std::chrono::steady_clock::now() - receivedAt);
+			connection.Socket.Send(answers);
+			pending.erase(0U, batchEnd + 1U);
+		}
+	}
+
+	std::string Server::EvalBatch(Connection& connection, std::span<std::string_view const> lines) {
+		auto& output{connection.Output};
+		auto& parser{connection.Session.GetParser()};
+
+		for (auto const line : lines) {
+			try {
+				connection.Session.ParseLine(line);
+			} catch (ArCalcException& err) {
+				if (err.GetLineNumber() == 0) { // Same as in App::Run.
+					err.SetLineNumber(parser.GetLineNumber());
+				}
+
+				IO::Print(output, "ERROR: {}. [{} {}]\n", err.GetMessage(), err.GetType(), 
+					err.GetLineNumber());
+				parser.ExceptionReset();
+			}
+			output << sc_EndOfAnswer;
+		}
+
+		auto res{std::move(output).str()};
+		output.str({});
+		return res;
+	}
+
+	void Server::ReapConnections() {
+		std::erase_if(m_Connections, [](auto const& pConnection) { return pConnection->bDone.load(); });
+	}
+
+	void Server::RecordBatch(size_t lineCount, std::chrono::steady_clock::duration latency) {
+		auto const micros{std::chrono::duration_cast<std::chrono::microseconds>(latency).count()};
+		auto const lock{std::scoped_lock{m_StatsMutex}};
+		m_pLatencies->Record(static_cast<std::uint64_t>(micros), lineCount);
+		++m_BatchCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Core.h"
+#include "Engine.h"
+#include "Util/LocalSocket.h"
+
+namespace ArCalc {
+	namespace Secret {
+		class LatencyHistogram;
+	}
+
+	/// Serves ArCalc sessions to local clients over a Unix domain socket.
+	///
+	/// Every connection gets a session of its own (see Engine). Clients send lines, and
+	/// every line is answered with whatever the session printed for it, followed by 
+	/// sc_EndOfAnswer. Errors are answered with "ERROR: <message>. [<type> <line>]".
+	///
+	/// Each connection has a thread waiting for its lines, and all the complete lines that
+	/// arrive together are evaluated as one batch, on that thread. So a client that sends 
+	/// many lines without waiting for the answers gets them evaluated in big batches, and it 
+	/// is the number of workers of the engine's pool, not of connections, that decides how 
+	/// many sessions are evaluating at the same time. The pool itself only runs what the 
+	/// evaluations fork, as a task waiting for those may run any queued task meanwhile, 
+	/// which must never be another connection's whole batch.
+	///
+	/// A connection that sends nothing for longer than the idle timeout is closed, and its
+	/// session is discarded.
+	class Server {
+	public:
+		struct Options {
+			// Threads of the engine's pool, 0 means one per core.
+			size_t WorkerCount{};
+			std::chrono::milliseconds IdleTimeout{std::chrono::minutes{5}};
+		};
+
+		struct Report {
+			size_t ConnectionCount;
+			size_t EvictionCount;
+			size_t RequestCount; // Lines answered.
+			size_t BatchCount;
+			double RequestsPerSecond; // Since the server was created.
+
+			// From receiving a line to its answer being ready to send, accurate to about 6%.
+			std::chrono::microseconds LatencyP50;
+			std::chrono::microseconds LatencyP90;
+			std::chrono::microseconds LatencyP99;
+			std::chrono::microseconds LatencyMax;
+		};
+
+	public:
+		Server(Server const&)            = delete;
+		Server(Server&&)                 = delete;
+		Server& operator=(Server const&) = delete;
+		Server& operator=(Server&&)      = delete;
+
+		Server(fs::path const& socketPath);
+		Server(fs::path const& socketPath, Options const& options);
+
+		// Run must have returned by then.
+		~Server();
+
+	public:
+		// Accepts clients until Stop is called, then closes every connection and returns.
+		void Run();
+
+		// Can be called from any thread.
+		void Stop();
+
+		Report GetReport() const;
+		void PrintReport(std::ostream& os) const;
+
+		constexpr fs::path const& GetPath() const {
+			return m_Listener.GetPath();
+		}
+
+		constexpr static std::string_view sc_EndOfAnswer{".\n"};
+
+	private:
+		struct Connection;
+
+		void Serve(Connection& connection, std::stop_token stopToken);
+		std::string EvalBatch(Connection& connection, std::span<std::string_view const> lines);
+		void ReapConnections();
+		void RecordBatch(size_t lineCount, std::chrono::steady_clock::duration latency);
+
+		// How often the threads waiting on sockets check whether they should stop.
+		constexpr static std::chrono::milliseconds sc_PollInterval{50};
+		constexpr static size_t sc_ReceiveSize{64U * 1024U};
+
+	private:
+		Options m_Options;
+		Engine m_Engine;
+		LocalListener m_Listener;
+		std::chrono::steady_clock::time_point const m_StartTime{std::chrono::steady_clock::now()};
+		std::atomic<bool> m_bStopping{};
+		std::counting_semaphore<> m_BatchSlots; // One per worker of the engine's pool.
+
+		// Only touched by Run.
+		std::list<std::unique_ptr<Connection>> m_Connections;
+
+		mutable std::mutex m_StatsMutex{};
+		std::unique_ptr<Secret::LatencyHistogram> m_pLatencies;
+		size_t m_ConnectionCount{};
+		size_t m_EvictionCount{};
+		size_t m_BatchCount{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "ShardedSweep.h"
+#include "TextResultSink.h"
+#include "Util/CategoryFile.h"
+#include "Util/ChildProcess.h"
+#include "Util/IO.h"
+#include "Util/NumberFormatter.h"
+#include "Util/OutputSink.h"
+#include "Util/ScriptCache.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	namespace Secret {
+		constexpr std::string_view sc_JobFileName{"job"};
+		constexpr std::string_view sc_ManifestFileName{"manifest"};
+
+		fs::path GetPartialPath(fs::path path) {
+			return path += ".partial";
+		}
+
+		fs::path GetFailedPath(fs::path path) {
+			return path.replace_extension(".failed");
+		}
+	}
+
+	ShardedSweep::ShardedSweep(Sweep const& sweep, FunctionManager& funMan, fs::path const& resultPath)
+		: m_ResultPath{resultPath}, m_Directory{GetDirectory(resultPath)}
+	{
+		sweep.ExpectAllParamsSwept();
+
+		auto const pointCount{sweep.GetPointCount()};
+		auto const shardSize{std::max(sc_MinShardSize, (pointCount + sc_MaxShardCount - 1U) / sc_MaxShardCount)};
+		m_ShardCount = (pointCount + shardSize - 1U) / shardSize;
+
+		// Everything a worker needs, and what tells one job from another in the manifest.
+		auto job = std::ostringstream{};
+		job << sweep.GetFuncName() << ' ' << shardSize << ' ' << sweep.GetAxes().size() << '\n';
+		for (auto const& axis : sweep.GetAxes()) {
+			job << axis.Name << ' ';
+			NumberFormatter::Write(job, axis.First);
+			job << ' ';
+			NumberFormatter::Write(job, axis.Step);
+			job << ' ' << axis.Count << '\n';
+		}
+
+		for (auto const& funcName : funMan.GetReachable(sweep.GetFuncName())) {
+			funMan.Serialize(funcName, job);
+		}
+		m_Job = std::move(job).str();
+	}
+
+	void ShardedSweep::Run(size_t processCount) {
+		ARCALC_DA(processCount > 0U, "Running a sharded sweep in no processes");
+
+		auto pending = std::deque<size_t>{};
+		auto const done{ReadManifest()};
+		for (auto const shardIndex : view::iota(size_t{}, m_ShardCount)) {
+			if (range::find(done, shardIndex) == done.end()) {
+				pending.push_back(shardIndex);
+			}
+		}
+
+		struct Worker {
+			size_t ShardIndex;
+			ChildProcess Process;
+		};
+
+		auto const workerPath{GetWorkerPath()};
+		auto workers = std::vector<Worker>{};
+		while (!pending.empty() || !workers.empty()) {
+			while (workers.size() < processCount && !pending.empty()) {
+				auto const shardIndex{pending.front()};
+				pending.pop_front();
+
+				auto const args = std::array{
+					std::string{sc_WorkerArg}, m_Directory.string(), std::to_string(shardIndex),
+				};
+				workers.push_back({.ShardIndex{shardIndex}, .Process{workerPath, args}});
+			}
+
+			// The oldest one is the most likely to be done first.
+			workers.front().Process.Wait(sc_PollInterval);
+			std::erase_if(workers, [this](Worker& worker) {
+				if (auto const exitCode{worker.Process.Wait({})}; exitCode.has_value()) {
+					OnWorkerExited(worker.ShardIndex, *exitCode);
+					return true;
+				}
+				return false;
+			});
+		}
+		m_Manifest.close();
+
+		if (!m_Failures.empty()) {
+			auto const& failure{range::min(m_Failures, {}, &Failure::ShardIndex)};
+			throw ParseError{
+				"{} of the {} shards of the sweep failed, the first one with: {}. Running it "
+				"again only runs the shards that failed",
+				m_Failures.size(), m_ShardCount, failure.Reason
+			};
+		}
+		JoinShards();
+	}
+
+	int ShardedSweep::RunWorker(fs::path const& directory, size_t shardIndex) {
+		auto const shardPath{GetShardPath(directory, shardIndex)};
+		try {
+			std::ifstream job{directory / Secret::sc_JobFileName};
+			if (!job.is_open()) {
+				throw IOError{"Could not open the sweep job in [{}]", directory.string()};
+			}
+
+			auto const funcName{IO::Input<std::string>(job)};
+			auto const shardSize{IO::Input<size_t>(job)};
+			auto axes = std::vector<Sweep::Axis>(IO::Input<size_t>(job));
+			for (auto& axis : axes) {
+				job >> axis.Name >> axis.First >> axis.Step >> axis.Count;
+			}
+
+			auto funMan = FunctionManager{std::cout};
+			for (char tag{}; job >> tag;) {
+				if (tag != CategoryFile::sc_FunctionTag) {
+					throw IOError{"The sweep job in [{}] is corrupted", directory.string()};
+				}
+				funMan.Deserialize(job);
+			}
+
+			auto sweep = Sweep{std::cout, funMan, funcName};
+			for (auto const& axis : axes) {
+				sweep.AddAxis(axis);
+			}
+
+			auto const firstPoint{shardIndex * shardSize};
+			if (firstPoint >= sweep.GetPointCount()) {
+				throw IOError{"The sweep job in [{}] has no shard {}", directory.string(), shardIndex};
+			}
+
+			// Only a shard that was completely written gets its name.
+			auto const partialPath{Secret::GetPartialPath(shardPath)};
+			{
+				std::ofstream file{partialPath};
+				OutputSink buffer{file};
+				std::ostream os{&buffer};
+				TextResultSink sink{os};
+				sweep.Run(&sink, 0U, nullptr, firstPoint, std::min(shardSize, sweep.GetPointCount() - firstPoint));
+				buffer.Flush();
+				if (!file) {
+					throw IOError{"Could not write the results of the sweep to [{}]", partialPath.string()};
+				}
+			}
+			fs::rename(partialPath, shardPath);
+			return 0;
+		}
+		catch (ArCalcException const& err) {
+			std::ofstream{Secret::GetFailedPath(shardPath)} << err.GetMessage();
+			return 1;
+		}
+	}
+
+	fs::path ShardedSweep::GetDirectory(fs::path const& resultPath) {
+		return fs::path{resultPath} += ".shards";
+	}
+
+	fs::path ShardedSweep::GetWorkerPath() {
+		auto const currentPath{ChildProcess::GetCurrentExecutablePath()};
+		auto res{currentPath};
+		res.replace_filename("ArCalc").replace_extension(currentPath.extension());
+		if (!fs::is_regular_file(res)) {
+			throw IOError{"Could not find [{}] to run the sweep in", res.string()};
+		}
+		return res;
+	}
+
+	std::vector<size_t> ShardedSweep::ReadManifest() {
+		auto const manifestPath{m_Directory / Secret::sc_ManifestFileName};
+		auto const jobKey{std::format("{:016x}", ScriptCache::Hash(m_Job))};
+
+		auto res = std::vector<size_t>{};
+		if (std::ifstream manifest{manifestPath}; IO::GetLine(manifest) == jobKey) {
+			for (size_t shardIndex{}; manifest >> shardIndex;) {
+				if (shardIndex < m_ShardCount && fs::is_regular_file(GetShardPath(m_Directory, shardIndex))) {
+					res.push_back(shardIndex);
+				}
+			}
+		} else {
+			auto ec = std::error_code{};
+			fs::remove_all(m_Directory, ec);
+			fs::create_directories(m_Directory, ec);
+			if (ec) {
+				throw IOError{"Could not create directory [{}] for the sweep", m_Directory.string()};
+			}
+
+			std::ofstream{m_Directory / Secret::sc_JobFileName} << m_Job;
+			std::ofstream{manifestPath} << jobKey << '\n';
+		}
+
+		// Whatever failed the last time is not worth reporting again.
+		for (auto const shardIndex : view::iota(size_t{}, m_ShardCount)) {
+			auto ec = std::error_code{};
+			fs::remove(Secret::GetFailedPath(GetShardPath(m_Directory, shardIndex)), ec);
+		}
+
+		m_Manifest.open(manifestPath, std::ios::app);
+		if (!m_Manifest.is_open()) {
+			throw IOError{"Could not open the manifest of the sweep in [{}]", m_Directory.string()};
+		}
+		return res;
+	}
+
+	void ShardedSweep::OnWorkerExited(size_t shardIndex, int exitCode) {
+		auto const shardPath{GetShardPath(m_Directory, shardIndex)};
+		if (exitCode == 0 && fs::is_regular_file(shardPath)) {
+			m_Manifest << shardIndex << std::endl; // Flushed, in case this process is next.
+			return;
+		}
+
+		auto const failedPath{Secret::GetFailedPath(shardPath)};
+		m_Failures.push_back({
+			.ShardIndex{shardIndex},
+			.Reason{fs::is_regular_file(failedPath)
+				? IO::FileToString(failedPath)
+				: std::format("the worker exited with code {}", exitCode)},
+		});
+	}
+
+	void ShardedSweep::JoinShards() {
+		{
+			std::ofstream result{m_ResultPath, std::ios::binary};
+			if (!result.is_open()) {
+				throw IOError{"Could not open file [{}] for the results of the sweep", m_ResultPath.string()};
+			}
+
+			for (auto const shardIndex : view::iota(size_t{}, m_ShardCount)) {
+				std::ifstream shard{GetShardPath(m_Directory, shardIndex), std::ios::binary};
+				result << shard.rdbuf();
+			}
+
+			if (!result.flush()) {
+				throw IOError{"Could not write the results of the sweep to [{}]", m_ResultPath.string()};
+			}
+		}
+
+		auto ec = std::error_code{};
+		fs::remove_all(m_Directory, ec);
+	}
+
+	fs::path ShardedSweep::GetShardPath(fs::path const& directory, size_t shardIndex) {
+		return directory / std::format("shard-{:06}.txt", shardIndex);
+	}
+}
\ No newline at end of file
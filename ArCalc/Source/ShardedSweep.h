@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Core.h"
+#include "Sweep.h"
+
+namespace ArCalc {
+	/// Runs a sweep in worker processes (see _Sweep in KeywordType.h), so that an error or a
+	/// crash only loses the shard it happened in, and a sweep that did not finish carries on
+	/// from where it stopped when it is run again.
+	///
+	/// The points are split into shards of consecutive points, whose size only depends on
+	/// the grid. Everything in between runs is kept in a directory next to the result file:
+	/// the job, the results of every finished shard, and a manifest of the finished ones,
+	/// which is only trusted for the same job. Every worker is an ArCalc process running a
+	/// single shard (see RunWorker), and only a shard that was completely written makes it
+	/// into the manifest.
+	///
+	/// Once every shard is done, they are joined into the result file in order, and the
+	/// directory is removed. Shards that failed are reported once the others are done, and
+	/// are the only ones the next run starts again.
+	class ShardedSweep {
+	public:
+		ShardedSweep(ShardedSweep const&)            = delete;
+		ShardedSweep(ShardedSweep&&)                 = delete;
+		ShardedSweep& operator=(ShardedSweep const&) = delete;
+		ShardedSweep& operator=(ShardedSweep&&)      = delete;
+
+		// Throws like Sweep::ExpectAllParamsSwept. [funMan] provides the swept function
+		// and the ones it calls.
+		ShardedSweep(Sweep const& sweep, FunctionManager& funMan, fs::path const& resultPath);
+
+	public:
+		// Runs up to [processCount] workers at a time. Throws ParseError if some shards
+		// failed, after all the others are done.
+		void Run(size_t processCount);
+
+		size_t GetShardCount() const {
+			return m_ShardCount;
+		}
+
+		// Runs shard [shardIndex] of the job in [directory], returns the exit code of the
+		// worker process. The results are written next to the job, and so is the message
+		// of the error that stopped it, if any.
+		static int RunWorker(fs::path const& directory, size_t shardIndex);
+
+		static fs::path GetDirectory(fs::path const& resultPath);
+
+		// The ArCalc executable next to the running one, which is the same one unless
+		// this is another program embedding the parser.
+		static fs::path GetWorkerPath();
+
+		// ArCalc sc_WorkerArg [directory] [shard index] => RunWorker.
+		constexpr static std::string_view sc_WorkerArg{"--sweep-shard"};
+
+		// Shards are at least this big, so starting their process is not what takes long.
+		constexpr static size_t sc_MinShardSize{64U * 1024U};
+		constexpr static size_t sc_MaxShardCount{256U};
+
+	private:
+		struct Failure {
+			size_t ShardIndex;
+			std::string Reason;
+		};
+
+		// Returns the shards of the manifest, after starting a new one if it is of another job.
+		std::vector<size_t> ReadManifest();
+		void OnWorkerExited(size_t shardIndex, int exitCode);
+		void JoinShards();
+
+		static fs::path GetShardPath(fs::path const& directory, size_t shardIndex);
+
+		// How long to wait for the oldest worker, before checking on the others.
+		constexpr static std::chrono::milliseconds sc_PollInterval{50};
+
+	private:
+		fs::path m_ResultPath;
+		fs::path m_Directory;
+		std::string m_Job;
+		size_t m_ShardCount;
+		std::ofstream m_Manifest{};
+		std::vector<Failure> m_Failures{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "StatementGraph.h"
+#include "EvaluatorPool.h"
+#include "KeywordType.h"
+#include "Util/Keyword.h"
+#include "Util/MathConstant.h"
+#include "Util/MathOperator.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	StatementGraph::StatementGraph(std::ostream& os, LiteralManager const& litMan, FunctionManager& funMan)
+		: m_pOStream{&os}, m_pLitMan{&litMan}, m_pFunMan{&funMan} {}
+
+	bool StatementGraph::Add(std::string_view expr, std::string_view target, bool bSemiColon) {
+		auto& stmt{m_Statements.emplace_back(expr, target, bSemiColon)};
+		auto const bAdded = [&] {
+			if (stmt.Text.empty()) { // Only empty lines, a _Set without a value is an error.
+				return stmt.Target.empty();
+			}
+
+			try { Lexer::LexAll(stmt.Text, stmt.Expr); }
+			catch (ArCalcException const&) { return false; }
+
+			return range::all_of(stmt.Expr.Tokens, [&](Token const& token) {
+				return token.Type != TokenType::Identifier || AddInput(stmt, token.Glyph);
+			});
+		}(/*)(*/);
+
+		if (!bAdded) {
+			m_Statements.pop_back();
+			return false;
+		}
+
+		auto const index{m_Statements.size() - 1U};
+		for (auto const& input : stmt.Inputs) {
+			if (input.Producer) {
+				m_Statements[*input.Producer].Dependents.push_back(index);
+				++stmt.PendingCount;
+			}
+		}
+
+		if (!stmt.Target.empty()) {
+			m_Writers.insert_or_assign(stmt.Target, index);
+		} else if (!stmt.IsBlank()) {
+			m_LastWriter = index;
+		}
+		return true;
+	}
+
+	void StatementGraph::Run(ThreadPool& pool) {
+		m_FailedIndex = m_Statements.size();
+
+		// Found before any of them runs, as the others become ready along the way.
+		auto roots = std::vector<size_t>{};
+		for (auto const i : view::iota(size_t{}, m_Statements.size())) {
+			if (m_Statements[i].PendingCount == 0U) {
+				roots.push_back(i);
+			}
+		}
+
+		auto group = ThreadPool::TaskGroup{pool};
+		for (auto const i : roots) {
+			group.Run([this, &group, i] { RunFrom(group, i); });
+		}
+		group.Wait();
+	}
+
+	void StatementGraph::Clear() {
+		m_Statements.clear();
+		m_Writers.clear();
+		m_LastWriter.reset();
+	}
+
+	bool StatementGraph::AddInput(Statement& stmt, std::string_view name) {
+		if (range::find(stmt.Inputs, name, &Input::Name) != stmt.Inputs.end()) {
+			return true;
+		}
+
+		// Resolved in the same order as PostfixMathEvaluator does.
+		if (auto const it{m_Writers.find(name)}; it != m_Writers.end()) {
+			stmt.Inputs.push_back({.Name{name}, .Producer{it->second}});
+		} else if (name == Keyword::ToStringView(KeywordType::Last)) {
+			stmt.Inputs.push_back({.Name{name}, .Producer{m_LastWriter}});
+		} else if (m_pLitMan->IsVisible(name)) {
+			stmt.Inputs.push_back({.Name{name}, .Producer{}});
+		} else if (m_pFunMan->IsDefined(name)) {
+			// Functions returning none would leave _Last alone, depending on how they are called.
+			return m_pFunMan->Get(name).ReturnType == FuncReturnType::Number && m_pFunMan->IsPure(name);
+		} else {
+			return MathConstant::IsValid(name) || MathOperator::IsValid(name);
+		}
+		return true;
+	}
+
+	void StatementGraph::RunFrom(ThreadPool::TaskGroup& group, size_t index) {
+		// The first statement that becomes ready is run right away, so a chain of them stays
+		// on the same thread.
+		for (auto next{std::optional{index}}; next.has_value();) {
+			auto const current{*std::exchange(next, std::nullopt)};
+			auto& stmt{m_Statements[current]};
+			Eval(stmt, current);
+
+			for (auto const dependent : stmt.Dependents) {
+				if (m_Statements[dependent].PendingCount.fetch_sub(1U) != 1U) {
+					continue;
+				} else if (!next) {
+					next = dependent;
+				} else {
+					group.Run([this, &group, dependent] { RunFrom(group, dependent); });
+				}
+			}
+		}
+	}
+
+	void StatementGraph::Eval(Statement& stmt, size_t index) {
+		if (stmt.IsBlank()) {
+			return;
+		}
+
+		// Nothing after the first failure is applied, so it is not worth evaluating either.
+		stmt.bSkipped = index > m_FailedIndex.load(std::memory_order_relaxed)
+			|| range::any_of(stmt.Inputs, [this](Input const& input) {
+				return input.Producer && !m_Statements[*input.Producer].Value.has_value();
+			});
+		if (stmt.bSkipped) {
+			return;
+		}
+
+		auto litMan = LiteralManager{*m_pOStream};
+		for (auto const& input : stmt.Inputs) {
+			auto const bLast{input.Name == Keyword::ToStringView(KeywordType::Last)};
+			auto const value = [&] {
+				if (input.Producer) {
+					return *m_Statements[*input.Producer].Value;
+				}
+				return bLast ? m_pLitMan->GetLast() : *m_pLitMan->Get(input.Name);
+			}(/*)(*/);
+
+			if (bLast) {
+				litMan.SetLast(value);
+			} else {
+				litMan.Add(input.Name, value);
+			}
+		}
+
+		try {
+			auto eval{EvaluatorPool::Acquire(litMan, *m_pFunMan)};
+			stmt.Value = eval->Eval(stmt.Expr);
+			ARCALC_DA(stmt.Value.has_value(), "Statement [{}] evaluated to none", stmt.Text);
+		} catch (ArCalcException const&) {
+			stmt.pError = std::current_exception();
+			for (auto failedIndex{m_FailedIndex.load()}; index < failedIndex;) {
+				if (m_FailedIndex.compare_exchange_weak(failedIndex, index)) {
+					break;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Core.h"
+#include "Util/FunctionManager.h"
+#include "Util/Lexer.h"
+#include "Util/LiteralManager.h"
+#include "Util/ThreadPool.h"
+
+namespace ArCalc {
+	/// Consecutive top-level statements of a script that only compute values (expressions
+	/// and _Sets), evaluated in parallel as far as what they read from each other allows.
+	///
+	/// Every statement reads the literals and the _Last it uses either from the statement
+	/// of the window that last wrote them, or from the literals the window started with, so
+	/// writing a name again never has to wait for the ones reading it before. A statement is
+	/// evaluated as soon as the ones it reads from are done, in a scope of its own that only
+	/// holds what it reads, which makes the whole window take as long as its longest chain.
+	///
+	/// Nothing is applied to the literals of the parser, that is done in order once the
+	/// window ran (see Parser::RunDeferred), stopping at the first statement that failed.
+	class StatementGraph {
+	public:
+		struct Input {
+			std::string_view Name;           // A view into the text of the statement.
+			std::optional<size_t> Producer;  // None for the literals the window started with.
+		};
+
+		struct Statement {
+			Statement(std::string_view text, std::string_view target, bool bSemiColon)
+				: Text{text}, Target{target}, bSemiColon{bSemiColon} {}
+
+			// Whether this is an empty line, which only takes up a line number.
+			bool IsBlank() const {
+				return Expr.Tokens.empty();
+			}
+
+			std::string Text;   // The expression, without the _Set part and the semicolon.
+			std::string Target; // Literal set by a _Set, empty for an expression.
+			bool bSemiColon;
+			LexedExpr Expr{};
+			std::vector<Input> Inputs{};
+
+			std::vector<size_t> Dependents{};
+			std::atomic<size_t> PendingCount{}; // Producers that are not done yet.
+
+			std::optional<double> Value{};
+			std::exception_ptr pError{};
+			bool bSkipped{}; // Reads from a statement that failed, so it never ran.
+		};
+
+	public:
+		StatementGraph(StatementGraph const&)            = delete;
+		StatementGraph(StatementGraph&&)                 = delete;
+		StatementGraph& operator=(StatementGraph const&) = delete;
+		StatementGraph& operator=(StatementGraph&&)      = delete;
+
+		// [litMan] and [funMan] are the ones of the parser, and have to outlive the graph.
+		StatementGraph(std::ostream& os, LiteralManager const& litMan, FunctionManager& funMan);
+
+	public:
+		// Adds the statement setting [target] to [expr], or evaluating [expr] if [target] is
+		// empty. Returns false, leaving the graph as it was, if [expr] does anything but
+		// compute a value out of literals, constants, operators and pure functions.
+		bool Add(std::string_view expr, std::string_view target, bool bSemiColon);
+
+		// Evaluates every statement that is not done yet. Statements after the first one to
+		// fail may not run at all.
+		void Run(ThreadPool& pool);
+
+		void Clear();
+
+		std::deque<Statement> const& GetStatements() const {
+			return m_Statements;
+		}
+
+		size_t GetSize() const {
+			return m_Statements.size();
+		}
+
+		bool IsEmpty() const {
+			return m_Statements.empty();
+		}
+
+		// Statements run at once at most, so the results of a long script keep coming.
+		constexpr static size_t sc_MaxSize{4096U};
+
+	private:
+		// Returns false if [name] is not something a statement of the graph may read.
+		bool AddInput(Statement& stmt, std::string_view name);
+
+		// Evaluates the [index]th statement, then the ones that only waited for it.
+		void RunFrom(ThreadPool::TaskGroup& group, size_t index);
+		void Eval(Statement& stmt, size_t index);
+
+	private:
+		std::ostream* m_pOStream;
+		LiteralManager const* m_pLitMan;
+		FunctionManager* m_pFunMan;
+
+		// Stable addresses, as every statement holds views into its own text.
+		std::deque<Statement> m_Statements{};
+
+		Util::StringMap<size_t> m_Writers{};  // Last statement setting every literal.
+		std::optional<size_t> m_LastWriter{}; // Last expression, which sets _Last.
+
+		std::atomic<size_t> m_FailedIndex{};  // Of the first statement that failed so far.
+	};
+}
@@ -0,0 +1,234 @@
+#include "Sweep.h"
+#include "EvaluatorPool.h"
+#include "KeywordType.h"
+#include "Util/Keyword.h"
+#include "Util/LineArena.h"
+#include "Util/LiteralManager.h"
+#include "Util/ThreadPool.h"
+#include "Util/Str.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	/// What a chunk of points is evaluated in, so nothing is shared between threads.
+	class Sweep::Scope {
+	public:
+		Scope(Scope const&)            = delete;
+		Scope(Scope&&)                 = delete;
+		Scope& operator=(Scope const&) = delete;
+		Scope& operator=(Scope&&)      = delete;
+
+		Scope(Sweep const& sweep)
+			: m_pSweep{&sweep}, m_LitMan{*sweep.m_pOStream}, m_FunMan{*sweep.m_pFunMan},
+			  m_Point(sweep.m_Axes.size()),
+			  m_Eval{EvaluatorPool::Acquire(m_LitMan, m_FunMan, m_Arena.Resource())}
+		{
+			for (auto const& paramName : sweep.m_ParamNames) {
+				m_LitMan.Add(paramName, 0.0);
+			}
+
+			// Only taken once all of them were added, as adding more may move them around.
+			for (auto const& paramName : sweep.m_ParamNames) {
+				m_pArgs.push_back(&m_LitMan.Get(paramName));
+			}
+			m_Eval->CacheSymbols();
+		}
+
+	public:
+		double Eval(size_t index) {
+			m_pSweep->GetPoint(index, m_Point);
+			for (auto const i : view::iota(size_t{}, m_pArgs.size())) {
+				*m_pArgs[i] = m_Point[m_pSweep->m_ParamAxes[i]];
+			}
+
+			try {
+				auto const value{m_Eval->Eval(m_pSweep->m_Expr)};
+				m_Arena.Reset();
+				if (!value.has_value()) {
+					throw ExprEvalError{"Function [{}] returned none", m_pSweep->m_FuncName};
+				}
+				return *value;
+			} catch (ArCalcException const&) {
+				m_Eval->Reset();
+				m_Arena.Reset();
+				throw;
+			}
+		}
+
+	private:
+		Sweep const* m_pSweep;
+		LiteralManager m_LitMan;
+		FunctionManager m_FunMan;
+		LineArena m_Arena{};
+		std::vector<double*> m_pArgs{};
+		std::vector<double> m_Point;
+		EvaluatorPool::Lease m_Eval;
+	};
+
+	Sweep::Sweep(std::ostream& os, FunctionManager& funMan, std::string_view funcName)
+		: m_pOStream{&os}, m_pFunMan{&funMan}, m_FuncName{funcName}
+	{
+		if (!funMan.IsDefined(funcName)) {
+			throw ParseError{"Sweeping undefined function [{}]", funcName};
+		}
+
+		auto const& func{funMan.Get(funcName)};
+		if (func.ReturnType != FuncReturnType::Number) {
+			throw SyntaxError{"Sweeping function [{}], which returns {}", funcName, func.ReturnType};
+		} else if (func.Params.empty()) {
+			throw SyntaxError{"Sweeping function [{}], which takes no parameters", funcName};
+		}
+
+		for (auto const& param : func.Params) {
+			if (param.IsPassedByRef()) {
+				throw SyntaxError{
+					"Sweeping function [{}], which takes [{}] by reference",
+					funcName, param.GetName()
+				};
+			}
+			m_ParamNames.push_back(param.GetName());
+		}
+
+		// A body of a single return is evaluated directly, instead of going through a
+		// sub-parser for every point.
+		m_ExprText = [&] {
+			if (func.CodeLines.size() == 1U) {
+				auto line{Str::Trim<std::string_view>(func.CodeLines.front())};
+				if (!line.empty() && line.back() == ';') {
+					line.remove_suffix(1U);
+				}
+
+				if (Str::ChopFirstToken<std::string_view>(line) == Keyword::ToStringView(KeywordType::Return)
+					&& !Str::Trim<std::string_view>(line).empty())
+				{
+					return std::string{Str::Trim<std::string_view>(line)};
+				}
+			}
+
+			auto call = std::string{};
+			for (auto const& paramName : m_ParamNames) {
+				call += paramName + ' ';
+			}
+			return call + m_FuncName;
+		}(/*)(*/);
+		Lexer::LexAll(m_ExprText, m_Expr);
+
+		m_bParallel = funMan.CanCallFromCopiesInParallel(funcName);
+	}
+
+	void Sweep::AddAxis(std::string_view paramName, double first, double last, double step) {
+		// Forgives [step] not adding up to exactly [last], as it rarely does in binary.
+		auto const stepCount{(last - first) / step};
+		if (!std::isfinite(stepCount) || stepCount < 0.0 || step == 0.0) {
+			throw SyntaxError{
+				"Sweeping parameter [{}] from {} to {} never gets there in steps of {}",
+				paramName, first, last, step
+			};
+		}
+
+		AddAxis({
+			.Name{std::string{paramName}}, .First{first}, .Step{step}, 
+			.Count{static_cast<size_t>(std::floor(stepCount + 1e-9)) + 1U},
+		});
+	}
+
+	void Sweep::AddAxis(Axis const& axis) {
+		if (range::find(m_ParamNames, axis.Name) == m_ParamNames.end()) {
+			throw SyntaxError{"Function [{}] has no parameter [{}] to sweep", m_FuncName, axis.Name};
+		} else if (range::find(m_Axes, axis.Name, &Axis::Name) != m_Axes.end()) {
+			throw SyntaxError{"Sweeping parameter [{}] twice", axis.Name};
+		} else if (axis.Count == 0U 
+			|| axis.Count > std::numeric_limits<size_t>::max() / std::max(GetPointCount(), size_t{1U})) 
+		{
+			throw SyntaxError{"Sweeping parameter [{}] makes too many points", axis.Name};
+		}
+
+		m_Axes.push_back(axis);
+	}
+
+	void Sweep::ExpectAllParamsSwept() const {
+		for (auto const& paramName : m_ParamNames) {
+			if (range::find(m_Axes, paramName, &Axis::Name) == m_Axes.end()) {
+				throw SyntaxError{"Parameter [{}] of function [{}] is not swept", paramName, m_FuncName};
+			}
+		}
+	}
+
+	void Sweep::Run(IResultSink* pSink, size_t lineNumber, ThreadPool* pPool) {
+		Run(pSink, lineNumber, pPool, 0U, GetPointCount());
+	}
+
+	void Sweep::Run(IResultSink* pSink, size_t lineNumber, ThreadPool* pPool, 
+		size_t firstPoint, size_t pointCount) 
+	{
+		ExpectAllParamsSwept();
+		ARCALC_DA(firstPoint + pointCount <= GetPointCount(), "Sweeping past the last point");
+
+		m_ParamAxes.clear();
+		for (auto const& paramName : m_ParamNames) {
+			m_ParamAxes.push_back(static_cast<size_t>(
+				range::find(m_Axes, paramName, &Axis::Name) - m_Axes.begin()));
+		}
+
+		std::vector<double> values(std::min(pointCount, sc_BlockSize));
+		std::vector<double> point(m_Axes.size());
+		auto const pointEnd{firstPoint + pointCount};
+		for (auto blockBegin{firstPoint}; blockBegin < pointEnd; blockBegin += sc_BlockSize) {
+			auto const blockSize{std::min(sc_BlockSize, pointEnd - blockBegin)};
+
+			// Points after the first failure of the block are not worth evaluating.
+			std::atomic<size_t> failedIndex{blockSize};
+			std::exception_ptr pError{};
+			std::mutex errorMutex{};
+
+			auto const evalPoint = [&](Scope& scope, size_t i) {
+				if (i > failedIndex.load(std::memory_order_relaxed)) {
+					return;
+				}
+
+				try {
+					values[i] = scope.Eval(blockBegin + i);
+				} catch (ArCalcException const&) {
+					auto const lock{std::scoped_lock{errorMutex}};
+					if (i < failedIndex.load()) {
+						failedIndex = i;
+						pError = std::current_exception();
+					}
+				}
+			};
+
+			if (pPool && m_bParallel) {
+				pPool->ForEach(blockSize, sc_GrainSize, [this] { return Scope{*this}; }, evalPoint);
+			} else {
+				auto scope = Scope{*this};
+				for (auto const i : view::iota(size_t{}, blockSize)) {
+					evalPoint(scope, i);
+				}
+			}
+
+			if (pSink) {
+				for (auto const i : view::iota(size_t{}, failedIndex.load())) {
+					GetPoint(blockBegin + i, point);
+					pSink->OnSweepPoint(lineNumber, point, values[i]);
+				}
+			}
+
+			if (pError) {
+				std::rethrow_exception(pError);
+			}
+		}
+	}
+
+	size_t Sweep::GetPointCount() const {
+		return m_Axes.empty() ? 0U : std::transform_reduce(m_Axes.begin(), m_Axes.end(), size_t{1U},
+			std::multiplies<>{}, [](Axis const& axis) { return axis.Count; });
+	}
+
+	void Sweep::GetPoint(size_t index, std::span<double> values) const {
+		ARCALC_DA(values.size() == m_Axes.size(), "Sweep::GetPoint into [{}] values", values.size());
+		for (auto const i : view::iota(size_t{}, m_Axes.size()) | view::reverse) {
+			auto const& axis{m_Axes[i]};
+			values[i] = axis.First + axis.Step * static_cast<double>(index % axis.Count);
+			index /= axis.Count;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core.h"
+#include "IResultSink.h"
+#include "Util/FunctionManager.h"
+#include "Util/Lexer.h"
+
+namespace ArCalc {
+	class ThreadPool;
+
+	/// Calls a function with every point of a grid of values of its parameters (see _Sweep
+	/// in KeywordType.h). Points are numbered in row-major order: the last axis added
+	/// changes the fastest.
+	///
+	/// The function is prepared once. A body that only returns an expression is evaluated
+	/// in place, with the parameters bound straight to the values of the point; any other
+	/// body is called like it would be from an expression. Points are evaluated in blocks,
+	/// whose chunks are split between the threads of the pool, each with copies of the
+	/// functions, and every block is reported in order once it is done.
+	class Sweep {
+	public:
+		struct Axis {
+			std::string Name;
+			double First;
+			double Step;
+			size_t Count;
+		};
+
+	public:
+		Sweep(Sweep const&)            = delete;
+		Sweep(Sweep&&)                 = delete;
+		Sweep& operator=(Sweep const&) = delete;
+		Sweep& operator=(Sweep&&)      = delete;
+
+		// Throws if [funcName] can not be swept. [funMan] has to outlive the sweep.
+		Sweep(std::ostream& os, FunctionManager& funMan, std::string_view funcName);
+
+	public:
+		// Throws if [paramName] is not a parameter of the function, or was already added,
+		// or if [last] can not be reached from [first] in steps of [step].
+		void AddAxis(std::string_view paramName, double first, double last, double step);
+
+		// Same, with the number of values already worked out (e.g. from GetAxes).
+		void AddAxis(Axis const& axis);
+
+		// Throws if some parameter of the function was not added.
+		void ExpectAllParamsSwept() const;
+
+		// Reports every point to [pSink], if any. Throws like ExpectAllParamsSwept.
+		// The first point to fail is rethrown once the ones before it were reported.
+		void Run(IResultSink* pSink, size_t lineNumber, ThreadPool* pPool);
+
+		// Same, for [pointCount] points starting with the [firstPoint]th.
+		void Run(IResultSink* pSink, size_t lineNumber, ThreadPool* pPool, 
+			size_t firstPoint, size_t pointCount);
+
+		size_t GetPointCount() const;
+
+		// Fills [values] with the value of every axis at the [index]th point.
+		void GetPoint(size_t index, std::span<double> values) const;
+
+		std::span<Axis const> GetAxes() const {
+			return m_Axes;
+		}
+
+		std::string const& GetFuncName() const {
+			return m_FuncName;
+		}
+
+		// Points evaluated before reporting them, so the results need not all be kept.
+		constexpr static size_t sc_BlockSize{64U * 1024U};
+
+		// Chunks smaller than this do not make up for copying the functions.
+		constexpr static size_t sc_GrainSize{256U};
+
+	private:
+		class Scope;
+
+	private:
+		std::ostream* m_pOStream;
+		FunctionManager* m_pFunMan;
+		std::string m_FuncName;
+		std::vector<std::string> m_ParamNames{}; // In the order of the function.
+		std::vector<Axis> m_Axes{};
+		std::vector<size_t> m_ParamAxes{};       // Index of the axis of every parameter.
+
+		// Evaluated for every point, with the parameters as the only literals.
+		std::string m_ExprText{};
+		LexedExpr m_Expr{};
+
+		bool m_bParallel{};
+	};
+}
\ No newline at end of file
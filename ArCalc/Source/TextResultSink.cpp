@@ -0,0 +1,41 @@
+#include "TextResultSink.h"
+#include "Util/NumberFormatter.h"
+
+namespace ArCalc {
+	TextResultSink::TextResultSink(std::ostream& os) : m_pOStream{&os} {
+	}
+
+	void TextResultSink::OnValue(size_t, std::optional<double> value) {
+		if (value.has_value()) {
+			NumberFormatter::Write(*m_pOStream, *value);
+			m_pOStream->put('\n');
+		} else {
+			m_pOStream->write("None.\n", 6);
+		}
+	}
+
+	void TextResultSink::OnLiteralSet(size_t, std::string_view name, double value) {
+		m_pOStream->write(name.data(), static_cast<std::streamsize>(name.size())).write(" = ", 3);
+		NumberFormatter::Write(*m_pOStream, value);
+		m_pOStream->put('\n');
+	}
+
+	void TextResultSink::OnSweepPoint(size_t, std::span<double const> args, double value) {
+		for (auto const arg : args) {
+			NumberFormatter::Write(*m_pOStream, arg);
+			m_pOStream->put(' ');
+		}
+		NumberFormatter::Write(*m_pOStream, value);
+		m_pOStream->put('\n');
+	}
+
+	void TextResultSink::OnFunctionDefined(size_t, std::string_view) {
+	}
+
+	void TextResultSink::OnError(size_t, ArCalcException const&) {
+	}
+
+	void TextResultSink::SetOStream(std::ostream& toWhat) {
+		m_pOStream = &toWhat;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "IResultSink.h"
+
+namespace ArCalc {
+	/// Prints results as text, which is what parsers do unless given another sink.
+	/// Errors are left to whoever catches them.
+	class TextResultSink : public IResultSink {
+	public:
+		TextResultSink(std::ostream& os);
+
+	public:
+		void OnValue(size_t lineNumber, std::optional<double> value) override;
+		void OnLiteralSet(size_t lineNumber, std::string_view name, double value) override;
+		void OnSweepPoint(size_t lineNumber, std::span<double const> args, double value) override;
+		void OnFunctionDefined(size_t lineNumber, std::string_view name) override;
+		void OnError(size_t lineNumber, ArCalcException const& err) override;
+
+		void SetOStream(std::ostream& toWhat);
+
+	private:
+		std::ostream* m_pOStream;
+	};
+}
\ No newline at end of file
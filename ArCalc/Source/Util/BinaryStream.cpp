@@ -0,0 +1,91 @@
+#include "BinaryStream.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	BinaryWriter::BinaryWriter(std::string& buffer) : m_pBuffer{&buffer} {
+	}
+
+	void BinaryWriter::WriteU8(std::uint8_t value) {
+		m_pBuffer->push_back(static_cast<char>(value));
+	}
+
+	void BinaryWriter::WriteU32(std::uint32_t value) {
+		for (auto const i : view::iota(0U, 4U)) {
+			WriteU8(static_cast<std::uint8_t>(value >> (8U * i)));
+		}
+	}
+
+	void BinaryWriter::WriteU64(std::uint64_t value) {
+		for (auto const i : view::iota(0U, 8U)) {
+			WriteU8(static_cast<std::uint8_t>(value >> (8U * i)));
+		}
+	}
+
+	void BinaryWriter::WriteF64(double value) {
+		WriteU64(std::bit_cast<std::uint64_t>(value));
+	}
+
+	void BinaryWriter::WriteString(std::string_view str) {
+		WriteU32(static_cast<std::uint32_t>(str.size()));
+		WriteBytes(str);
+	}
+
+	void BinaryWriter::WriteBytes(std::string_view bytes) {
+		m_pBuffer->append(bytes);
+	}
+
+	BinaryReader::BinaryReader(std::string_view bytes) : m_Bytes{bytes} {
+	}
+
+	std::uint8_t BinaryReader::ReadU8() {
+		return static_cast<std::uint8_t>(ReadLittleEndian(1U));
+	}
+
+	std::uint32_t BinaryReader::ReadU32() {
+		return static_cast<std::uint32_t>(ReadLittleEndian(4U));
+	}
+
+	std::uint64_t BinaryReader::ReadU64() {
+		return ReadLittleEndian(8U);
+	}
+
+	double BinaryReader::ReadF64() {
+		return std::bit_cast<double>(ReadU64());
+	}
+
+	std::string_view BinaryReader::ReadString() {
+		return ReadBytes(ReadU32());
+	}
+
+	std::string_view BinaryReader::ReadBytes(size_t count) {
+		if (count > m_Bytes.size() - m_Pos) {
+			throw IOError{
+				"Unexpected end of binary data; needed [{}] bytes at offset [{}] but only [{}] are left",
+				count, m_Pos, m_Bytes.size() - m_Pos,
+			};
+		}
+
+		auto const res{m_Bytes.substr(m_Pos, count)};
+		m_Pos += count;
+		return res;
+	}
+
+	std::uint32_t BinaryReader::ReadCount(size_t minElementSize) {
+		auto const res{ReadU32()};
+		if (auto const left{m_Bytes.size() - m_Pos}; res > left / minElementSize) {
+			throw IOError{
+				"Corrupted binary data; [{}] elements of at least [{}] bytes at offset [{}] but only [{}] bytes are left",
+				res, minElementSize, m_Pos, left,
+			};
+		}
+		return res;
+	}
+
+	std::uint64_t BinaryReader::ReadLittleEndian(size_t byteCount) {
+		auto res = std::uint64_t{};
+		for (auto const bytes{ReadBytes(byteCount)}; auto const i : view::iota(0U, byteCount)) {
+			res |= std::uint64_t{static_cast<unsigned char>(bytes[i])} << (8U * i);
+		}
+		return res;
+	}
+}
\ No newline at end of file
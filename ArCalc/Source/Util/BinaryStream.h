@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Appends fixed-width little-endian values and length-prefixed strings to a buffer,
+	/// so the result reads back the same on any machine.
+	class BinaryWriter {
+	public:
+		BinaryWriter(std::string& buffer);
+
+	public:
+		void WriteU8(std::uint8_t value);
+		void WriteU32(std::uint32_t value);
+		void WriteU64(std::uint64_t value);
+		void WriteF64(double value); // Raw IEEE bits, so it round-trips exactly.
+		void WriteString(std::string_view str);
+		void WriteBytes(std::string_view bytes); // No length prefix.
+
+	private:
+		std::string* m_pBuffer;
+	};
+
+	/// Reads back what BinaryWriter wrote. Strings are views into the source bytes, which
+	/// must outlive them. Reading past the end throws an IOError.
+	class BinaryReader {
+	public:
+		BinaryReader(std::string_view bytes);
+
+	public:
+		std::uint8_t ReadU8();
+		std::uint32_t ReadU32();
+		std::uint64_t ReadU64();
+		double ReadF64();
+		std::string_view ReadString();
+		std::string_view ReadBytes(size_t count);
+
+		// Reads the number of elements that follow, each taking at least [minElementSize] 
+		// bytes, so a corrupted count throws before anything is allocated for them.
+		std::uint32_t ReadCount(size_t minElementSize);
+
+		constexpr bool IsAtEnd() const {
+			return m_Pos == m_Bytes.size();
+		}
+
+		constexpr size_t GetPosition() const {
+			return m_Pos;
+		}
+
+	private:
+		std::uint64_t ReadLittleEndian(size_t byteCount);
+
+	private:
+		std::string_view m_Bytes;
+		size_t m_Pos{};
+	};
+}
\ No newline at end of file
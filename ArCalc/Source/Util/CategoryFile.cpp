@@ -0,0 +1,318 @@
+#include "CategoryFile.h"
+#include "Exception/ArCalcException.h"
+#include "IO.h"
+
+namespace ArCalc {
+	fs::path CategoryFile::GetPath(std::string_view categoryName, CategoryFormat format) {
+		auto fileName = std::string{categoryName};
+		switch (format) {
+		case CategoryFormat::Binary: fileName.append(".arcat"); break;
+		case CategoryFormat::Text:   fileName.append(".txt");   break;
+		default: ARCALC_UNREACHABLE_CODE();
+		}
+
+		return IO::GetSerializationPath() / fileName;
+	}
+
+	fs::path CategoryFile::GetSnapshotPath(std::string_view snapshotName) {
+		return IO::GetSerializationPath() / (std::string{snapshotName} + ".arsnap");
+	}
+
+	bool CategoryFile::AppendBinary(std::string_view categoryName, std::string_view name, char tag,
+		std::string_view record, std::vector<std::string> dependencies) 
+	{
+		auto const filePath{GetPath(categoryName, CategoryFormat::Binary)};
+		fs::create_directory(filePath.parent_path());
+		auto const lock{LockForWriting(filePath)};
+
+		// Nothing already in the file is touched, the old index and footer stay where they are 
+		// as dead space until the file is compacted. Only the last footer is ever read.
+		auto const oldSize{fs::exists(filePath) ? fs::file_size(filePath) : std::uintmax_t{}};
+		auto const bNew{oldSize == 0U};
+		auto index{bNew ? Index{} : ReadIndex(filePath)};
+		auto const recordsEnd{bNew ? std::uint64_t{sc_HeaderSize} : std::uint64_t{oldSize}};
+
+		std::string bytes{};
+		BinaryWriter out{bytes};
+		if (bNew) {
+			out.WriteBytes(sc_Magic);
+			out.WriteU32(sc_Version);
+		}
+		out.WriteBytes(record);
+
+		// Saving the same name again makes it refer to the newest record.
+		std::erase_if(index, [&](IndexEntry const& entry) { return entry.Name == name; });
+		index.push_back({
+			.Name{std::string{name}},
+			.Tag{tag},
+			.Offset{recordsEnd},
+			.Size{static_cast<std::uint32_t>(record.size())},
+			.Dependencies{std::move(dependencies)},
+		});
+
+		auto const indexOffset{recordsEnd + record.size()};
+		WriteIndex(out, index);
+		out.WriteU64(indexOffset);
+
+		/* Append */ {
+			std::ofstream file{filePath, std::ios::binary | std::ios::app};
+			if (!file.is_open()) {
+				throw IOError{"Could not open category file [{}] for writing", filePath.string()};
+			} else if (!file.write(bytes.data(), bytes.size()).flush()) {
+				// A partial append would hide the last whole footer, so it is cut off again.
+				file.close();
+				auto ec = std::error_code{};
+				fs::resize_file(filePath, oldSize, ec);
+				throw IOError{"Could not write to category file [{}]", filePath.string()};
+			}
+		}
+
+		auto const liveSize{std::transform_reduce(index.begin(), index.end(), std::uint64_t{}, 
+			std::plus{}, [](IndexEntry const& entry) { return std::uint64_t{entry.Size}; })};
+		auto const staleSize{indexOffset - sc_HeaderSize - liveSize};
+		return staleSize > liveSize && fs::file_size(filePath) >= sc_AutoCompactMinSize;
+	}
+
+	std::vector<std::string_view> CategoryFile::SplitText(std::string_view text, size_t maxChunkCount) {
+		auto const chunkCount{std::clamp<size_t>(text.size() / sc_MinTextChunkSize, 1U, maxChunkCount)};
+
+		// Records begin with their tag at the start of a line, function bodies are indented.
+		auto const nextRecordBegin = [&](size_t from) {
+			for (auto pos{text.find('\n', from)}; pos != text.npos; pos = text.find('\n', pos + 1U)) {
+				if (auto const c{pos + 1U < text.size() ? text[pos + 1U] : '\0'}; 
+					c == sc_LiteralTag || c == sc_FunctionTag) 
+				{
+					return pos + 1U;
+				}
+			}
+			return text.size();
+		};
+
+		std::vector<std::string_view> res{};
+		res.reserve(chunkCount);
+		for (size_t begin{}; begin < text.size();) {
+			auto const target{begin + text.size() / chunkCount};
+			auto const end{res.size() + 1U == chunkCount ? text.size() : nextRecordBegin(target)};
+			res.push_back(text.substr(begin, end - begin));
+			begin = end;
+		}
+
+		return res;
+	}
+
+	std::uintmax_t CategoryFile::Compact(fs::path const& filePath) {
+		auto const lock{LockForWriting(filePath)};
+		if (auto const stubCount{GetUnloadedStubCount(filePath)}; stubCount != 0U) {
+			throw IOError{
+				"Can not compact category file [{}], {} functions loaded from it in other sessions "
+				"were not read yet",
+				filePath.string(), stubCount,
+			};
+		}
+
+		auto const oldBytes{IO::FileToBytes(filePath)};
+		if (oldBytes.empty()) {
+			return 0U;
+		}
+
+		auto index{ReadIndexFromBytes(oldBytes)};
+		std::string records{};
+
+		// Records are kept in the order they were last saved in.
+		range::sort(index, {}, &IndexEntry::Offset);
+		for (auto& entry : index) {
+			if (entry.Offset + entry.Size > oldBytes.size()) {
+				throw IOError{"Category file [{}] is shorter than its index says", filePath.string()};
+			}
+
+			auto const record{std::string_view{oldBytes}.substr(entry.Offset, entry.Size)};
+			entry.Offset = records.size();
+			records.append(record);
+		}
+
+		WriteWhole(filePath, std::move(index), records);
+		return oldBytes.size() - fs::file_size(filePath);
+	}
+
+	std::shared_ptr<fs::path const> CategoryFile::SharePath(fs::path const& filePath) {
+		auto const lock{std::scoped_lock{s_SharedPathsMutex}};
+		std::erase_if(s_SharedPaths, [](auto const& entry) { return entry.second.expired(); });
+
+		auto& pWeak{s_SharedPaths[filePath]};
+		auto res{pWeak.lock()};
+		if (!res) {
+			res = std::make_shared<fs::path const>(filePath);
+			pWeak = res;
+		}
+		return res;
+	}
+
+	size_t CategoryFile::GetUnloadedStubCount(fs::path const& filePath) {
+		auto const lock{std::scoped_lock{s_SharedPathsMutex}};
+		auto const it{s_SharedPaths.find(filePath)};
+		return it == s_SharedPaths.end() ? 0U : static_cast<size_t>(it->second.use_count());
+	}
+
+	void CategoryFile::WriteWhole(fs::path const& filePath, Index index, std::string_view records) {
+		std::string bytes{};
+		bytes.reserve(sc_HeaderSize + records.size() + sc_FooterSize);
+
+		BinaryWriter out{bytes};
+		out.WriteBytes(sc_Magic);
+		out.WriteU32(sc_Version);
+		out.WriteBytes(records);
+
+		for (auto& entry : index) {
+			entry.Offset += sc_HeaderSize;
+		}
+
+		auto const indexOffset{static_cast<std::uint64_t>(sc_HeaderSize + records.size())};
+		WriteIndex(out, index);
+		out.WriteU64(indexOffset);
+
+		fs::create_directory(filePath.parent_path());
+		IO::ReplaceFile(filePath, bytes);
+	}
+
+	CategoryFile::Index CategoryFile::ReadIndexFromBytes(std::string_view fileBytes) {
+		if (fileBytes.empty()) {
+			return {};
+		}
+
+		BinaryReader in{fileBytes};
+		ReadHeader(in);
+
+		auto const indexOffset{ReadIndexOffset(
+			fileBytes.substr(fileBytes.size() - sc_FooterSize), fileBytes.size())};
+		return ParseIndex(fileBytes.substr(indexOffset, fileBytes.size() - sc_FooterSize - indexOffset));
+	}
+
+	CategoryFile::Index CategoryFile::ReadIndex(fs::path const& filePath) {
+		auto file{OpenForReading(filePath)};
+		auto const fileSize{fs::file_size(filePath)};
+		if (fileSize == 0U) {
+			return {};
+		}
+
+		auto const header{IO::Read(file, sc_HeaderSize)};
+		BinaryReader headerIn{header};
+		ReadHeader(headerIn);
+
+		file.seekg(-static_cast<std::streamoff>(sc_FooterSize), std::ios::end);
+		auto const indexOffset{ReadIndexOffset(IO::Read(file, sc_FooterSize), fileSize)};
+
+		file.seekg(static_cast<std::streamoff>(indexOffset));
+		return ParseIndex(IO::Read(file, fileSize - sc_FooterSize - indexOffset));
+	}
+
+	std::vector<std::string> CategoryFile::ReadRecords(fs::path const& filePath, 
+		std::span<IndexEntry const* const> entries) 
+	{
+		auto file{OpenForReading(filePath)};
+
+		std::vector<std::string> res{};
+		res.reserve(entries.size());
+		for (auto const pEntry : entries) {
+			res.push_back(ReadRecordAt(file, filePath, pEntry->Offset, pEntry->Size));
+		}
+
+		return res;
+	}
+
+	std::string CategoryFile::ReadRecord(fs::path const& filePath, std::uint64_t offset, 
+		std::uint32_t size) 
+	{
+		auto file{OpenForReading(filePath)};
+		return ReadRecordAt(file, filePath, offset, size);
+	}
+
+	std::ifstream CategoryFile::OpenForReading(fs::path const& filePath) {
+		std::ifstream file{filePath, std::ios::binary};
+		if (!file.is_open()) {
+			throw IOError{"Could not open category file [{}]", filePath.string()};
+		}
+
+		return file;
+	}
+
+	std::string CategoryFile::ReadRecordAt(std::ifstream& file, fs::path const& filePath, 
+		std::uint64_t offset, std::uint32_t size) 
+	{
+		file.seekg(static_cast<std::streamoff>(offset));
+		auto res{IO::Read(file, size)};
+		if (res.size() != size) {
+			throw IOError{"Category file [{}] is shorter than its index says", filePath.string()};
+		}
+
+		return res;
+	}
+
+	void CategoryFile::ReadHeader(BinaryReader& in) {
+		if (in.ReadBytes(sc_Magic.size()) != sc_Magic) {
+			throw IOError{"Category file is corrupted or not a category file"};
+		} else if (auto const version{in.ReadU32()}; version != sc_Version) {
+			throw IOError{
+				"Category file has version [{}], but only version [{}] is supported", 
+				version, sc_Version,
+			};
+		}
+	}
+
+	std::uint64_t CategoryFile::ReadIndexOffset(std::string_view footer, size_t fileSize) {
+		BinaryReader in{footer};
+		auto const res{in.ReadU64()};
+		if (res < sc_HeaderSize || res > fileSize - sc_FooterSize) {
+			throw IOError{"Category file is corrupted; its index offset [{}] is out of bounds", res};
+		}
+
+		return res;
+	}
+
+	CategoryFile::Index CategoryFile::ParseIndex(std::string_view bytes) {
+		BinaryReader in{bytes};
+
+		auto res = Index{};
+		res.resize(in.ReadCount(21U)); // Name size, tag, offset, size and dependency count.
+		for (auto& entry : res) {
+			entry.Name   = in.ReadString();
+			entry.Tag    = static_cast<char>(in.ReadU8());
+			entry.Offset = in.ReadU64();
+			entry.Size   = in.ReadU32();
+
+			entry.Dependencies.resize(in.ReadCount(4U));
+			for (auto& dependency : entry.Dependencies) {
+				dependency = in.ReadString();
+			}
+		}
+
+		return res;
+	}
+
+	void CategoryFile::WriteIndex(BinaryWriter& out, Index const& index) {
+		out.WriteU32(static_cast<std::uint32_t>(index.size()));
+		for (auto const& entry : index) {
+			out.WriteString(entry.Name);
+			out.WriteU8(static_cast<std::uint8_t>(entry.Tag));
+			out.WriteU64(entry.Offset);
+			out.WriteU32(entry.Size);
+
+			out.WriteU32(static_cast<std::uint32_t>(entry.Dependencies.size()));
+			for (auto const& dependency : entry.Dependencies) {
+				out.WriteString(dependency);
+			}
+		}
+	}
+
+	std::unique_lock<std::mutex> CategoryFile::LockForWriting(fs::path const& filePath) {
+		auto const pMutex = [&] {
+			auto const lock{std::scoped_lock{s_WriteMutexesMutex}};
+			auto& pRes{s_WriteMutexes[filePath]};
+			if (!pRes) {
+				pRes = std::make_unique<std::mutex>();
+			}
+			return pRes.get();
+		}(/*)(*/);
+
+		return std::unique_lock{*pMutex};
+	}
+}
\ No newline at end of file
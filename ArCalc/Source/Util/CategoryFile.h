@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Core.h"
+#include "BinaryStream.h"
+
+namespace ArCalc {
+	enum class CategoryFormat : size_t {
+		Binary = 0, // What _Save writes by default.
+		Text,       // Human readable export, also what older versions used to write.
+	};
+
+	/// Layout of the files _Save appends to and _Load reads.
+	/// 
+	/// Binary categories are laid out as follows:
+	///   [sc_Magic] [u32 sc_Version]
+	///   [record]...  a tag byte (sc_LiteralTag or sc_FunctionTag), then whatever 
+	///                SerializeBinary of the matching manager wrote.
+	///   [index]      [u32 entry count] { [name] [tag] [u64 offset] [u32 size] 
+	///                [u32 dependency count] { [dependency name] }... }...
+	///   [u64 offset of the index]
+	/// 
+	/// The index lets a single symbol (and the functions it calls) be loaded without 
+	/// reading the rest of the file, and functions be read only when first called. 
+	/// Every save appends the new record, then a whole new index and footer, after the old 
+	/// footer, so a save that fails half-way never touches what the last footer refers to.
+	/// 
+	/// Records that the index no longer refers to, and the old indices, are dropped by 
+	/// Compact, which should be called once AppendBinary says they take up most of a large 
+	/// enough file.
+	/// 
+	/// Appends and compactions of the same file are serialized across sessions (see 
+	/// LockForWriting), so a save never writes an index missing what another one just saved.
+	/// 
+	/// Text categories are the same records in the old text format, with no header or index.
+	class CategoryFile {
+	public:
+		struct IndexEntry {
+			std::string Name;
+			char Tag;
+			std::uint64_t Offset; // Of the tag, from the start of the file.
+			std::uint32_t Size;   // Including the tag.
+			std::vector<std::string> Dependencies; // Functions called by this one.
+		};
+
+		using Index = std::vector<IndexEntry>;
+
+	public:
+		CategoryFile() = delete;
+
+	public:
+		constexpr static std::string_view sc_Magic{"ArCalcCategory"};
+		constexpr static std::uint32_t sc_Version{2U};
+		constexpr static size_t sc_HeaderSize{sc_Magic.size() + sizeof(std::uint32_t)};
+		constexpr static size_t sc_FooterSize{sizeof(std::uint64_t)};
+
+		// Text categories are only split between threads in chunks of at least this size.
+		constexpr static size_t sc_MinTextChunkSize{64U * 1024U};
+
+		// Files smaller than this are never compacted automatically.
+		constexpr static std::uintmax_t sc_AutoCompactMinSize{64U * 1024U};
+
+		constexpr static char sc_LiteralTag {'C'};
+		constexpr static char sc_FunctionTag{'F'};
+
+	public:
+		static fs::path GetPath(std::string_view categoryName, CategoryFormat format);
+
+		// Snapshots are binary categories that are written whole, and mapped by _Restore.
+		static fs::path GetSnapshotPath(std::string_view snapshotName);
+
+		// Appends an already serialized record (tag included), and updates the index so 
+		// [name] refers to it from now on. Returns whether the file is worth compacting.
+		[[nodiscard]] static bool AppendBinary(std::string_view categoryName, std::string_view name, char tag,
+			std::string_view record, std::vector<std::string> dependencies = {});
+
+		static Index ReadIndex(fs::path const& filePath);
+
+		// [entries] must come from the index of the same file. Returns the records in the 
+		// same order, reading only the bytes they occupy.
+		static std::vector<std::string> ReadRecords(fs::path const& filePath, 
+			std::span<IndexEntry const* const> entries);
+		static std::string ReadRecord(fs::path const& filePath, std::uint64_t offset, std::uint32_t size);
+
+		// Splits a text category into at most [maxChunkCount] chunks of whole records, in 
+		// file order.
+		static std::vector<std::string_view> SplitText(std::string_view text, size_t maxChunkCount);
+
+		// Rewrites the file with only the records the index refers to, returns the number of 
+		// bytes that were freed. Throws IOError if some stub of the file is not loaded yet
+		// (see GetUnloadedStubCount), as compacting moves the records it points to.
+		static std::uintmax_t Compact(fs::path const& filePath);
+
+		// The same path for every stub of a function in [filePath], in every session, which 
+		// is only held until the stub is loaded.
+		static std::shared_ptr<fs::path const> SharePath(fs::path const& filePath);
+
+		// Stubs of functions in [filePath] that were not loaded yet, in any session.
+		static size_t GetUnloadedStubCount(fs::path const& filePath);
+
+		// Replaces the file with [records], where the offsets in [index] are relative to the 
+		// start of [records].
+		static void WriteWhole(fs::path const& filePath, Index index, std::string_view records);
+
+		// Same as ReadIndex, on the contents of a whole file (which may be mapped).
+		static Index ReadIndexFromBytes(std::string_view fileBytes);
+
+	private:
+		static std::ifstream OpenForReading(fs::path const& filePath);
+		static std::string ReadRecordAt(std::ifstream& file, fs::path const& filePath, 
+			std::uint64_t offset, std::uint32_t size);
+		static void ReadHeader(BinaryReader& in);
+		static std::uint64_t ReadIndexOffset(std::string_view footer, size_t fileSize);
+		static Index ParseIndex(std::string_view bytes);
+		static void WriteIndex(BinaryWriter& out, Index const& index);
+
+		// Held from reading the index of [filePath] until the one replacing it is written.
+		static std::unique_lock<std::mutex> LockForWriting(fs::path const& filePath);
+
+	private:
+		inline static std::mutex s_SharedPathsMutex{};
+		inline static std::map<fs::path, std::weak_ptr<fs::path const>> s_SharedPaths{};
+
+		// One per file ever written, which there are only a handful of.
+		inline static std::mutex s_WriteMutexesMutex{};
+		inline static std::map<fs::path, std::unique_ptr<std::mutex>> s_WriteMutexes{};
+	};
+}
\ No newline at end of file
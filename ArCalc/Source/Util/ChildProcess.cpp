@@ -0,0 +1,162 @@
+#include "ChildProcess.h"
+#include "Exception/ArCalcException.h"
+
+#ifdef _WIN32
+#include "ArWin.h"
+#else // ^^^^ Windows, vvvv POSIX
+#include <spawn.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace ArCalc {
+	namespace Secret {
+#ifdef _WIN32
+		// Quotes [arg] the way CommandLineToArgvW splits it back.
+		void AppendQuotedArg(std::wstring& commandLine, std::wstring_view arg) {
+			commandLine += L'"';
+			for (size_t i{}; i <= arg.size(); ++i) {
+				auto backslashCount{size_t{}};
+				for (; i < arg.size() && arg[i] == L'\\'; ++i) {
+					++backslashCount;
+				}
+
+				if (i == arg.size()) { // Backslashes before the closing quote are doubled.
+					commandLine.append(backslashCount * 2U, L'\\');
+				} else if (arg[i] == L'"') {
+					commandLine.append(backslashCount * 2U + 1U, L'\\').push_back(L'"');
+				} else {
+					commandLine.append(backslashCount, L'\\').push_back(arg[i]);
+				}
+			}
+			commandLine += L"\" ";
+		}
+#endif
+	}
+
+#ifdef _WIN32
+	ChildProcess::ChildProcess(fs::path const& exePath, std::span<std::string const> args) {
+		auto commandLine = std::wstring{};
+		Secret::AppendQuotedArg(commandLine, exePath.wstring());
+		for (auto const& arg : args) {
+			Secret::AppendQuotedArg(commandLine, fs::path{arg}.wstring());
+		}
+
+		auto startupInfo = STARTUPINFOW{.cb = sizeof(STARTUPINFOW)};
+		auto processInfo = PROCESS_INFORMATION{};
+		if (!CreateProcessW(exePath.c_str(), commandLine.data(), nullptr, nullptr, FALSE, 0,
+			nullptr, nullptr, &startupInfo, &processInfo))
+		{
+			throw IOError{"Could not start [{}]", exePath.string()};
+		}
+
+		CloseHandle(processInfo.hThread);
+		m_Handle = processInfo.hProcess;
+	}
+
+	std::optional<int> ChildProcess::Wait(std::chrono::milliseconds timeout) {
+		if (!m_ExitCode && WaitForSingleObject(m_Handle, static_cast<DWORD>(timeout.count())) == WAIT_OBJECT_0) {
+			auto exitCode = DWORD{};
+			GetExitCodeProcess(m_Handle, &exitCode);
+			m_ExitCode = static_cast<int>(exitCode);
+		}
+		return m_ExitCode;
+	}
+
+	void ChildProcess::Kill() {
+		if (m_Handle && !m_ExitCode) {
+			TerminateProcess(m_Handle, 1U);
+		}
+	}
+
+	void ChildProcess::Close() {
+		if (m_Handle) {
+			Kill();
+			Wait(std::chrono::milliseconds{INFINITE});
+			CloseHandle(std::exchange(m_Handle, nullptr));
+		}
+	}
+
+	fs::path ChildProcess::GetCurrentExecutablePath() {
+		auto buffer = std::wstring(MAX_PATH, L'\0');
+		while (true) {
+			auto const length{GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()))};
+			if (length == 0U) {
+				throw IOError{"Could not find the path of the executable"};
+			} else if (length < buffer.size()) {
+				buffer.resize(length);
+				return buffer;
+			}
+			buffer.resize(buffer.size() * 2U);
+		}
+	}
+#else // ^^^^ Windows, vvvv POSIX
+	ChildProcess::ChildProcess(fs::path const& exePath, std::span<std::string const> args) {
+		auto const exeString{exePath.string()};
+		auto argv = std::vector<char*>{const_cast<char*>(exeString.c_str())};
+		for (auto const& arg : args) {
+			argv.push_back(const_cast<char*>(arg.c_str()));
+		}
+		argv.push_back(nullptr);
+
+		auto pid = pid_t{};
+		if (posix_spawn(&pid, exeString.c_str(), nullptr, nullptr, argv.data(), environ) != 0) {
+			throw IOError{"Could not start [{}]", exeString};
+		}
+		m_Handle = pid;
+	}
+
+	std::optional<int> ChildProcess::Wait(std::chrono::milliseconds timeout) {
+		// There is no waiting on a pid with a timeout, so it is polled instead.
+		constexpr auto sc_PollInterval{std::chrono::milliseconds{5}};
+		auto const deadline{std::chrono::steady_clock::now() + timeout};
+		while (!m_ExitCode) {
+			auto status = int{};
+			if (waitpid(m_Handle, &status, WNOHANG) == m_Handle) {
+				m_ExitCode = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+			} else if (std::chrono::steady_clock::now() >= deadline) {
+				break;
+			} else {
+				std::this_thread::sleep_for(sc_PollInterval);
+			}
+		}
+		return m_ExitCode;
+	}
+
+	void ChildProcess::Kill() {
+		if (m_Handle && !m_ExitCode) {
+			kill(m_Handle, SIGKILL);
+		}
+	}
+
+	void ChildProcess::Close() {
+		if (m_Handle) {
+			Kill();
+			Wait(std::chrono::hours{24});
+			m_Handle = {};
+		}
+	}
+
+	fs::path ChildProcess::GetCurrentExecutablePath() {
+		return fs::read_symlink("/proc/self/exe");
+	}
+#endif
+
+	ChildProcess::ChildProcess(ChildProcess&& other) noexcept
+		: m_Handle{std::exchange(other.m_Handle, {})}, m_ExitCode{other.m_ExitCode} {}
+
+	ChildProcess& ChildProcess::operator=(ChildProcess&& other) noexcept {
+		if (this != &other) {
+			Close();
+			m_Handle = std::exchange(other.m_Handle, {});
+			m_ExitCode = other.m_ExitCode;
+		}
+		return *this;
+	}
+
+	ChildProcess::~ChildProcess() {
+		Close();
+	}
+}
\ No newline at end of file
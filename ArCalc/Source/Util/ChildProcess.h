@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// A process started from an executable with a list of arguments, sharing the standard
+	/// streams of this one. It is killed if it is still running when the object goes away.
+	class ChildProcess {
+	public:
+#ifdef _WIN32
+		using Handle = void*;
+#else // ^^^^ Windows, vvvv POSIX
+		using Handle = int; // The pid.
+#endif
+
+	public:
+		ChildProcess(ChildProcess const&)            = delete;
+		ChildProcess& operator=(ChildProcess const&) = delete;
+
+		// Throws IOError if [exePath] could not be started.
+		ChildProcess(fs::path const& exePath, std::span<std::string const> args);
+		ChildProcess(ChildProcess&& other) noexcept;
+		ChildProcess& operator=(ChildProcess&& other) noexcept;
+		~ChildProcess();
+
+	public:
+		// Returns the exit code once the process exited, or nullopt if it is still running
+		// after [timeout]. Processes killed by a signal exit with 128 + the signal, like in
+		// shells. The exit code is returned again by later calls.
+		std::optional<int> Wait(std::chrono::milliseconds timeout);
+
+		void Kill();
+
+		// Of the executable this process was started from.
+		static fs::path GetCurrentExecutablePath();
+
+	private:
+		void Close();
+
+	private:
+		Handle m_Handle{};
+		std::optional<int> m_ExitCode{};
+	};
+}
\ No newline at end of file
@@ -1,10 +1,60 @@
 #include "FunctionManager.h"
 #include "Util.h"
+#include "Str.h"
 #include "IO.h"
+#include "CategoryFile.h"
+#include "MappedFile.h"
+#include "Keyword.h"
 #include "Exception/ArCalcException.h"
 #include "../Parser.h"
 
 namespace ArCalc {
+	namespace Secret {
+		// Whether [codeLine] uses a keyword whose effects outlive the call (see IsPure).
+		bool ReachesOutside(std::string_view codeLine) {
+			using KT = KeywordType;
+			constexpr std::array sc_Keywords{
+				KT::List, KT::Save, KT::Load, KT::Compact, KT::Snapshot, KT::Restore,
+			};
+
+			while (!codeLine.empty()) {
+				auto const identBegin{range::find_if(codeLine, Str::IsIdentChar)};
+				auto const identEnd{std::find_if_not(identBegin, codeLine.end(), Str::IsIdentChar)};
+				auto const keyword{Keyword::FromString(std::string_view{identBegin, identEnd})};
+				codeLine = std::string_view{identEnd, codeLine.end()};
+
+				if (keyword.has_value() && range::find(sc_Keywords, *keyword) != sc_Keywords.end()) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Runs the body of [func] in a parser of its own, with [paramMap] as its only literals.
+		std::optional<double> RunBody(FunctionManager const& funMan, std::ostream& os, 
+			FuncData const& func, LiteralManager::LiteralMap const& paramMap) 
+		{
+			if (func.CodeLines.empty()) { // Recursive call while validating, just return anything.
+				return 0.0;
+			}
+
+			auto subParser = Parser{os, funMan, paramMap};
+			if (subParser.IsOutputEnabled()) {
+				subParser.ToggleOutput();
+			}
+
+			for (auto const& codeLine : func.CodeLines) {
+				subParser.ParseLine(codeLine);
+				if (subParser.IsCurrentStatementReturning()) {
+					return subParser.GetReturnValue(func.ReturnType);
+				}
+			}
+
+			ARCALC_UNREACHABLE_CODE();
+			return {};
+		}
+	}
+
 	std::ostream& operator<<(std::ostream& os, FuncReturnType retype) {
 		switch (retype) {
 		using enum FuncReturnType;
@@ -77,7 +127,11 @@ namespace ArCalc {
 	}
 
 	bool FunctionManager::IsDefined(std::string_view name) const {
-		return m_FuncMap.contains(std::string{name});
+		return m_FuncMap.contains(name) || m_StubMap.contains(name);
+	}
+
+	bool FunctionManager::IsLoaded(std::string_view name) const {
+		return m_FuncMap.contains(name);
 	}
 
 	void FunctionManager::BeginDefination(std::string_view funcName, size_t lineNumber) {
@@ -108,10 +162,11 @@ namespace ArCalc {
 	}
 
 	void FunctionManager::TerminateAddingParams() {
-		ARCALC_DA(!m_FuncMap.contains(std::string{m_CurrFuncName}),
+		ARCALC_DA(!m_FuncMap.contains(m_CurrFuncName),
 			"Multiple calls to FunctionManager::TerminateAddingParams");
 		// Temporarily add it to the map to allow for recursive functions.
 		m_FuncMap.emplace(m_CurrFuncName, m_CurrFuncData);
+		m_Purity.clear();
 	}
 
 	void FunctionManager::AddCodeLine(std::string_view codeLine) {
@@ -159,6 +214,7 @@ namespace ArCalc {
 			throw ParseError{"Adding an empty function"};
 		}
 		m_FuncMap.insert_or_assign(std::exchange(m_CurrFuncName, ""), std::exchange(m_CurrFuncData, {}));
+		m_Purity.clear();
 	}
 
 	void FunctionManager::ResetCurrFunc() {
@@ -166,6 +222,7 @@ namespace ArCalc {
 		// are now allowed.
 		if (m_FuncMap.contains(m_CurrFuncName)) {
 			m_FuncMap.erase(m_CurrFuncName);
+			m_Purity.clear();
 		}
 		m_CurrFuncName = {};
 		m_CurrFuncData = {};
@@ -181,6 +238,25 @@ namespace ArCalc {
 
 	void FunctionManager::CopyMapFrom(FunctionManager const& what) {
 		m_FuncMap = what.m_FuncMap;
+		m_StubMap = what.m_StubMap;
+		m_Purity  = what.m_Purity;
+	}
+
+	void FunctionManager::MergeFrom(FunctionManager&& other) {
+		for (auto& [name, func] : other.m_FuncMap) {
+			m_StubMap.erase(name);
+			m_FuncMap.insert_or_assign(name, std::move(func));
+		}
+
+		for (auto& [name, pStub] : other.m_StubMap) {
+			m_FuncMap.erase(name);
+			m_StubMap.insert_or_assign(name, std::move(pStub));
+		}
+
+		other.m_FuncMap.clear();
+		other.m_StubMap.clear();
+		other.m_Purity.clear();
+		m_Purity.clear();
 	}
 
 	void FunctionManager::RedoEval(Parser& par) {
@@ -193,6 +269,8 @@ namespace ArCalc {
 	void FunctionManager::SubReset() {
 		ResetCurrFunc();
 		m_FuncMap.clear(); 
+		m_StubMap.clear();
+		m_Purity.clear();
 	}
 
 	void FunctionManager::AddParamImpl(std::string_view paramName, bool bParameterPack, 
@@ -231,18 +309,144 @@ namespace ArCalc {
 	}
 
 	FuncData& FunctionManager::Get(std::string_view funcName) {
-		ARCALC_DA(IsDefined(funcName), "FunctionManager::Get on invalid function [{}]", funcName);
-		return m_FuncMap.at(std::string{funcName});
+		if (auto const it{m_FuncMap.find(funcName)}; it != m_FuncMap.end()) {
+			return it->second;
+		}
+
+		auto const stubIt{m_StubMap.find(funcName)};
+		ARCALC_DA(stubIt != m_StubMap.end(), "FunctionManager::Get on invalid function [{}]", funcName);
+		return LoadStub(stubIt);
+	}
+
+	FuncData& FunctionManager::LoadStub(StubMap::iterator stubIt) {
+		auto& stub{*stubIt->second};
+		if (!stub.Loaded.has_value()) { // Not loaded by any other copy of this manager either.
+			auto const& filePath{stub.pSnapshot ? stub.pSnapshot->GetPath() : *stub.pCategoryPath};
+			auto const corrupted = [&] {
+				return IOError{
+					"Category file [{}] was modified since function [{}] got loaded from it",
+					filePath.string(), stubIt->first,
+				};
+			};
+
+			// Snapshot records are read in place, from the pages shared with other processes.
+			auto fileRecord = std::string{};
+			auto const record = [&] {
+				if (!stub.pSnapshot) {
+					fileRecord = CategoryFile::ReadRecord(filePath, stub.Offset, stub.Size);
+					return std::string_view{fileRecord};
+				} 
+				
+				auto const bytes{stub.pSnapshot->GetBytes()};
+				if (stub.Offset + stub.Size > bytes.size()) {
+					throw corrupted();
+				}
+				return bytes.substr(stub.Offset, stub.Size);
+			}(/*)(*/);
+
+			BinaryReader in{record};
+			auto const tag{static_cast<char>(in.ReadU8())};
+
+			auto [funcName, func] {tag == CategoryFile::sc_FunctionTag 
+				? ReadBinaryFunc(in) : std::pair<std::string, FuncData>{}};
+			if (funcName != stubIt->first) {
+				throw corrupted();
+			}
+
+			stub.Loaded = std::move(func);
+			stub.pCategoryPath.reset(); // So the category can be compacted (see CategoryFile::SharePath).
+		}
+
+		auto& res{m_FuncMap.insert_or_assign(stubIt->first, *stub.Loaded).first->second};
+		m_StubMap.erase(stubIt);
+		return res;
+	}
+
+	std::vector<std::string> FunctionManager::GetCallees(std::string_view funcName) const {
+		std::vector<std::string> res{};
+		for (std::string_view line : Get(funcName).CodeLines) {
+			while (!line.empty()) {
+				auto const identBegin{range::find_if(line, Str::IsIdentChar)};
+				auto const identEnd{std::find_if_not(identBegin, line.end(), Str::IsIdentChar)};
+				auto const ident{std::string_view{identBegin, identEnd}};
+				line = std::string_view{identEnd, line.end()};
+
+				// Only whole identifiers count; a digit run is (part of) a number literal.
+				if (ident.empty() || Str::IsDigit(ident.front()) || ident == funcName
+					|| !IsDefined(ident) || range::find(res, ident) != res.end())
+				{
+					continue;
+				}
+
+				res.emplace_back(ident);
+			}
+		}
+
+		return res;
+	}
+
+	std::vector<std::string> FunctionManager::GetReachable(std::string_view funcName) {
+		auto res = std::vector<std::string>{std::string{funcName}};
+		for (size_t i{}; i < res.size(); ++i) {
+			for (auto& callee : GetCallees(res[i])) { // Which loads it, if it is a stub.
+				if (range::find(res, callee) == res.end()) {
+					res.push_back(std::move(callee));
+				}
+			}
+		}
+		return res;
+	}
+
+	std::vector<std::string> FunctionManager::GetNames() const {
+		std::vector<std::string> res{};
+		res.reserve(m_FuncMap.size() + m_StubMap.size());
+		range::copy(m_FuncMap | view::keys, std::back_inserter(res));
+		range::copy(m_StubMap | view::keys, std::back_inserter(res));
+		return res;
+	}
+
+	bool FunctionManager::CanCallFromCopiesInParallel() const {
+		auto const isShared = [](FuncData const& func) {
+			return range::any_of(func.Params, &ParamData::IsPassedByRef)
+				|| range::any_of(func.CodeLines, Secret::ReachesOutside);
+		};
+
+		return range::none_of(m_StubMap, [&](auto const& stub) { 
+				return !stub.second->Loaded || isShared(*stub.second->Loaded); 
+			}) 
+			&& range::none_of(m_FuncMap | view::values, isShared);
+	}
+
+	bool FunctionManager::CanCallFromCopiesInParallel(std::string_view funcName) {
+		return range::none_of(GetReachable(funcName), [&](std::string const& name) {
+			auto const& func{Get(name)};
+			return range::any_of(func.Params, &ParamData::IsPassedByRef)
+				|| range::any_of(func.CodeLines, Secret::ReachesOutside);
+		});
+	}
+
+	bool FunctionManager::IsPure(std::string_view funcName) {
+		if (auto const it{m_Purity.find(funcName)}; it != m_Purity.end()) {
+			return it->second;
+		}
+
+		auto const bPure{range::none_of(GetReachable(funcName), [this](std::string const& name) {
+			auto const& func{Get(name)};
+			return func.IsVariadic || range::any_of(func.Params, &ParamData::IsPassedByRef)
+				|| range::any_of(func.CodeLines, Secret::ReachesOutside);
+		})};
+		m_Purity.emplace(funcName, bPure);
+		return bPure;
+	}
+
+	bool FunctionManager::IsPurityKnown(std::string_view funcName) const {
+		return m_Purity.contains(funcName);
 	}
 
 	std::optional<double> FunctionManager::CallFunction(std::string_view funcName) {
 		ARCALC_DA(IsDefined(funcName), "Call of undefined function [{}]", funcName);
 
 		auto& func{Get(funcName)};
-		if (func.CodeLines.empty()) { // Recursive call while validating, just return anything.
-			return 0.0;
-		}
-
 		if (func.IsVariadic) {
 			ARCALC_NOT_IMPLEMENTED("Variadic functions");
 
@@ -274,20 +478,32 @@ namespace ArCalc {
 			return res;
 		}(/*)(*/);
 
-		auto subParser = Parser{m_OStream, *this, paramMap};
-		if (subParser.IsOutputEnabled()) {
-			subParser.ToggleOutput();
-		}
+		return Secret::RunBody(*this, m_OStream, func, paramMap);
+	}
 
-		for (auto const& codeLine : func.CodeLines) {
-			subParser.ParseLine(codeLine);
-			if (subParser.IsCurrentStatementReturning()) {
-				return subParser.GetReturnValue(func.ReturnType);
-			}
+	std::optional<double> FunctionManager::CallFunction(std::string_view funcName, 
+		std::span<double const> args) const 
+	{
+		ARCALC_DA(IsLoaded(funcName), "Call of undefined or unloaded function [{}]", funcName);
+
+		auto const& func{m_FuncMap.find(funcName)->second};
+		ARCALC_DA(args.size() == func.Params.size(), 
+			"Function [{}] called with [{}] arguments", funcName, args.size());
+
+		auto paramMap = LiteralManager::LiteralMap{};
+		for (auto const i : view::iota(size_t{}, args.size())) {
+			ARCALC_DA(!func.Params[i].IsPassedByRef(), "Impure call of function [{}]", funcName);
+			paramMap.emplace(func.Params[i].GetName(), LiteralData::Make(args[i]));
 		}
+		return Secret::RunBody(*this, m_OStream, func, paramMap);
+	}
+
+	void FunctionManager::SetThreadPool(ThreadPool* pPool) {
+		m_pPool = pPool;
+	}
 
-		ARCALC_UNREACHABLE_CODE();
-		return {};
+	ThreadPool* FunctionManager::GetThreadPool() const {
+		return m_pPool;
 	}
 
 	void FunctionManager::Serialize(std::string_view name, std::ostream& os) {
@@ -372,7 +588,92 @@ namespace ArCalc {
 		expectSeq("}\n");
 
 		// Functions with the same names will be overriden.
+		m_StubMap.erase(funcName);
 		m_FuncMap.insert_or_assign(funcName, func); 
+		m_Purity.clear();
+	}
+
+	void FunctionManager::SerializeBinary(std::string_view name, BinaryWriter& out) {
+		// [tag] [name] [param count] { [by ref] [param name] }... 
+		// [return type] [line count] { [line of code] }...
+
+		if (!IsDefined(name)) {
+			throw SyntaxError{"Serializing undefined function [{}]", name};
+		} 
+
+		auto const& func{Get(name)};
+		out.WriteU8(CategoryFile::sc_FunctionTag);
+		out.WriteString(name);
+
+		out.WriteU32(static_cast<std::uint32_t>(func.Params.size()));
+		for (auto const& param : func.Params) {
+			if (param.IsParameterPack()) {
+				ARCALC_NOT_IMPLEMENTED("Parameter packs");
+			}
+
+			out.WriteU8(param.IsPassedByRef());
+			out.WriteString(param.GetName());
+		}
+
+		out.WriteU8(static_cast<std::uint8_t>(func.ReturnType));
+		out.WriteU32(static_cast<std::uint32_t>(func.CodeLines.size()));
+		for (auto const& line : func.CodeLines) {
+			out.WriteString(line);
+		}
+	}
+
+	void FunctionManager::DeserializeBinary(BinaryReader& in) {
+		auto [funcName, func] {ReadBinaryFunc(in)};
+
+		// Functions with the same names will be overriden.
+		m_StubMap.erase(funcName);
+		m_FuncMap.insert_or_assign(std::move(funcName), std::move(func)); 
+		m_Purity.clear();
+	}
+
+	std::pair<std::string, FuncData> FunctionManager::ReadBinaryFunc(BinaryReader& in) {
+		auto funcName = std::string{in.ReadString()};
+		auto func = FuncData{};
+
+		auto const paramCount{in.ReadCount(5U)}; // By ref flag and name size.
+		func.Params.reserve(paramCount);
+		for ([[maybe_unused]] auto const i : view::iota(0U, paramCount)) {
+			auto const bByRef{in.ReadU8() != 0U};
+			if (auto const paramName{in.ReadString()}; bByRef) {
+				func.Params.emplace_back(ParamData::MakeByRef(paramName));
+			} else {
+				func.Params.emplace_back(ParamData::MakeByValue(paramName, false));
+			}
+		}
+
+		func.ReturnType = in.ReadU8() == 1U ? FuncReturnType::Number : FuncReturnType::None;
+
+		auto const lineCount{in.ReadCount(4U)};
+		func.CodeLines.reserve(lineCount);
+		for ([[maybe_unused]] auto const i : view::iota(0U, lineCount)) {
+			func.CodeLines.emplace_back(in.ReadString());
+		}
+
+		return {std::move(funcName), std::move(func)};
+	}
+
+	void FunctionManager::AddStub(std::string_view funcName, FuncStub stub) {
+		ARCALC_DA(!stub.pCategoryPath != !stub.pSnapshot, 
+			"Stub of function [{}] must come from either a category or a snapshot", funcName);
+
+		auto ownedName = std::string{funcName};
+		m_FuncMap.erase(ownedName);
+		m_StubMap.insert_or_assign(std::move(ownedName), std::make_shared<FuncStub>(std::move(stub)));
+		m_Purity.clear();
+	}
+
+	void FunctionManager::LoadStubsFrom(fs::path const& categoryPath) {
+		for (auto it{m_StubMap.begin()}; it != m_StubMap.end();) {
+			auto const stubIt{it++};
+			if (auto const& pPath{stubIt->second->pCategoryPath}; pPath && *pPath == categoryPath) {
+				LoadStub(stubIt);
+			}
+		}
 	}
 
 	void FunctionManager::List(std::string_view prefix) const {
@@ -396,20 +697,30 @@ namespace ArCalc {
 
 			IO::Print(m_OStream, "\n    {}", funcSig);
 		}
+
+		// The parameters of those are not known before they are loaded.
+		for (auto const& [name, pStub] : m_StubMap) {
+			if (name.starts_with(prefix)) {
+				IO::Print(m_OStream, "\n    {}(...)", name);
+			}
+		}
 	}
 
 	void FunctionManager::Delete(std::string_view funcName) {
 		auto const ownedName = std::string{funcName};
-		ARCALC_DA(m_FuncMap.contains(ownedName), "Deleting non-existant function [{}]", funcName);
+		ARCALC_DA(IsDefined(ownedName), "Deleting non-existant function [{}]", funcName);
 
 		m_FuncMap.erase(ownedName);
+		m_StubMap.erase(ownedName);
+		m_Purity.clear();
 	}
 
 	void FunctionManager::Rename(std::string_view oldName, std::string_view newName) {
 		auto const ownedOldName = std::string{oldName};
-		ARCALC_DA(m_FuncMap.contains(ownedOldName), "Renaming non-existant function [{}]", oldName);
+		ARCALC_DA(IsDefined(ownedOldName), "Renaming non-existant function [{}]", oldName);
 
-		m_FuncMap.emplace(std::string{newName}, m_FuncMap.at(ownedOldName));
+		m_FuncMap.emplace(std::string{newName}, Get(ownedOldName));
 		m_FuncMap.erase(ownedOldName);
+		m_Purity.clear();
 	}
 }
\ No newline at end of file
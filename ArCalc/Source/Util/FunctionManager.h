@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Core.h"
+#include "Util.h"
+#include "BinaryStream.h"
 
 /**** Rules for parameter passing
  * Both numbers and literals can be passed by value.
@@ -20,6 +22,8 @@
 
 namespace ArCalc {
 	class Parser;
+	class MappedFile;
+	class ThreadPool;
 
 	enum class FuncReturnType : size_t {
 		None = 0,
@@ -81,9 +85,20 @@ namespace ArCalc {
 		size_t HeaderLineNumber;
 	};
 
+	// A function registered by _Load or _Restore, whose record is only read the first time 
+	// it is needed.
+	struct FuncStub {
+		std::shared_ptr<fs::path const> pCategoryPath; // Null for stubs from a snapshot, or loaded.
+		std::shared_ptr<MappedFile const> pSnapshot;   // Null for stubs from a category.
+		std::uint64_t Offset;
+		std::uint32_t Size;
+		std::optional<FuncData> Loaded; // Shared by all the copies of the manager.
+	};
+
 	class FunctionManager {
 	public:
-		using FuncMap = std::unordered_map<std::string, FuncData>;
+		using FuncMap = Util::StringMap<FuncData>;
+		using StubMap = Util::StringMap<std::shared_ptr<FuncStub>>;
 
 	public:
 		FunctionManager(FunctionManager const&)             = default;
@@ -109,6 +124,7 @@ namespace ArCalc {
 		void EndDefination();
 
 		bool IsDefined(std::string_view name) const;
+		bool IsLoaded(std::string_view name) const;
 		FuncReturnType CurrReturnType() const;
 		bool IsCurrFuncVariadic() const;
 		std::vector<ParamData> const& CurrParamData() const;
@@ -118,11 +134,61 @@ namespace ArCalc {
 
 		FuncData const& Get(std::string_view funcName) const;
 		FuncData& Get(std::string_view funcName);
+
+		// Names of the defined functions that appear in the body of [funcName].
+		std::vector<std::string> GetCallees(std::string_view funcName) const;
+
+		// [funcName] followed by every function its body can end up calling, all loaded.
+		std::vector<std::string> GetReachable(std::string_view funcName);
+
+		// Of all the functions, including the ones that are not loaded yet.
+		std::vector<std::string> GetNames() const;
+
+		// Whether copies of this manager can call functions on different threads at the same 
+		// time. Not while a stub is not loaded yet, since all the copies load it into the same 
+		// FuncStub, nor with parameters by reference, which write into the caller's literals,
+		// nor with keywords that reach files or the output (see IsPure).
+		bool CanCallFromCopiesInParallel() const;
+
+		// Same, for calling only [funcName], which can call nothing but GetReachable. Those are
+		// loaded first, so their stubs are no obstacle. Sweeps of the others run on one thread.
+		bool CanCallFromCopiesInParallel(std::string_view funcName);
+
+		// Whether calls of [funcName] can run at the same time as each other and as the code 
+		// calling them: it and everything it can end up calling take no parameters by reference
+		// and use no keyword reaching outside of the call (files, output). Loads them, and is 
+		// remembered until functions are added, removed or renamed.
+		bool IsPure(std::string_view funcName);
+
+		// Whether IsPure(funcName) only has to look up what it remembered, changing nothing.
+		bool IsPurityKnown(std::string_view funcName) const;
+
 		std::optional<double> CallFunction(std::string_view funcName);
 
+		// Same, with the arguments given in the order of the parameters instead of pushed into 
+		// them, for pure functions (see IsPure). Only reads this manager, so it can be called 
+		// from several threads at the same time.
+		std::optional<double> CallFunction(std::string_view funcName, std::span<double const> args) const;
+
+		// Where calls of pure functions may be forked to, by the evaluators of this manager.
+		void SetThreadPool(ThreadPool* pPool);
+		ThreadPool* GetThreadPool() const;
+
+		// Text format, the tag is not consumed by Deserialize.
 		void Serialize(std::string_view name, std::ostream& os);
 		void Deserialize(std::istream& is);
 
+		// Binary format (see CategoryFile), the tag is not consumed by DeserializeBinary.
+		void SerializeBinary(std::string_view name, BinaryWriter& out);
+		void DeserializeBinary(BinaryReader& in);
+
+		// [funcName] is defined from now on, but its record (see CategoryFile) is only read by 
+		// the first Get, replacing any function with the same name just like DeserializeBinary.
+		void AddStub(std::string_view funcName, FuncStub stub);
+
+		// Reads the stubs referring to [categoryPath], before the records in it get moved around.
+		void LoadStubsFrom(fs::path const& categoryPath);
+
 		void List(std::string_view prefix = "") const;
 
 		void Delete(std::string_view funcName);
@@ -133,6 +199,9 @@ namespace ArCalc {
 
 		void CopyMapFrom(FunctionManager const& what);
 
+		// Functions of [other] override the ones with the same names.
+		void MergeFrom(FunctionManager&& other);
+
 		void RedoEval(Parser& par);
 		void SubReset();
 		void ResetCurrFunc();
@@ -142,10 +211,16 @@ namespace ArCalc {
 			bool m_bReference = false);
 		void MakeVariadic();
 
+		static std::pair<std::string, FuncData> ReadBinaryFunc(BinaryReader& in);
+		FuncData& LoadStub(StubMap::iterator stubIt);
+
 	private:
 		std::string m_CurrFuncName{};
 		FuncData m_CurrFuncData{};
-		std::unordered_map<std::string, FuncData> m_FuncMap{};
+		FuncMap m_FuncMap{};
+		StubMap m_StubMap{};
+		Util::StringMap<bool> m_Purity{}; // See IsPure.
+		ThreadPool* m_pPool{};
 
 		bool m_bSuppressOutput{};
 		std::ostream& m_OStream;
@@ -2,6 +2,11 @@
 #include "Exception/ArCalcException.h"
 
 namespace ArCalc::IO {
+	namespace Secret {
+		// Not the one of Random, which sessions seed to get the same numbers every time.
+		thread_local std::mt19937_64 s_TempNameRng{std::random_device{}()};
+	}
+
 	std::string GetLine(std::istream& is) {
 		std::string line{};
 		std::getline(is, line);
@@ -14,9 +19,10 @@ namespace ArCalc::IO {
 	}
 
 	std::string Read(std::istream& is, size_t byteCount) {
-		std::string res{};
-		res.resize(std::min(byteCount, IStreamSize(is)));
+		// Trimmed to what was actually read, instead of seeking around to find the size.
+		std::string res(byteCount, '\0');
 		is.read(res.data(), res.size());
+		res.resize(static_cast<size_t>(is.gcount()));
 		return res;
 	}
 
@@ -28,6 +34,39 @@ namespace ArCalc::IO {
 		return IStreamToString(file, bKeepTrailingNulls);
 	}
 
+	std::string FileToBytes(fs::path const& filePath) {
+		std::ifstream file{filePath, std::ios::binary};
+		if (!file.is_open()) {
+			throw IOError{"Tried to read a non-existant file [{}]", filePath.string()};
+		}
+
+		std::string res(fs::file_size(filePath), '\0');
+		file.read(res.data(), res.size());
+		return res;
+	}
+
+	void ReplaceFile(fs::path const& filePath, std::string_view bytes) {
+		// Named uniquely, as other threads or processes may be replacing the same file.
+		auto tempPath{filePath};
+		tempPath += std::format(".{:016x}.tmp", Secret::s_TempNameRng());
+
+		if (std::ofstream file{tempPath, std::ios::binary | std::ios::trunc}; !file.is_open()) {
+			throw IOError{"Could not open [{}] for writing", tempPath.string()};
+		} else if (!file.write(bytes.data(), bytes.size()).flush()) {
+			file.close();
+			auto ec = std::error_code{};
+			fs::remove(tempPath, ec);
+			throw IOError{"Could not write to [{}]", tempPath.string()};
+		}
+
+		try { fs::rename(tempPath, filePath); } 
+		catch (fs::filesystem_error const&) {
+			auto ec = std::error_code{};
+			fs::remove(tempPath, ec);
+			throw;
+		}
+	}
+
 	size_t IStreamSize(std::istream& is) {
 		auto const cursorLoc{is.tellg()};
 		is.seekg(0U, std::ios::end);
@@ -62,6 +62,11 @@ namespace ArCalc::IO {
 	[[nodiscard]] std::string Read(std::istream& is, size_t byteCount);
 
 	[[nodiscard]] std::string FileToString(fs::path const& filePath, bool bKeepTrailingNulls = false);
+	[[nodiscard]] std::string FileToBytes(fs::path const& filePath); // Opened in binary mode.
+
+	// Writes to a temporary file next to [filePath] then renames it, so readers see either 
+	// the old contents or the new ones, never a mix.
+	void ReplaceFile(fs::path const& filePath, std::string_view bytes);
 	[[nodiscard]] size_t IStreamSize(std::istream& is);
 
 	template <std::default_initializable ByteContainer> requires requires 
@@ -35,13 +35,47 @@ namespace ArCalc {
 			{ "_Else"    ,  KT::Else    },
 			{ "_Save"    ,  KT::Save    },
 			{ "_Load"    ,  KT::Load    },
+			{ "_Compact" ,  KT::Compact },
+			{ "_Snapshot",  KT::Snapshot},
+			{ "_Restore" ,  KT::Restore },
 			{ "_Unscope" ,  KT::Unscope },
 			{ "_Err"     ,  KT::Err     },
 			{ "_Sum"     ,  KT::Sum     },
 			{ "_Mul"     ,  KT::Mul     },
+			{ "_Sweep"   ,  KT::Sweep   },
 			{ "_Set"     ,  KT::Set     },
 		}};
 
+		// FromString hashes the glyph into this many slots instead of scanning the map.
+		// The hash is perfect for the keywords above, which MakeKeywordSlots checks at
+		// compile time, so adding a keyword may require retuning HashGlyph.
+		constexpr static size_t sc_SlotCount{32U};
+
+		// Only called on glyphs of at least 3 characters.
+		constexpr static size_t HashGlyph(std::string_view glyph) {
+			return (2U * static_cast<unsigned char>(glyph[1])
+				+ static_cast<unsigned char>(glyph[2])
+				+ 4U * static_cast<unsigned char>(glyph.back())
+				+ 7U * glyph.size()) % sc_SlotCount;
+		}
+
+		// Maps each slot to an index in sc_KeywordMap, empty slots hold sc_KeywordMapSize.
+		consteval static std::array<size_t, sc_SlotCount> MakeKeywordSlots() {
+			std::array<size_t, sc_SlotCount> res{};
+			res.fill(sc_KeywordMapSize);
+			for (size_t i{}; i < sc_KeywordMap.size(); ++i) {
+				auto& slot{res[HashGlyph(sc_KeywordMap[i].Glyph)]};
+				if (slot != sc_KeywordMapSize) {
+					throw "Two keywords hash to the same slot"; // Fails the compilation.
+				}
+				slot = i;
+			}
+			return res;
+		}
+
+		// Defined after the class, because MakeKeywordSlots can only run once it is complete.
+		static std::array<size_t, sc_SlotCount> const sc_KeywordSlots;
+
 	private:
 		/// Contains an iterator pair can be used to iterate through all keywords.
 		struct GetAllKeywordTypesResult {
@@ -51,8 +85,13 @@ namespace ArCalc {
 
 	public:
 		constexpr static std::optional<KT> FromString(std::string_view glyph) {
-			auto const it{range::find(sc_KeywordMap, glyph, &KeywordInfo::Glyph)};
-			return it != sc_KeywordMap.end() ? it->Type : std::optional<KT>{};
+			if (glyph.size() < 3U || glyph.front() != '_') { // Shortest keyword is "_If".
+				return {};
+			}
+
+			auto const index{sc_KeywordSlots[HashGlyph(glyph)]};
+			return index != sc_KeywordMapSize && sc_KeywordMap[index].Glyph == glyph 
+				? sc_KeywordMap[index].Type : std::optional<KT>{};
 		}
 
 		constexpr static std::string_view ToStringView(KT type) {
@@ -63,7 +102,7 @@ namespace ArCalc {
 		static std::string ToString(KT type);
 
 		static bool IsValid(std::string_view glyph) {
-			return range::find(sc_KeywordMap, glyph, &KeywordInfo::Glyph) != sc_KeywordMap.end();
+			return FromString(glyph).has_value();
 		}
 
 		static KeywordInfo const& Get(KT type) {
@@ -77,6 +116,10 @@ namespace ArCalc {
 			return {sc_KeywordMap.cbegin(), sc_KeywordMap.cend()};
 		}
 	};
+
+	inline constexpr std::array<size_t, Keyword::sc_SlotCount> Keyword::sc_KeywordSlots{
+		Keyword::MakeKeywordSlots()
+	};
 }
 
 namespace std {
@@ -0,0 +1,95 @@
+#include "Lexer.h"
+#include "Str.h"
+#include "NumberParser.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	Lexer::Lexer(std::string_view source) : m_Source{source} {
+	}
+
+	Token Lexer::Next() {
+		while (!IsAtEnd() && Str::IsWhiteSpace(Peek())) {
+			++m_Pos;
+		}
+
+		if (IsAtEnd()) {
+			return {.Type{TokenType::End}};
+		} else if (auto const c{Peek()}; Str::IsAlpha(c) || c == '_') {
+			return LexIdentifier(false);
+		} else if (Str::IsDigit(c) || c == '.') {
+			// The second condition allows ".5" instead of the long-winded "0.5".
+			return LexNumber(false);
+		} else if (IsSignAt(m_Pos)) {
+			++m_Pos; // Skip the sign.
+			return Str::IsDigit(Peek()) || Peek() == '.' ? LexNumber(true) : LexIdentifier(true);
+		} else {
+			return LexOperator();
+		}
+	}
+
+	void Lexer::LexAll(std::string_view source, LexedExpr& expr) {
+		expr.Source = {};
+		expr.Tokens.clear();
+		expr.Numbers.clear();
+
+		Lexer lexer{source};
+		for (auto token{lexer.Next()}; token.Type != TokenType::End; token = lexer.Next()) {
+			if (token.Type == TokenType::Number) {
+				expr.Numbers.push_back(NumberParser{}.Parse(token.Glyph) * (token.bMinus ? -1.0 : 1.0));
+			}
+			expr.Tokens.push_back(token);
+		}
+
+		expr.Source = source;
+	}
+
+	Token Lexer::LexNumber(bool bMinus) {
+		// The first character was already checked by the caller.
+		auto const start{m_Pos++};
+		while (!IsAtEnd() && Str::IsNumberChar(Peek())) {
+			++m_Pos;
+		}
+
+		auto const glyph{m_Source.substr(start, m_Pos - start)};
+		if (!IsAtEnd() && Str::IsAlpha(Peek())) { // Alphabetic but not valid hex or base spec.
+			throw ParseError{
+				"Found invalid character [{}] while parsing number [{}]",
+				Peek(), glyph,
+			};
+		}
+
+		return {.Type{TokenType::Number}, .Glyph{glyph}, .bMinus{bMinus}};
+	}
+
+	Token Lexer::LexIdentifier(bool bMinus) {
+		auto const start{m_Pos};
+		while (!IsAtEnd() && Str::IsIdentChar(Peek())) {
+			++m_Pos;
+		}
+
+		return {.Type{TokenType::Identifier}, .Glyph{m_Source.substr(start, m_Pos - start)}, 
+			.bMinus{bMinus}};
+	}
+
+	Token Lexer::LexOperator() {
+		// Symbolic operators run until whitespace, an alphanumeric, or the sign of the 
+		// next operand, so "5 3*-2" is "5", "3", "*", "-2".
+		auto const start{m_Pos++};
+		while (!IsAtEnd() && !IsSignAt(m_Pos)
+			&& !Str::IsWhiteSpace(Peek()) && !Str::IsAlNum(Peek())) 
+		{
+			++m_Pos;
+		}
+
+		return {.Type{TokenType::Operator}, .Glyph{m_Source.substr(start, m_Pos - start)}};
+	}
+
+	bool Lexer::IsSignAt(size_t index) const {
+		if (index + 1 >= m_Source.size() || m_Source[index] != '-') {
+			return false;
+		}
+
+		auto const next{m_Source[index + 1]};
+		return Str::IsIdentChar(next) || next == '.';
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	enum class TokenType : size_t {
+		End = 0U,
+		Identifier,
+		Number,
+		Operator,
+	};
+
+	struct Token {
+		TokenType Type;
+		std::string_view Glyph;
+		bool bMinus{}; // Numbers and identifiers directly preceded by a `-`, not in Glyph.
+	};
+
+	/// An expression that was split into tokens ahead of time (see ScriptPipeline), with the 
+	/// values of its numbers already parsed, and their signs applied.
+	struct LexedExpr {
+		std::string_view Source;
+		std::vector<Token> Tokens; // Without the End token.
+		std::vector<double> Numbers;
+	};
+
+	/// Splits a postfix expression into tokens. Every token is a view into the source
+	/// string, so the source must outlive the tokens.
+	class Lexer {
+	public:
+		Lexer(std::string_view source);
+
+	public:
+		// Returns a token of type End once the source is exhausted.
+		Token Next();
+
+		// Lexes the whole of [source] into [expr], reusing the capacity of its vectors.
+		// Throws like Next, leaving [expr] with no source.
+		static void LexAll(std::string_view source, LexedExpr& expr);
+
+	private:
+		Token LexNumber(bool bMinus);
+		Token LexIdentifier(bool bMinus);
+		Token LexOperator();
+
+		// Whether a `-` at [index] is the sign of the operand following it.
+		bool IsSignAt(size_t index) const;
+
+		constexpr bool IsAtEnd() const {
+			return m_Pos >= m_Source.size();
+		}
+
+		constexpr char Peek() const {
+			return m_Source[m_Pos];
+		}
+
+	private:
+		std::string_view m_Source;
+		size_t m_Pos{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include "LineArena.h"
+
+namespace ArCalc {
+	LineArena::LineArena() : m_Resource{m_InlineBuffer.data(), m_InlineBuffer.size()} {
+	}
+
+	std::pmr::memory_resource& LineArena::Resource() {
+		return m_Resource;
+	}
+
+	void LineArena::Reset() {
+		// Goes back to the inline buffer, and frees whatever spilled onto the heap.
+		m_Resource.release();
+	}
+}
\ No newline at end of file
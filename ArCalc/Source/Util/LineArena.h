@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Monotonic arena for the temporaries needed while handling a single line (token
+	/// lists, operand lists...). Deallocating is a no-op, everything is given back at
+	/// once by Reset, which the parser calls after each line. The first few kilobytes
+	/// live inside the arena itself, so most lines never reach the heap.
+	class LineArena {
+	public:
+		constexpr static size_t InlineSize{2048U};
+
+	public:
+		LineArena();
+		LineArena(LineArena const&)            = delete;
+		LineArena(LineArena&&)                 = delete;
+		LineArena& operator=(LineArena const&) = delete;
+		LineArena& operator=(LineArena&&)      = delete;
+
+	public:
+		std::pmr::memory_resource& Resource();
+		void Reset();
+
+	private:
+		alignas(std::max_align_t) std::array<std::byte, InlineSize> m_InlineBuffer{};
+		std::pmr::monotonic_buffer_resource m_Resource;
+	};
+}
\ No newline at end of file
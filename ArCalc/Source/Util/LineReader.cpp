@@ -0,0 +1,53 @@
+#include "LineReader.h"
+#include "ScriptCache.h"
+
+namespace ArCalc {
+	LineReader::LineReader(std::istream& is) 
+		: m_pStream{&is}, m_Hash{ScriptCache::sc_HashBasis} 
+	{
+	}
+
+	LineReader::LineReader(std::string_view text) 
+		: m_Text{text}, m_Hash{ScriptCache::sc_HashBasis} 
+	{
+	}
+
+	std::optional<std::string_view> LineReader::Next() {
+		if (m_pStream) {
+			if (m_pFlushBeforeWaiting && m_pStream->rdbuf()->in_avail() <= 0) {
+				m_pFlushBeforeWaiting->flush();
+			}
+
+			if (!std::getline(*m_pStream, m_Buffer)) {
+				return {};
+			}
+
+			Consume(m_Buffer);
+			if (!m_pStream->eof()) { // Otherwise the last line had no newline after it.
+				Consume("\n");
+			}
+
+			++m_LineCount;
+			return m_Buffer;
+		}
+
+		if (m_Text.empty()) {
+			return {};
+		}
+
+		auto const lineSize{std::min(m_Text.find('\n'), m_Text.size())};
+		auto const res{m_Text.substr(0U, lineSize)};
+		auto const consumedSize{std::min(lineSize + 1U, m_Text.size())};
+
+		Consume(m_Text.substr(0U, consumedSize));
+		m_Text.remove_prefix(consumedSize);
+
+		++m_LineCount;
+		return res;
+	}
+
+	void LineReader::Consume(std::string_view bytes) {
+		m_Hash = ScriptCache::Hash(bytes, m_Hash);
+		m_Size += bytes.size();
+	}
+}
\ No newline at end of file
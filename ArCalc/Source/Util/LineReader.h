@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Hands out the lines of a script one at a time, so that it is never held in memory as a 
+	/// whole, and the first lines can run before the rest is even read (e.g. from a pipe).
+	/// 
+	/// Lines are split the same way std::getline splits them, whichever the source is. What was 
+	/// read so far is hashed along the way (see ScriptCache), as the hash of a stream can only
+	/// be known once it ends.
+	class LineReader {
+	public:
+		LineReader(LineReader const&)            = delete;
+		LineReader(LineReader&&)                 = delete;
+		LineReader& operator=(LineReader const&) = delete;
+		LineReader& operator=(LineReader&&)      = delete;
+
+		LineReader(std::istream& is);
+		LineReader(std::string_view text); // Not copied, has to outlive the reader.
+
+	public:
+		// The line is only valid until the next call.
+		std::optional<std::string_view> Next();
+
+		// [pOutput] gets flushed whenever reading the next line might have to wait for it, so 
+		// the results of the lines before it are seen first. Only streams ever wait, and they 
+		// are read on the thread running the parser (see ScriptPipeline).
+		constexpr void SetFlushBeforeWaiting(std::ostream* pOutput) {
+			m_pFlushBeforeWaiting = pOutput;
+		}
+
+		constexpr size_t GetLineCount() const {
+			return m_LineCount;
+		}
+
+		// Of the bytes read so far, which is all of them once Next returns nothing.
+		constexpr std::uint64_t GetHash() const {
+			return m_Hash;
+		}
+
+		constexpr std::uint64_t GetSize() const {
+			return m_Size;
+		}
+
+	private:
+		void Consume(std::string_view bytes);
+
+	private:
+		std::istream* m_pStream{};
+		std::string_view m_Text{};
+		std::string m_Buffer{};
+		std::ostream* m_pFlushBeforeWaiting{};
+
+		size_t m_LineCount{};
+		std::uint64_t m_Hash;
+		std::uint64_t m_Size{};
+	};
+}
\ No newline at end of file
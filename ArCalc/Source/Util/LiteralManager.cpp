@@ -4,6 +4,8 @@
 #include "Exception/ArCalcException.h"
 #include "Keyword.h"
 #include "IO.h"
+#include "CategoryFile.h"
+#include "NumberFormatter.h"
 
 namespace ArCalc {
 	LiteralManager::LiteralManager(std::ostream& os) : m_OStream{os} {
@@ -29,7 +31,7 @@ namespace ArCalc {
 	}
 
 	double LiteralManager::GetLast() const {
-		return *m_LitMap.at(Keyword::ToString(KeywordType::Last));
+		return *m_LitMap.find(Keyword::ToStringView(KeywordType::Last))->second;
 	}
 
 	void LiteralManager::SetLast(double toWhat) {
@@ -37,7 +39,7 @@ namespace ArCalc {
 	}
 
 	bool LiteralManager::IsVisible(std::string_view litName) const {
-		return m_LitMap.contains(std::string{litName});
+		return m_LitMap.contains(litName);
 	}
 
 	void LiteralManager::List(std::string_view prefix) const {
@@ -49,7 +51,8 @@ namespace ArCalc {
 
 		for (auto const& [name, data] : m_LitMap) {
 			if (name != "_Last" && name.starts_with(prefix)) {
-				IO::Print(m_OStream, "\n{}{} = {}", Tab, name, *data);
+				IO::Print(m_OStream, "\n{}{} = ", Tab, name);
+				NumberFormatter::Write(m_OStream, *data);
 			}
 		}
 	}
@@ -60,24 +63,64 @@ namespace ArCalc {
 
 	LiteralData& LiteralManager::Get(std::string_view litName) {
 		ARCALC_DA(IsVisible(litName), "Getting Invalid literal [{}]", litName);
-		return m_LitMap.at(std::string{litName});
+		return m_LitMap.find(litName)->second;
 	}
 
 	void LiteralManager::Serialize(std::string_view name, std::ostream& os) {
-		os << std::format("C {} {}\n\n", name, *Get(name));
+		// Shortest round-trip, so the value is read back exactly.
+		os << "C " << name << ' ';
+		NumberFormatter::Write(os, *Get(name));
+		os << "\n\n";
 	}
 	
 	void LiteralManager::Deserialize(std::istream& is) {
 		auto const name{IO::Input<std::string>(is)};
-		auto const value{IO::Input<double>(is)};
+		auto const valueStr{IO::Input<std::string>(is)};
+
+		// Parsed the same way NumberFormatter wrote it, so the value is exactly the saved one.
+		auto value = double{};
+		auto const pEnd{valueStr.data() + valueStr.size()};
+		if (auto const [ptr, errorCode] {std::from_chars(valueStr.data(), pEnd, value)}; 
+			errorCode != std::errc{} || ptr != pEnd) 
+		{
+			throw ParseError{"Invalid value [{}] of saved literal [{}]", valueStr, name};
+		}
 		// Clashing names will be overriden for now.
 		m_LitMap.insert_or_assign(name, LiteralData::Make(value));
 	}
 
+	void LiteralManager::SerializeBinary(std::string_view name, BinaryWriter& out) {
+		// [tag] [name] [value]
+		out.WriteU8(CategoryFile::sc_LiteralTag);
+		out.WriteString(name);
+		out.WriteF64(*Get(name));
+	}
+
+	void LiteralManager::DeserializeBinary(BinaryReader& in) {
+		auto const name{in.ReadString()};
+		auto const value{in.ReadF64()};
+		// Clashing names will be overriden for now.
+		m_LitMap.insert_or_assign(std::string{name}, LiteralData::Make(value));
+	}
+
 	void LiteralManager::SetMap(LiteralMap const& toWhat) {
 		m_LitMap = toWhat;
 	}
 
+	void LiteralManager::MergeFrom(LiteralManager&& other) {
+		for (auto& [name, data] : other.m_LitMap) {
+			m_LitMap.insert_or_assign(name, data);
+		}
+		other.m_LitMap.clear();
+	}
+
+	std::vector<std::string> LiteralManager::GetNames() const {
+		std::vector<std::string> res{};
+		res.reserve(m_LitMap.size());
+		range::copy(m_LitMap | view::keys, std::back_inserter(res));
+		return res;
+	}
+
 	void LiteralManager::SubReset() {
 		m_LitMap.clear();
 	}
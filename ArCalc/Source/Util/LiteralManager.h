@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Core.h"
+#include "Util.h"
+#include "BinaryStream.h"
 
 namespace ArCalc {
 	class LiteralData {
@@ -51,7 +53,7 @@ namespace ArCalc {
 
 	class LiteralManager {
 	public:
-		using LiteralMap = std::unordered_map<std::string, LiteralData>;
+		using LiteralMap = Util::StringMap<LiteralData>;
 
 	public:
 		LiteralManager(LiteralManager const&)            = default;
@@ -73,15 +75,24 @@ namespace ArCalc {
 		LiteralData const& Get(std::string_view litName) const;
 		LiteralData& Get(std::string_view litName);
 		bool IsVisible(std::string_view litName) const;
+		std::vector<std::string> GetNames() const;
 
+		// Text format, the tag is not consumed by Deserialize.
 		void Serialize(std::string_view name, std::ostream& os);
 		void Deserialize(std::istream& is);
 
+		// Binary format (see CategoryFile), the tag is not consumed by DeserializeBinary.
+		void SerializeBinary(std::string_view name, BinaryWriter& out);
+		void DeserializeBinary(BinaryReader& in);
+
 		constexpr void ToggleOutput()          { m_bSuppressOutput ^= 1; }
 		constexpr bool IsOutputEnabled() const { return !m_bSuppressOutput; }
 
 		void SetMap(LiteralMap const& toWhat);
 
+		// Literals of [other] override the ones with the same names.
+		void MergeFrom(LiteralManager&& other);
+
 		void SubReset();
 
 	private:
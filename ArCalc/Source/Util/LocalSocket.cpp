@@ -0,0 +1,172 @@
+#include "LocalSocket.h"
+#include "Exception/ArCalcException.h"
+
+#ifdef _WIN32
+#include "ArWin.h"
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else // ^^^^ Windows, vvvv POSIX
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace ArCalc {
+	namespace Secret {
+#ifdef _WIN32
+		using PollFd = WSAPOLLFD;
+		constexpr auto PollSockets{&WSAPoll};
+		constexpr auto CloseSocket{&closesocket};
+		constexpr int ShutdownBoth{SD_BOTH};
+		constexpr int SendFlags{};
+
+		void StartSockets() {
+			static auto const started = [] {
+				auto data = WSADATA{};
+				if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+					throw IOError{"Could not initialize Winsock"};
+				}
+				return true;
+			}(/*)(*/);
+		}
+#else // ^^^^ Windows, vvvv POSIX
+		using PollFd = pollfd;
+		constexpr auto PollSockets{&poll};
+		constexpr auto CloseSocket{&close};
+		constexpr int ShutdownBoth{SHUT_RDWR};
+#ifdef MSG_NOSIGNAL
+		constexpr int SendFlags{MSG_NOSIGNAL}; // A closed peer is reported as an error instead.
+#else
+		constexpr int SendFlags{};
+#endif
+
+		constexpr void StartSockets() {}
+#endif
+
+		sockaddr_un MakeAddress(fs::path const& socketPath) {
+			auto res = sockaddr_un{};
+			res.sun_family = AF_UNIX;
+
+			auto const pathString{socketPath.string()};
+			if (pathString.size() >= sizeof(res.sun_path)) {
+				throw IOError{"Socket path [{}] is too long", pathString};
+			}
+
+			range::copy(pathString, res.sun_path);
+			return res;
+		}
+
+		LocalSocket::Handle OpenSocket() {
+			StartSockets();
+			auto const handle{static_cast<LocalSocket::Handle>(::socket(AF_UNIX, SOCK_STREAM, 0))};
+			if (handle == LocalSocket::sc_InvalidHandle) {
+				throw IOError{"Could not create a socket"};
+			}
+			return handle;
+		}
+
+		// Whether [handle] became readable within [timeout].
+		bool WaitReadable(LocalSocket::Handle handle, std::chrono::milliseconds timeout) {
+			auto pollFd = PollFd{};
+			pollFd.fd = handle;
+			pollFd.events = POLLIN;
+			return PollSockets(&pollFd, 1, static_cast<int>(timeout.count())) > 0;
+		}
+	}
+
+	LocalSocket::LocalSocket(Handle handle) : m_Handle{handle} {}
+
+	LocalSocket::LocalSocket(LocalSocket&& other) noexcept 
+		: m_Handle{std::exchange(other.m_Handle, sc_InvalidHandle)} {}
+
+	LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+		if (this != &other) {
+			Close();
+			m_Handle = std::exchange(other.m_Handle, sc_InvalidHandle);
+		}
+		return *this;
+	}
+
+	LocalSocket::~LocalSocket() {
+		Close();
+	}
+
+	LocalSocket LocalSocket::Connect(fs::path const& socketPath) {
+		auto res = LocalSocket{Secret::OpenSocket()};
+		auto const address{Secret::MakeAddress(socketPath)};
+		if (::connect(res.m_Handle, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+			throw IOError{"Could not connect to [{}]", socketPath.string()};
+		}
+		return res;
+	}
+
+	void LocalSocket::Send(std::string_view bytes) {
+		while (!bytes.empty()) {
+			auto const sent{::send(m_Handle, bytes.data(), 
+				static_cast<int>(std::min<size_t>(bytes.size(), INT_MAX)), Secret::SendFlags)};
+			if (sent <= 0) {
+				throw IOError{"Connection closed while sending"};
+			}
+			bytes.remove_prefix(static_cast<size_t>(sent));
+		}
+	}
+
+	std::optional<size_t> LocalSocket::Receive(std::span<char> buffer, std::chrono::milliseconds timeout) {
+		if (!Secret::WaitReadable(m_Handle, timeout)) {
+			return std::nullopt;
+		}
+
+		auto const received{::recv(m_Handle, buffer.data(), 
+			static_cast<int>(std::min<size_t>(buffer.size(), INT_MAX)), 0)};
+		// An error means the connection is gone just as much as an orderly close does.
+		return received > 0 ? static_cast<size_t>(received) : 0U;
+	}
+
+	void LocalSocket::Shutdown() {
+		if (IsOpen()) {
+			::shutdown(m_Handle, Secret::ShutdownBoth);
+		}
+	}
+
+	void LocalSocket::Close() {
+		if (IsOpen()) {
+			Secret::CloseSocket(m_Handle);
+			m_Handle = sc_InvalidHandle;
+		}
+	}
+
+	LocalListener::LocalListener(fs::path const& socketPath) 
+		: m_Path{socketPath}, m_Socket{Secret::OpenSocket()}
+	{
+		auto ec = std::error_code{};
+		fs::remove(m_Path, ec);
+
+		auto const address{Secret::MakeAddress(m_Path)};
+		if (::bind(m_Socket.GetHandle(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+			throw IOError{"Could not bind a socket to [{}]", m_Path.string()};
+		}
+
+		if (::listen(m_Socket.GetHandle(), SOMAXCONN) != 0) {
+			throw IOError{"Could not listen on [{}]", m_Path.string()};
+		}
+	}
+
+	LocalListener::~LocalListener() {
+		auto ec = std::error_code{};
+		fs::remove(m_Path, ec);
+	}
+
+	std::optional<LocalSocket> LocalListener::Accept(std::chrono::milliseconds timeout) {
+		if (!Secret::WaitReadable(m_Socket.GetHandle(), timeout)) {
+			return std::nullopt;
+		}
+
+		auto const handle{static_cast<LocalSocket::Handle>(::accept(m_Socket.GetHandle(), nullptr, nullptr))};
+		if (handle == LocalSocket::sc_InvalidHandle) {
+			return std::nullopt; // The client gave up before being accepted.
+		}
+		return LocalSocket{handle};
+	}
+}
\ No newline at end of file
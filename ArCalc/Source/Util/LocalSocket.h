@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// A connected Unix domain stream socket. Windows supports those as well (since 
+	/// Windows 10), so the same path based protocol works on both platforms.
+	class LocalSocket {
+	public:
+#ifdef _WIN32
+		using Handle = std::uintptr_t;
+#else // ^^^^ Windows, vvvv POSIX
+		using Handle = int;
+#endif
+		constexpr static Handle sc_InvalidHandle{static_cast<Handle>(-1)};
+
+	public:
+		LocalSocket(LocalSocket const&)            = delete;
+		LocalSocket& operator=(LocalSocket const&) = delete;
+
+		LocalSocket() = default;
+		LocalSocket(Handle handle);
+		LocalSocket(LocalSocket&& other) noexcept;
+		LocalSocket& operator=(LocalSocket&& other) noexcept;
+		~LocalSocket();
+
+		// Throws IOError if nobody listens on [socketPath].
+		static LocalSocket Connect(fs::path const& socketPath);
+
+	public:
+		// Sends all of [bytes], throws IOError if the connection is gone.
+		void Send(std::string_view bytes);
+
+		// Returns the number of bytes received, 0 once the peer closed the connection, or
+		// nullopt if nothing arrived within [timeout].
+		std::optional<size_t> Receive(std::span<char> buffer, std::chrono::milliseconds timeout);
+
+		// Ends the connection in both directions, without closing the handle yet.
+		void Shutdown();
+
+		constexpr bool IsOpen() const {
+			return m_Handle != sc_InvalidHandle;
+		}
+
+		constexpr Handle GetHandle() const {
+			return m_Handle;
+		}
+
+	private:
+		void Close();
+
+	private:
+		Handle m_Handle{sc_InvalidHandle};
+	};
+
+	/// Listens on a Unix domain socket, whose path is removed again when the listener is
+	/// destroyed.
+	class LocalListener {
+	public:
+		LocalListener(LocalListener const&)            = delete;
+		LocalListener(LocalListener&&)                 = delete;
+		LocalListener& operator=(LocalListener const&) = delete;
+		LocalListener& operator=(LocalListener&&)      = delete;
+
+		// Replaces whatever is left at [socketPath] from a previous run.
+		LocalListener(fs::path const& socketPath);
+		~LocalListener();
+
+	public:
+		// Returns nullopt if no client connected within [timeout].
+		std::optional<LocalSocket> Accept(std::chrono::milliseconds timeout);
+
+		constexpr fs::path const& GetPath() const {
+			return m_Path;
+		}
+
+	private:
+		fs::path m_Path;
+		LocalSocket m_Socket;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+#include "Exception/ArCalcException.h"
+
+#ifdef _WIN32
+#include "ArWin.h"
+#else // ^^^^ Windows, vvvv POSIX
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ArCalc {
+	MappedFile::MappedFile(fs::path const& filePath) 
+		: m_Path{filePath}, m_Size{static_cast<size_t>(fs::file_size(filePath))}
+	{
+		if (m_Size == 0U) { // Neither platform can map an empty file, but there is nothing to map.
+			return;
+		}
+
+#ifdef _WIN32
+		// Sharing deletion lets the file be replaced while mapped (e.g. by another _Snapshot), 
+		// the mapping keeps the old contents alive like it does on POSIX.
+		m_FileHandle = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, 
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_FileHandle == INVALID_HANDLE_VALUE) {
+			m_FileHandle = {};
+			throw IOError{"Could not open [{}] for mapping", filePath.string()};
+		}
+
+		m_MappingHandle = CreateFileMappingW(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		auto const pView{m_MappingHandle 
+			? MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr};
+#else // ^^^^ Windows, vvvv POSIX
+		m_FileDescriptor = open(filePath.c_str(), O_RDONLY);
+		if (m_FileDescriptor == -1) {
+			throw IOError{"Could not open [{}] for mapping", filePath.string()};
+		}
+
+		auto pView{mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, m_FileDescriptor, 0)};
+		if (pView == MAP_FAILED) {
+			pView = nullptr;
+		}
+#endif
+
+		if (!pView) {
+			Unmap();
+			throw IOError{"Could not map [{}] into memory", filePath.string()};
+		}
+
+		m_pData = static_cast<char const*>(pView);
+	}
+
+	MappedFile::~MappedFile() {
+		Unmap();
+	}
+
+	void MappedFile::Unmap() {
+#ifdef _WIN32
+		if (m_pData) {
+			UnmapViewOfFile(m_pData);
+		}
+
+		if (m_MappingHandle) {
+			CloseHandle(m_MappingHandle);
+		}
+
+		if (m_FileHandle) {
+			CloseHandle(m_FileHandle);
+		}
+#else // ^^^^ Windows, vvvv POSIX
+		if (m_pData) {
+			munmap(const_cast<char*>(m_pData), m_Size);
+		}
+
+		if (m_FileDescriptor != -1) {
+			close(m_FileDescriptor);
+		}
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Maps a whole file into memory, read-only. The pages are shared with every other 
+	/// process that maps the same file, and are only read from disc when touched.
+	class MappedFile {
+	public:
+		MappedFile(MappedFile const&)            = delete;
+		MappedFile(MappedFile&&)                 = delete;
+		MappedFile& operator=(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile&&)      = delete;
+
+		MappedFile(fs::path const& filePath);
+		~MappedFile();
+
+	public:
+		constexpr std::string_view GetBytes() const {
+			return {m_pData, m_Size};
+		}
+
+		constexpr fs::path const& GetPath() const {
+			return m_Path;
+		}
+
+	private:
+		void Unmap();
+
+	private:
+		fs::path m_Path;
+		char const* m_pData{};
+		size_t m_Size{};
+
+#ifdef _WIN32
+		void* m_FileHandle{};
+		void* m_MappingHandle{};
+#else // ^^^^ Windows, vvvv POSIX
+		int m_FileDescriptor{-1};
+#endif
+	};
+}
\ No newline at end of file
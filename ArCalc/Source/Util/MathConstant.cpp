@@ -3,20 +3,13 @@
 #include "IO.h"
 
 namespace ArCalc {
-	std::unordered_map<std::string, double> MathConstant::s_ConstantMap{
-		{"_e", std::numbers::e},
-		{"_pi", std::numbers::pi},
-		{"_inf", std::numeric_limits<double>::infinity()},
-
-	};
-
 	bool MathConstant::IsValid(std::string_view glyph) {
-		return s_ConstantMap.contains(std::string{glyph});
+		return range::find(sc_ConstantMap, glyph, &MathConstantInfo::Glyph) != sc_ConstantMap.end();
 	}
 
 	double MathConstant::ValueOf(std::string_view glyph) {
-		auto const it{s_ConstantMap.find(std::string{glyph})}; 
-		ARCALC_DA(it != s_ConstantMap.end(), "Value of invalid constant ({})", glyph);
-		return it->second;
+		auto const it{range::find(sc_ConstantMap, glyph, &MathConstantInfo::Glyph)}; 
+		ARCALC_DA(it != sc_ConstantMap.end(), "Value of invalid constant ({})", glyph);
+		return it->Value;
 	}
-}
+}
\ No newline at end of file
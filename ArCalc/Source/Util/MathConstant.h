@@ -3,12 +3,22 @@
 #include "Core.h"
 
 namespace ArCalc {
+	struct MathConstantInfo {
+		std::string_view Glyph;
+		double Value;
+	};
+
 	class MathConstant {
 	public:
 		MathConstant() = delete;
 
 	private:
-		static std::unordered_map<std::string, double> s_ConstantMap;
+		// Small enough that a linear search beats hashing the glyph.
+		constexpr static std::array<MathConstantInfo, 3U> sc_ConstantMap{{
+			{ "_e"   , std::numbers::e                         },
+			{ "_pi"  , std::numbers::pi                        },
+			{ "_inf" , std::numeric_limits<double>::infinity() },
+		}};
 
 	public:
 		static bool IsValid(std::string_view glyph);
@@ -9,27 +9,313 @@ namespace ArCalc {
 		Variadic = 1UI64 << 3U,
 	};
 
-	MathOperator const MathOperator::s_InitializationInstance{};
+	namespace Secret {
+		/// Builds the table of all operators, sorted by glyph. Everything here runs at compile
+		/// time, so the table is plain read-only data: nothing is allocated or initialized 
+		/// at startup, and it can be used during static initialization of other files.
+		class MathOperatorTable {
+		private:
+			using OT = MathOperatorType;
+			using OperandList = std::span<double const>;
+
+		public:
+			struct OpInfo {
+				constexpr std::string_view Glyph() const {
+					return {GlyphBuffer.data(), GlyphLength};
+				}
+
+				// Owned by the table, since the conversion operator names are generated.
+				std::array<char, 16U> GlyphBuffer;
+				size_t GlyphLength;
+				OT Type;
+				double (*Func)(OperandList operands, OpInfo const& self);
+				double Param; // Ratio of the conversion operators.
+			};
 
-	MathOperator::MathOperator() {
-		if (!IsInitialized()) {
-			Initialize();
-		}
-	}
+			// Build fails to compile when there are more operators than this.
+			constexpr static size_t sc_Capacity{128U};
+
+			struct Table {
+				std::array<OpInfo, sc_Capacity> Ops;
+				size_t Count;
+			};
+
+		public:
+			consteval static Table Build() {
+				MathOperatorTable builder{};
+				builder.AddBasicOperators();
+				builder.AddTrigOperators();
+				builder.AddConversionOperators();
+
+				auto& [ops, count] {builder.m_Table};
+				auto const used{range::subrange(ops.begin(), ops.begin() + count)};
+				range::sort(used, {}, &OpInfo::Glyph);
+				if (range::adjacent_find(used, {}, &OpInfo::Glyph) != used.end()) {
+					throw "Found two operators with the same glyph"; // Fails the compilation.
+				}
+
+				return builder.m_Table;
+			}
+
+		private:
+			consteval void AddOperator(std::string_view glyph, OT type, 
+				double (*func)(OperandList, OpInfo const&), double param = 0.0) 
+			{
+				if (m_Table.Count == sc_Capacity) {
+					throw "MathOperatorTable::sc_Capacity is too small";
+				} else if (glyph.size() > std::tuple_size_v<decltype(OpInfo::GlyphBuffer)>) {
+					throw "Operator glyph does not fit in OpInfo::GlyphBuffer";
+				}
+
+				auto& op{m_Table.Ops[m_Table.Count++]};
+				range::copy(glyph, op.GlyphBuffer.begin());
+				op.GlyphLength = glyph.size();
+				op.Type        = type;
+				op.Func        = func;
+				op.Param       = param;
+			}
+
+			// The callables below are all captureless, so they are rebuilt from their type 
+			// inside a captureless wrapper, which decays to a plain function pointer.
 
-	bool MathOperator::IsInitialized() {
-		return !s_Operators.empty();
+			template <class Func>
+			consteval void AddUnaryOperator(std::string_view glyph, Func) {
+				AddOperator(glyph, OT::Unary, [](OperandList operands, OpInfo const&) -> double {
+					return Func{}(operands[0]);
+				});
+			}
+
+			template <class Func>
+			consteval void AddBinaryOperator(std::string_view glyph, Func) {
+				AddOperator(glyph, OT::Binary, [](OperandList operands, OpInfo const&) -> double {
+					return Func{}(operands[0], operands[1]);
+				});
+			}
+
+			template <class Func>
+			consteval void AddVariadicOperator(std::string_view glyph, Func) {
+				AddOperator(glyph, OT::Variadic, [](OperandList operands, OpInfo const&) -> double {
+					return Func{}(operands);
+				});
+			}
+
+			consteval void AddBasicOperators() {
+				// Arithmatic
+				AddBinaryOperator("+", std::plus<>{});
+				AddBinaryOperator("-", std::minus<>{});
+				AddBinaryOperator("*", [](auto l, auto r) { return l * r; });
+				AddBinaryOperator("/", [](auto l, auto r) { return l / r; });
+				AddBinaryOperator("mod", [](auto l, auto r) {
+					if (l < 0.0) {
+						throw MathError{"Modulus operator with lhs [{}] (negative)", l};
+					} else if (std::fmod(l, 1.0) > 0.000001) {
+						throw MathError{"Modulus operator with lhs [{}] (non-integer)", l};
+					}
+
+					if (r < 0.0) {
+						throw MathError{"Modulus operator with rhs [{}] (negative)", r};
+					} else if (std::fmod(r, 1.0) > 0.000001) {
+						throw MathError{"Modulus operator with rhs [{}] (non-integer)", r};
+					}
+					return static_cast<double>(static_cast<size_t>(l) % static_cast<size_t>(r)); 
+				});
+
+				// Relational
+				AddBinaryOperator("<", std::less          <>{});
+				AddBinaryOperator("<=", std::less_equal   <>{});
+				AddBinaryOperator("==", std::equal_to     <>{});
+				AddBinaryOperator("!=", std::not_equal_to <>{});
+				AddBinaryOperator(">=", std::greater_equal<>{});
+				AddBinaryOperator(">", std::greater       <>{});
+
+				// Logical
+				AddBinaryOperator("&&", [](auto l, auto r) { return l && r ? 1.0 : 0.0; });
+				AddBinaryOperator("||", [](auto l, auto r) { return l || r ? 1.0 : 0.0; });
+				AddBinaryOperator("^^", [](auto l, auto r) { return l && !r || r && !l ? 1.0 : 0.0; });
+				AddUnaryOperator("!",   [](auto o        ) { return std::abs(o) < 0.000001; });
+
+				// Utils
+				AddBinaryOperator("max", [](auto l, auto r) { return std::max(l, r); });
+				AddBinaryOperator("min", [](auto l, auto r) { return std::min(l, r); });
+				AddBinaryOperator("gcd", [](auto l, auto r) {
+					if (l < 0.0) {
+						throw MathError{"Operator gcd with lhs [{}] (negative)", l};
+					} else if (std::fmod(l, 1.0) > 0.000001) {
+						throw MathError{"Operator gcd with lhs [{}] (non-integer)", l};
+					}
+
+					if (r < 0.0) {
+						throw MathError{"Operator gcd with rhs [{}] (negative)", r};
+					} else if (std::fmod(r, 1.0) > 0.000001) {
+						throw MathError{"Operator gcd with rhs [{}] (non-integer)", r};
+					}
+
+					return static_cast<double>(std::gcd(static_cast<size_t>(l), static_cast<size_t>(r)));
+				});
+
+				AddVariadicOperator("sum", [](auto const& operands) {
+					return std::accumulate(operands.begin(), operands.end(), 0.0);
+				});
+
+				AddVariadicOperator("mul", [](auto const& operands) {
+					return std::accumulate(operands.begin(), operands.end(), 1.0, std::multiplies<>{});
+				});
+
+				// Unary
+				AddUnaryOperator("negate", [](auto o) { return -o; });
+				AddUnaryOperator("abs",    [](auto o) { return std::abs(o); });
+				AddUnaryOperator("floor",  [](auto o) { return std::floor(o); });
+				AddUnaryOperator("ceil",   [](auto o) { return std::ceil(o); });
+				AddUnaryOperator("round",  [](auto o) { return std::round(o); });
+				AddUnaryOperator("sign",   [](auto o) { return (o > 0.0) ? +1.0 : (o < 0.0) ? -1.0 : 0.0; });
+				AddUnaryOperator("sqrt", [](auto o) {
+					MathOperator::AssertNotInfinity(o, "sqrt");
+					MathOperator::AssertGreaterThan(o, 0, "sqrt");
+					return std::sqrt(o); 
+				});
+
+				// Probability
+				AddUnaryOperator("fac", [](auto o) { return MathOperator::FloatFactorio(o); });
+				AddBinaryOperator("perm", [](auto l, auto r) {
+					return MathOperator::FloatFactorio(l) / MathOperator::FloatFactorio(l - r);
+				});
+				AddBinaryOperator("choose", [](auto l, auto r) {
+					return MathOperator::FloatFactorio(l) 
+						/ (MathOperator::FloatFactorio(r) * MathOperator::FloatFactorio(l - r));
+				});
+
+				// Exponential
+				AddBinaryOperator("^", [](auto l, auto r) {
+					return std::pow(l, r);
+				});
+				AddUnaryOperator("exp", [](auto o) {
+					return std::pow(std::numbers::e, o);
+				});
+				AddUnaryOperator("ln", [](auto o) {
+					MathOperator::AssertNotInfinity(o, "ln");
+					MathOperator::AssertGreaterThan(o, 0.0, "ln");
+					return std::log(o);
+				});
+				AddUnaryOperator("log2", [](auto o) {
+					MathOperator::AssertNotInfinity(o, "log2");
+					MathOperator::AssertGreaterThan(o, 0.0, "log2");
+					return std::log2(o);
+				});
+				AddUnaryOperator("log10", [](auto o) {
+					MathOperator::AssertNotInfinity(o, "log10");
+					MathOperator::AssertGreaterThan(o, 0.0, "log10");
+					return std::log10(o);
+				});
+			}
+
+			template <class Func>
+			consteval void AddTrig(std::string_view regGlyph, std::string_view revGlyph, Func) {
+				AddOperator(regGlyph, OT::Unary, [](OperandList operands, OpInfo const& self) {
+					MathOperator::AssertNotInfinity(operands[0], self.Glyph());
+					return Func{}(operands[0]);
+				});
+				AddOperator(revGlyph, OT::Unary, [](OperandList operands, OpInfo const& self) {
+					MathOperator::AssertNotInfinity(operands[0], self.Glyph());
+					return 1.0 / Func{}(operands[0]);
+				});
+			}
+
+			template <class Func>
+			consteval void AddArcTrig(std::string_view glyph, Func) {
+				AddOperator(glyph, OT::Unary, [](OperandList operands, OpInfo const& self) {
+					MathOperator::AssertInRange(operands[0], -1.0, 1.0, self.Glyph());
+					return Func{}(operands[0]);
+				});
+			}
+
+			consteval void AddTrigOperators() {
+				AddTrig("sin", "csc", [](double o) { return std::sin(o); });
+				AddTrig("cos", "sec", [](double o) { return std::cos(o); });
+				AddTrig("tan", "cot", [](double o) { return std::tan(o); });
+
+				AddTrig("sinh", "csch", [](double o) { return std::sinh(o); });
+				AddTrig("cosh", "sech", [](double o) { return std::cosh(o); });
+				AddTrig("tanh", "coth", [](double o) { return std::tanh(o); });
+
+				AddArcTrig("arcsin", [](double o) { return std::asin(o); });
+				AddArcTrig("arccos", [](double o) { return std::acos(o); });
+				AddArcTrig("arctan", [](double o) { return std::atan(o); });
+
+				AddArcTrig("arcsinh", [](double o) { return std::asinh(o); });
+				AddArcTrig("arccosh", [](double o) { return std::acosh(o); });
+				AddArcTrig("arctanh", [](double o) { return std::atanh(o); });
+			}
+
+			consteval void AddRatioConvOp(std::string_view fromGlyph, std::string_view toGlyph, 
+				double ratio) 
+			{
+				AddOperator(std::string{fromGlyph} + "_to_" + std::string{toGlyph}, OT::Unary,
+					[](OperandList operands, OpInfo const& self) { return operands[0] * self.Param; },
+					ratio);
+				AddOperator(std::string{toGlyph} + "_to_" + std::string{fromGlyph}, OT::Unary,
+					[](OperandList operands, OpInfo const& self) { return operands[0] / self.Param; },
+					ratio);
+			}
+
+			// These will eventually be depricated, and be replaced by the new unit system,
+			// but that is not happening any time soon.
+			consteval void AddConversionOperators() {
+				// I got these numbers from the windows shitty calculator.
+
+				// Length:
+				AddRatioConvOp("m", "ft", 3.28084);
+				AddRatioConvOp("ft", "in", 12.0);
+				AddRatioConvOp("m", "in", 39.37008);
+				AddRatioConvOp("lb", "kg", 2.204623);
+
+				// Temperature:
+				AddUnaryOperator("cel_to_fah", [](auto n) { return  n * 1.8 + 32.0; });
+				AddUnaryOperator("cel_to_kel", [](auto n) { return  n + 273.15; });
+				AddUnaryOperator("fah_to_cel", [](auto n) { return (n - 32.0) / 1.8; });
+				AddUnaryOperator("fah_to_kel", [](auto n) { return (n + 459.67) / 1.8; });
+				AddUnaryOperator("kel_to_cel", [](auto n) { return  n - 273.15; });
+				AddUnaryOperator("kel_to_fah", [](auto n) { return n * 1.8 - 459.67; });
+
+				// Energy:
+				AddRatioConvOp("ev", "j", 1.6e-19);
+				AddRatioConvOp("cal", "j", 4.184);
+				AddRatioConvOp("btu", "kj", 1.055056);
+				AddRatioConvOp("btu", "j", 1.055056e3);
+
+				// Time:
+				constexpr std::array names{"year", "month", "day", "hour", "min", "sec"};
+				constexpr std::array ratios{413.0 /*does not matter*/, 12.0, 30.0, 24.0, 60.0, 60.0};
+				for (size_t i{}; i < names.size() - 1; ++i) {
+					auto mulAcc{1.0};
+					for (auto j{i + 1}; j < names.size(); ++j) {
+						mulAcc *= ratios[j];
+						AddRatioConvOp(names[i], names[j], mulAcc);
+					}
+				}
+
+				// Angles:
+				AddUnaryOperator("rtod", [](auto o) { return o * 180.0 / std::numbers::pi; });
+				AddUnaryOperator("dtor", [](auto o) { return o * std::numbers::pi / 180.0; });
+			}
+
+		private:
+			Table m_Table{};
+		};
 	}
 
-	void MathOperator::Initialize() {
-		ARCALC_DA(!IsInitialized(), "Double initialization of MathOperator");
-		AddBasicOperators();
-		AddTrigOperators();
-		AddConversionOperators();
+	using OpInfo = Secret::MathOperatorTable::OpInfo;
+
+	constexpr auto OperatorTable{Secret::MathOperatorTable::Build()};
+	constexpr std::span<OpInfo const> Operators{OperatorTable.Ops.data(), OperatorTable.Count};
+
+	// Returns nullptr for invalid operators.
+	constexpr OpInfo const* FindOperator(std::string_view op) {
+		auto const it{range::lower_bound(Operators, op, {}, &OpInfo::Glyph)};
+		return it != Operators.end() && it->Glyph() == op ? &*it : nullptr;
 	}
 
 	bool MathOperator::IsValid(std::string_view op) {
-		return s_Operators.contains(std::string{op});
+		return FindOperator(op) != nullptr;
 	}
 
 	bool MathOperator::IsUnary(std::string_view op) {
@@ -47,19 +333,22 @@ namespace ArCalc {
 	double MathOperator::EvalBinary(std::string_view op, double lhs, double rhs) {
 		ARCALC_DA(IsValid(op), "MathOperator::EvalBinary on invalid operator: [{}]", op);
 		ARCALC_DA(IsBinary(op), "MathOperator::EvalBinary on non-binary operator: [{}]", op);
-		return s_Operators.at(std::string{op}).Func({lhs, rhs});
+		auto const& info{*FindOperator(op)};
+		return info.Func(std::array{lhs, rhs}, info);
 	}
 
 	double MathOperator::EvalUnary(std::string_view op, double operand) {
 		ARCALC_DA(IsValid(op), "MathOperator::EvalUnary invalid operator: [{}]", op);
 		ARCALC_DA(IsUnary(op), "MathOperator::EvalUnary on non-unary operator: [{}]", op);
-		return s_Operators.at(std::string{op}).Func({operand});
+		auto const& info{*FindOperator(op)};
+		return info.Func({&operand, 1U}, info);
 	}
 
-	double MathOperator::EvalVariadic(std::string_view op, std::vector<double> const& operands) {
+	double MathOperator::EvalVariadic(std::string_view op, std::span<double const> operands) {
 		ARCALC_DA(IsValid(op), "MathOperator::EvalVariadic invalid operator: [{}]", op);
 		ARCALC_DA(IsVariadic(op), "MathOperator::EvalVariadic on non-variadic operator: [{}]", op);
-		return s_Operators.at(std::string{op}).Func(operands);
+		auto const& info{*FindOperator(op)};
+		return info.Func(operands, info);
 	}
 
 #ifdef NDEBUG
@@ -69,186 +358,7 @@ namespace ArCalc {
 #endif
 	{
 		ARCALC_DA(IsValid(op), "MathOperator::{} invalid operator: {}", funcName, op);
-		return s_Operators.at(std::string{op}).Type & type;
-	}
-
-	void MathOperator::AddOperator(std::string const& glyph, OT type,
-		std::function<double(std::vector<double>const&)>&& func) 
-	{
-		s_Operators.insert({glyph,{type, std::move(func)}});
-	}
-
-	void MathOperator::AddUnaryOperator(std::string const& glyph, std::function<double(double)>&& func) {
-		AddOperator(glyph, OT::Unary, [func = std::move(func)](auto const& operands) {
-			return func(operands[0]);
-		});
-	}
-
-	void MathOperator::AddBinaryOperator(std::string const& glyph, 
-		std::function<double(double, double)>&& func) 
-	{
-		AddOperator(glyph, OT::Binary, [func = std::move(func)](auto const& operands) {
-			return func(operands[0], operands[1]);
-		});
-	}
-
-	void MathOperator::AddTernaryOperator(std::string const& glyph,
-		std::function<double(double, double, double)>&& func) 
-	{
-		AddOperator(glyph, OT::Ternary, [func = std::move(func)](auto const& operands) {
-			return func(operands[0], operands[1], operands[2]);
-		});
-	}
-
-	void MathOperator::AddVariadicOperator(std::string const& glyph,
-		std::function<double(std::vector<double> const&)>&& func) 
-	{
-		AddOperator(glyph, OT::Variadic, std::move(func));
-	}
-
-
-	void MathOperator::AddBasicOperators() {
-		// Arithmatic
-		AddBinaryOperator("+", std::plus<>{});
-		AddBinaryOperator("-", std::minus<>{});
-		AddBinaryOperator("*", [](auto l, auto r) { return l * r; });
-		AddBinaryOperator("/", [](auto l, auto r) { return l / r; });
-		AddBinaryOperator("mod", [](auto l, auto r) {
-			if (l < 0.0) {
-				throw MathError{"Modulus operator with lhs [{}] (negative)"};
-			} else if (std::fmod(l, 1.0) > 0.000001) {
-				throw MathError{"Modulus operator with lhs [{}] (non-integer)"};
-			}
-
-			if (r < 0.0) {
-				throw MathError{"Modulus operator with rhs [{}] (negative)"};
-			} else if (std::fmod(r, 1.0) > 0.000001) {
-				throw MathError{"Modulus operator with rhs [{}] (non-integer)"};
-			}
-			return static_cast<double>(static_cast<size_t>(l) % static_cast<size_t>(r)); 
-		});
-
-		// Relational
-		AddBinaryOperator("<", std::less          <>{});
-		AddBinaryOperator("<=", std::less_equal   <>{});
-		AddBinaryOperator("==", std::equal_to     <>{});
-		AddBinaryOperator("!=", std::not_equal_to <>{});
-		AddBinaryOperator(">=", std::greater_equal<>{});
-		AddBinaryOperator(">", std::greater       <>{});
-
-		// Logical
-		AddBinaryOperator("&&", [](auto l, auto r) { return l && r ? 1.0 : 0.0; });
-		AddBinaryOperator("||", [](auto l, auto r) { return l || r ? 1.0 : 0.0; });
-		AddBinaryOperator("^^", [](auto l, auto r) { return l && !r || r && !l ? 1.0 : 0.0; });
-		AddUnaryOperator("!",   [](auto o        ) { return std::abs(o) < 0.000001; });
-
-		// Utils
-		AddBinaryOperator("max", [](auto l, auto r) { return std::max(l, r); });
-		AddBinaryOperator("min", [](auto l, auto r) { return std::min(l, r); });
-		AddBinaryOperator("gcd", [](auto l, auto r) {
-			if (l < 0.0) {
-				throw MathError{"Operator gcd with lhs [{}] (negative)"};
-			} else if (std::fmod(l, 1.0) > 0.000001) {
-				throw MathError{"Operator gcd with lhs [{}] (non-integer)"};
-			}
-
-			if (r < 0.0) {
-				throw MathError{"Operator gcd with rhs [{}] (negative)"};
-			} else if (std::fmod(r, 1.0) > 0.000001) {
-				throw MathError{"Operator gcd with rhs [{}] (non-integer)"};
-			}
-
-			return static_cast<double>(std::gcd(static_cast<size_t>(l), static_cast<size_t>(r)));
-		});
-
-		AddVariadicOperator("sum", [](auto const& operands) {
-			return std::accumulate(operands.begin(), operands.end(), 0.0);
-		});
-
-		AddVariadicOperator("mul", [](auto const& operands) {
-			return std::accumulate(operands.begin(), operands.end(), 1.0, std::multiplies<>{});
-		});
-
-		// Unary
-		AddUnaryOperator("negate", [](auto o) { return -o; });
-		AddUnaryOperator("abs",    [](auto o) { return std::abs(o); });
-		AddUnaryOperator("floor",  [](auto o) { return std::floor(o); });
-		AddUnaryOperator("ceil",   [](auto o) { return std::ceil(o); });
-		AddUnaryOperator("round",  [](auto o) { return std::round(o); });
-		AddUnaryOperator("sign",   [](auto o) { return (o > 0.0) ? +1.0 : (o < 0.0) ? -1.0 : 0.0; });
-		AddUnaryOperator("sqrt", [](auto o) {
-			AssertNotInfinity(o, "sqrt");
-			AssertGreaterThan(o, 0, "sqrt");
-			return std::sqrt(o); 
-		});
-
-		// Probability
-		AddUnaryOperator("fac", &FloatFactorio);
-		AddBinaryOperator("perm", [](auto l, auto r) {
-			return FloatFactorio(l) / FloatFactorio(l - r);
-		});
-		AddBinaryOperator("choose", [](auto l, auto r) {
-			return FloatFactorio(l) / (FloatFactorio(r) * FloatFactorio(l - r));
-		});
-
-		// Exponential
-		AddBinaryOperator("^", [](auto l, auto r) {
-			return std::pow(l, r);
-		});
-		AddUnaryOperator("exp", [](auto o) {
-			return std::pow(std::numbers::e, o);
-		});
-		AddUnaryOperator("ln", [](auto o) {
-			AssertNotInfinity(o, "ln");
-			AssertGreaterThan(o, 0.0, "ln");
-			return std::log(o);
-		});
-		AddUnaryOperator("log2", [](auto o) {
-			AssertNotInfinity(o, "log2");
-			AssertGreaterThan(o, 0.0, "log2");
-			return std::log2(o);
-		});
-		AddUnaryOperator("log10", [](auto o) {
-			AssertNotInfinity(o, "log10");
-			AssertGreaterThan(o, 0.0, "log10");
-			return std::log10(o);
-		});
-	}
-
-	void MathOperator::AddTrigOperators() {
-		auto const addTrig = [&](auto regGlyph, auto revGlyph, auto func) {
-			AddUnaryOperator(regGlyph, [=](auto o) {
-				AssertNotInfinity(o, regGlyph);
-				return func(o);
-			});
-			AddUnaryOperator(revGlyph, [=](auto o) {
-				AssertNotInfinity(o, revGlyph);
-				return 1.0 / func(o);
-			});
-		};
-
-		auto addArcTrig = [&](auto glyph, auto func) {
-			AddUnaryOperator(glyph, [=](auto o) {
-				AssertInRange(o, -1.0, 1.0, glyph);
-				return func(o);
-			});
-		};
-
-		addTrig("sin", "csc", [](auto o) { return std::sin(o); });
-		addTrig("cos", "sec", [](auto o) { return std::cos(o); });
-		addTrig("tan", "cot", [](auto o) { return std::tan(o); });
-
-		addTrig("sinh", "csch", [](auto o) { return std::sinh(o); });
-		addTrig("cosh", "sech", [](auto o) { return std::cosh(o); });
-		addTrig("tanh", "coth", [](auto o) { return std::tanh(o); });
-
-		addArcTrig("arcsin", [](auto o) { return std::asin(o); });
-		addArcTrig("arccos", [](auto o) { return std::acos(o); });
-		addArcTrig("arctan", [](auto o) { return std::atan(o); });
-
-		addArcTrig("arcsinh", [](auto o) { return std::asinh(o); });
-		addArcTrig("arccosh", [](auto o) { return std::acosh(o); });
-		addArcTrig("arctanh", [](auto o) { return std::atanh(o); });
+		return FindOperator(op)->Type & type;
 	}
 
 	double MathOperator::FloatFactorio(double n) {
@@ -262,54 +372,6 @@ namespace ArCalc {
 		return static_cast<double>(res);
 	}
 
-	// These will eventually be depricated, and be replaced by the new unit system,
-	// but that is not happening any time soon.
-	void MathOperator::AddConversionOperators() {
-		auto const addRatioConvOp = [](auto fromGlyph, auto toGlyph, auto ratio) {
-			AddUnaryOperator(std::string{fromGlyph} + "_to_" + toGlyph,
-				[=](auto n) { return n * ratio; });
-			AddUnaryOperator(std::string{toGlyph} + "_to_" + fromGlyph,
-				[=](auto n) { return n / ratio; });
-		};
-
-		// I got these numbers from the windows shitty calculator.
-
-		// Length:
-		addRatioConvOp("m", "ft", 3.28084);
-		addRatioConvOp("ft", "in", 12.0);
-		addRatioConvOp("m", "in", 39.37008);
-		addRatioConvOp("lb", "kg", 2.204623);
-
-		// Temperature:
-		AddUnaryOperator("cel_to_fah", [](auto n) { return  n * 1.8 + 32.0; });
-		AddUnaryOperator("cel_to_kel", [](auto n) { return  n + 273.15; });
-		AddUnaryOperator("fah_to_cel", [](auto n) { return (n - 32.0) / 1.8; });
-		AddUnaryOperator("fah_to_kel", [](auto n) { return (n + 459.67) / 1.8; });
-		AddUnaryOperator("kel_to_cel", [](auto n) { return  n - 273.15; });
-		AddUnaryOperator("kel_to_fah", [](auto n) { return n * 1.8 - 459.67; });
-
-		// Energy:
-		addRatioConvOp("ev", "j", 1.6e-19);
-		addRatioConvOp("cal", "j", 4.184);
-		addRatioConvOp("btu", "kj", 1.055056);
-		addRatioConvOp("btu", "j", 1.055056e3);
-
-		// Time:
-		constexpr std::array names{"year", "month", "day", "hour", "min", "sec"};
-		constexpr std::array ratios{413.0 /*does not matter*/, 12.0, 30.0, 24.0, 60.0, 60.0};
-		for (auto const i : view::iota(0U, names.size() - 1)) {
-			auto mulAcc{1.0};
-			for (auto const j : view::iota(i + 1, names.size())) {
-				mulAcc *= ratios[j];
-				addRatioConvOp(names[i], names[j], mulAcc);
-			}
-		}
-
-		// Angles:
-		AddUnaryOperator("rtod", [](auto o) { return o * 180.0 / std::numbers::pi; });
-		AddUnaryOperator("dtor", [](auto o) { return o * std::numbers::pi / 180.0; });
-	}
-
 	void MathOperator::AssertInRange(double n, double min, double max, std::string_view funcName) {
 		if (n < min || n > max) {
 			throw MathError{
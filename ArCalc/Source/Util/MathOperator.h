@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core.h"
+#include "Util.h"
 
 namespace ArCalc {
 	enum class MathOperatorType : size_t;
@@ -13,21 +14,16 @@ namespace ArCalc {
 		return static_cast<size_t>(lhs) | static_cast<size_t>(rhs);
 	}
 
+	namespace Secret {
+		class MathOperatorTable;
+	}
+
 	class MathOperator {
 	private:
 		using OT = MathOperatorType;
 
-		struct OpInfo {
-			OT Type;
-			std::function<double(std::vector<double> const&)> Func;
-		};
-
-		// This is a trick to initialize the class without having to manually call Initialize.
-		static MathOperator const s_InitializationInstance;
-		inline static std::unordered_map<std::string, OpInfo> s_Operators{};
-
-	private:
-		MathOperator();
+	public:
+		MathOperator() = delete;
 
 	public:
 		static bool IsValid(std::string_view op);
@@ -37,26 +33,13 @@ namespace ArCalc {
 
 		static double EvalBinary(std::string_view op, double lhs, double rhs);
 		static double EvalUnary(std::string_view op, double operand);
-		static double EvalVariadic(std::string_view op, std::vector<double> const& operands);
+		static double EvalVariadic(std::string_view op, std::span<double const> operands);
 
 	private:
-		static bool CheckHelper(std::string_view op, OT bit, std::string_view funcName);
-		static bool IsInitialized();
-		static void Initialize();
-		static void AddOperator(std::string const& glyph, OT type, 
-			std::function<double(std::vector<double> const&)>&& func);
-		static void AddUnaryOperator(std::string const& glyph, 
-			std::function<double(double)>&& func);
-		static void AddBinaryOperator(std::string const& glyph, 
-			std::function<double(double, double)>&& func);
-		static void AddTernaryOperator(std::string const& glyph, 
-			std::function<double(double, double, double)>&& func);
-		static void AddVariadicOperator(std::string const& glyph, 
-			std::function<double(std::vector<double> const&)>&& func);
+		// Builds the operator table at compile time, and its operators use the assertions below.
+		friend class Secret::MathOperatorTable;
 
-		static void AddBasicOperators();
-		static void AddTrigOperators();
-		static void AddConversionOperators();
+		static bool CheckHelper(std::string_view op, OT bit, std::string_view funcName);
 
 		static double FloatFactorio(double n);
 		static void AssertNotInfinity(double n, std::string_view funcName);
@@ -0,0 +1,21 @@
+#include "NumberFormatter.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	std::string_view NumberFormatter::Format(double value, Buffer& buffer) {
+		auto const [pEnd, errorCode] {std::to_chars(buffer.data(), buffer.data() + buffer.size(), value)};
+		ARCALC_DA(errorCode == std::errc{}, "Formatting [{}] did not fit in the buffer", value);
+		return {buffer.data(), static_cast<size_t>(pEnd - buffer.data())};
+	}
+
+	void NumberFormatter::Write(std::ostream& os, double value) {
+		Buffer buffer;
+		auto const str{Format(value, buffer)};
+		os.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	void NumberFormatter::Append(std::string& str, double value) {
+		Buffer buffer;
+		str.append(Format(value, buffer));
+	}
+}
\ No newline at end of file
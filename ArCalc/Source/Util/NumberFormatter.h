@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Writes numbers the shortest way that still reads back as the exact same double (the 
+	/// same text as std::format("{}", value)), into a buffer provided by the caller, so no 
+	/// formatting machinery or allocations are involved.
+	class NumberFormatter {
+	public:
+		NumberFormatter() = delete;
+
+	public:
+		// Fits any double, the longest being like "-2.2250738585072014e-308".
+		constexpr static size_t sc_MaxSize{32U};
+		using Buffer = std::array<char, sc_MaxSize>;
+
+		// Returns the part of [buffer] that was written to.
+		static std::string_view Format(double value, Buffer& buffer);
+
+		static void Write(std::ostream& os, double value);
+		static void Append(std::string& str, double value);
+	};
+}
\ No newline at end of file
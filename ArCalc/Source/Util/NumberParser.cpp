@@ -9,6 +9,18 @@ namespace ArCalc {
 	constexpr size_t BinaryBit{1U << 28U};
 	constexpr size_t AllBits{NormBit | HexBit | OctalBit | BinaryBit};
 
+	// Powers of ten that are exactly representable as doubles.
+	constexpr std::array<double, 23U> ExactPowersOf10{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+
+	// Every integer up to this one is exactly representable as a double.
+	constexpr std::uint64_t MaxExactMantissa{1ULL << 53U};
+
+	// Exponent digits past this make the number zero or infinite anyway.
+	constexpr std::int64_t MaxExpAcc{100'000};
+
 	enum class NumberParser::St : size_t {
 		Default      = 0U,
 		ParsingBegin = 1U,
@@ -33,54 +45,7 @@ namespace ArCalc {
 		return static_cast<size_t>(st) & HexBit;
 	}
 
-	NumberParser::NumberParser() : m_CurrState{St::ParsingBegin} {
-	}
-
-	void NumberParser::AddChar(char c) {
-		m_StringAcc.push_back(c);
-	}
-
-	NumberParserResult NumberParser::Parse(char c) {
-		switch (auto const state{GetState()}; state) {
-		case St::ParsingBegin: 
-			AddChar(c);
-			SetState(St::Default);
-			return {.IsDone{false}};
-		case St::Default:
-			if (IsHexDigit(c) || IsBaseSpec(c) || c == '.' || c == '\'' || c == '-') {
-				AddChar(c);
-				return {.IsDone{false}};
-			} else if (std::isalpha(c)) { // Alphabetic but not valid hex or base spec.
-				throw ParseError{
-					"Found invalid character [{}] while parsing number [{}]",
-					c, GetAcc(),
-				};
-			} else { // Symbol or whitespace.
-				SetState(St::ParsingBegin);
-				NumberParserResult res{
-					.IsDone{true},
-					.Value{ValidateAndFixParsedNumber()},
-				};
-				ResetAcc();
-				return res;
-			}
-
-			break;
-		default:
-			ARCALC_UNREACHABLE_CODE();
-		};
-
-		ARCALC_UNREACHABLE_CODE(); // Each switch hand must exit at the end.
-	}
-
-	void NumberParser::Reset() {
-		ResetAcc();
-		SetState(St::ParsingBegin);
-	}
-
-	double NumberParser::ValidateAndFixParsedNumber() {
-		auto numStr = std::string_view{GetAcc()}; 
-		
+	double NumberParser::Parse(std::string_view numStr) const {
 		auto const bMinus = [&]{
 			auto const cond{numStr.front() == '-'};
 			numStr = numStr.substr(cond ? 1 : 0);
@@ -93,13 +58,26 @@ namespace ArCalc {
 		auto fracDigitCount = size_t{};
 
 		auto bNegativeExp{false};
-		auto expAcc = std::make_signed_t<size_t>{};
+		auto expAcc = std::int64_t{};
 
-		if (auto const c0{numStr.front()}; IsNumberDigit(c0)) {
+		// The digits are also accumulated exactly as long as they fit, so the value of
+		// most literals is rounded once at the end, instead of once per digit.
+		auto mantissa = std::uint64_t{};
+		auto bMantissaOverflow{false};
+		auto const addDigit = [&](size_t digit) {
+			myNum = base * myNum + digit;
+			if (bMantissaOverflow || mantissa > (std::numeric_limits<std::uint64_t>::max() - digit) / base) {
+				bMantissaOverflow = true;
+			} else {
+				mantissa = base * mantissa + digit;
+			}
+		};
+
+		if (auto const c0{numStr.front()}; Str::IsDigit(c0)) {
 			if (c0 == '0') {
 				st = St::LeadingZero;
 			} else {
-				myNum = 1.0 * c0 - '0';
+				addDigit(c0 - '0');
 			}
 		} else if (c0 == '.') {
 			st = St::FracPart;
@@ -113,23 +91,21 @@ namespace ArCalc {
 			auto const c{*it};
 			switch (st) {
 			case St::LeadingZero:
-				if (IsNumberDigit(c)) {
-					myNum = 10.0 * myNum + (1.0 * c - '0');
-				} else switch (c) {
-				case 'b': case 'B': base = 2; break;
-				case 'o': case 'O': base = 8; break;
-				case 'x': case 'X': base = 16; break;
-				}
-				
 				st = St::Default;
-				break;
+				switch (c) {
+				case 'b': case 'B': base = 2; continue;
+				case 'o': case 'O': base = 8; continue;
+				case 'x': case 'X': base = 16; continue;
+				}
+
+				// Not a base specifier, so it is handled like in any other decimal number,
+				// otherwise the floating point in "0.5" would be dropped.
+				[[fallthrough]];
 			case St::Default: // Parsing decimal number
-				if (IsNumberDigit(c)) {
-					myNum = base * myNum + (1.0 * c - '0');
-				} else if (base == 16 && IsHexDigit(c)) {
-					myNum = base * myNum 
-						+ (1.0 * c - (std::tolower(c) == c ? 'a' : 'A')) 
-						+ 10.0;
+				if (Str::IsDigit(c)) {
+					addDigit(c - '0');
+				} else if (base == 16 && Str::IsHexDigit(c)) {
+					addDigit(c - (c >= 'a' ? 'a' : 'A') + 10);
 				} else switch (c) {
 				case '\'': 
 					if (*std::prev(it) == '\'') {
@@ -151,7 +127,12 @@ namespace ArCalc {
 					st = St::FracPart;
 					break;
 				case 'e':
-					if (base == 10) {
+					if (*std::prev(it) == '\'') {
+						throw ParseError{
+							"Found `'` just before the `e` while parsing number [{}]",
+							numStr,
+						};
+					} else if (base == 10) {
 						st = St::ExpPart;
 						break;
 					} 
@@ -166,13 +147,11 @@ namespace ArCalc {
 
 				break;
 			case St::FracPart:
-				if (IsNumberDigit(c)) {
-					myNum = base * myNum + (1.0 * c - '0');
+				if (Str::IsDigit(c)) {
+					addDigit(c - '0');
 					fracDigitCount += 1;
-				} else if (base == 16 && IsHexDigit(c)) {
-					myNum = base * myNum 
-						+ (1.0 * c - (std::tolower(c) == c ? 'a' : 'A')) 
-						+ 10.0;
+				} else if (base == 16 && Str::IsHexDigit(c)) {
+					addDigit(c - (c >= 'a' ? 'a' : 'A') + 10);
 					fracDigitCount += 1;
 				} else switch (c) {
 				case '\'': 
@@ -196,7 +175,12 @@ namespace ArCalc {
 						numStr,
 					};
 				case 'e':
-					if (base == 10) {
+					if (*std::prev(it) == '\'') {
+						throw ParseError{
+							"Found `'` just before the `e` while parsing number [{}]",
+							numStr,
+						};
+					} else if (base == 10) {
 						st = St::ExpPart;
 						break;
 					}
@@ -211,8 +195,8 @@ namespace ArCalc {
 
 				break;
 			case St::ExpPart:
-				if (IsNumberDigit(c)) {
-					expAcc = expAcc * 10 + (static_cast<size_t>(c) - '0');
+				if (Str::IsDigit(c)) {
+					expAcc = std::min(expAcc * 10 + (c - '0'), MaxExpAcc);
 				} else switch (c) {
 				case '-': 
 					if (*std::prev(it) == 'e') {
@@ -225,9 +209,9 @@ namespace ArCalc {
 					// Ignore it.
 					break;
 				case '\'':
-					if (auto const prev{*std::prev(it)}; prev == 'e') {
+					if (auto const prev{*std::prev(it)}; prev == 'e' || prev == '-') {
 						throw ParseError{
-							"Found a `'` just after the `e` while parsing number [{}]",
+							"Found a `'` just after the `{}` while parsing number [{}]", prev,
 							numStr,
 						};
 					} else if (prev == '\'') {
@@ -251,8 +235,62 @@ namespace ArCalc {
 			}
 		}
 
-		myNum /= std::pow(base, fracDigitCount);
-		myNum *= std::pow(10, bNegativeExp ?  -expAcc : expAcc);
-		return bMinus ? -myNum : myNum;
+		// Checked here, because the number used to be validated one character at a time.
+		if (numStr.back() == '\'') {
+			throw ParseError{"Found `'` at the end of number [{}]", numStr};
+		} else if (st == St::ExpPart && !Str::IsDigit(numStr.back())) {
+			throw ParseError{"Found no digits in the exponent of number [{}]", numStr};
+		}
+
+		auto const exp10{(bNegativeExp ? -expAcc : expAcc) - static_cast<std::int64_t>(fracDigitCount)};
+		auto const res = [&] {
+			if (base != 10) {
+				// Scaling by a power of two is exact, so converting the mantissa is the
+				// only rounding.
+				return bMantissaOverflow
+					? myNum / std::pow(base, fracDigitCount)
+					: std::ldexp(static_cast<double>(mantissa), 
+						-static_cast<int>(fracDigitCount * std::countr_zero(base)));
+			} else if (!bMantissaOverflow && mantissa <= MaxExactMantissa
+				&& std::abs(exp10) < std::ssize(ExactPowersOf10)) 
+			{
+				// Both operands are exact, so the one IEEE operation is correctly rounded.
+				return exp10 < 0
+					? static_cast<double>(mantissa) / ExactPowersOf10[-exp10]
+					: static_cast<double>(mantissa) * ExactPowersOf10[exp10];
+			} else {
+				return ParseDecimalSlow(numStr, exp10);
+			}
+		}(/*)(*/);
+
+		return bMinus ? -res : res;
+	}
+
+	double NumberParser::ParseDecimalSlow(std::string_view numStr, std::int64_t exp10) {
+		// Only long mantissas and large exponents get here, which std::from_chars rounds
+		// correctly once the separators are gone.
+		std::string digits{};
+		digits.reserve(numStr.size());
+		range::copy_if(numStr, std::back_inserter(digits), [](char c) { return c != '\''; });
+
+		auto res = double{};
+		auto const [ptr, ec] {std::from_chars(digits.data(), digits.data() + digits.size(), res)};
+		if (ec == std::errc::result_out_of_range) {
+			// Values too small even for a denormal round to zero, like the result of any other 
+			// operation would; only the ones too large for a double are an error. Which one it
+			// is shows in the power of ten of the first significant digit.
+			auto const mantissa{std::string_view{digits}.substr(0U, digits.find('e'))};
+			auto const significant{
+				mantissa.substr(std::min(mantissa.find_first_of("123456789"), mantissa.size()))
+			};
+			if (exp10 + range::count_if(significant, Str::IsDigit) > 0) {
+				throw ParseError{"Number [{}] is out of the range of a double", numStr};
+			}
+			return 0.0;
+		}
+
+		ARCALC_DA(ec == std::errc{} && ptr == digits.data() + digits.size(), 
+			"Validated number [{}] was rejected by std::from_chars", numStr);
+		return res;
 	}
 }
@@ -0,0 +1,121 @@
+#include "OutputSink.h"
+#include "Exception/ArCalcException.h"
+
+namespace ArCalc {
+	OutputSink::OutputSink(std::ostream& target, bool bAsync) 
+		: m_pTarget{&target}, m_Chunk(sc_ChunkSize)
+	{
+		setp(m_Chunk.data(), m_Chunk.data() + m_Chunk.size());
+
+		if (bAsync && std::thread::hardware_concurrency() > 1U) {
+			m_Pending.resize(sc_ChunkSize);
+			m_Writer = std::jthread{[this](std::stop_token stopToken) { RunWriter(stopToken); }};
+		}
+	}
+
+	OutputSink::~OutputSink() {
+		try { Flush(); } 
+		catch (std::exception const&) {
+			// Only reachable when the target fails, and there is nowhere to report it to.
+		}
+
+		if (m_Writer.joinable()) {
+			m_Writer.request_stop();
+			m_Writer.join();
+		}
+	}
+
+	void OutputSink::Flush() {
+		HandOver();
+
+		if (m_Writer.joinable()) {
+			std::unique_lock lock{m_Mutex};
+			m_CV.wait(lock, [&] { return m_PendingSize == 0U; });
+			RethrowWriterError();
+		}
+
+		if (!m_pTarget->flush()) {
+			throw IOError{"Could not flush the output"};
+		}
+	}
+
+	OutputSink::int_type OutputSink::overflow(int_type c) {
+		try { HandOver(); } 
+		catch (std::exception const&) {
+			return traits_type::eof(); // Sets badbit on the wrapping stream.
+		}
+
+		if (!traits_type::eq_int_type(c, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	int OutputSink::sync() {
+		try { Flush(); } 
+		catch (std::exception const&) {
+			return -1;
+		}
+		return 0;
+	}
+
+	void OutputSink::HandOver() {
+		auto const size{static_cast<size_t>(pptr() - pbase())};
+		if (size == 0U) {
+			return;
+		}
+
+		if (!m_Writer.joinable()) {
+			Write({m_Chunk.data(), size});
+		} else {
+			// Waits for the previous chunk, then swaps buffers so this one fills the other.
+			std::unique_lock lock{m_Mutex};
+			m_CV.wait(lock, [&] { return m_PendingSize == 0U; });
+
+			RethrowWriterError();
+			std::swap(m_Chunk, m_Pending);
+			m_PendingSize = size;
+			m_CV.notify_all();
+		}
+
+		setp(m_Chunk.data(), m_Chunk.data() + m_Chunk.size());
+	}
+
+	void OutputSink::Write(std::span<char const> chunk) {
+		if (!m_pTarget->write(chunk.data(), static_cast<std::streamsize>(chunk.size()))) {
+			throw IOError{"Could not write [{}] bytes of output", chunk.size()};
+		}
+	}
+
+	void OutputSink::RunWriter(std::stop_token stopToken) {
+		for (;;) {
+			std::unique_lock lock{m_Mutex};
+			m_CV.wait(lock, stopToken, [&] { return m_PendingSize != 0U; });
+			if (m_PendingSize == 0U) { // Stopped.
+				return;
+			}
+
+			auto const size{m_PendingSize};
+			lock.unlock();
+
+			// The buffer is not touched by the other thread until m_PendingSize is 0 again.
+			auto pError = std::exception_ptr{};
+			try { Write({m_Pending.data(), size}); } 
+			catch (...) { pError = std::current_exception(); }
+
+			lock.lock();
+			if (pError && !m_pError) {
+				m_pError = pError;
+			}
+			m_PendingSize = 0U;
+			m_CV.notify_all();
+		}
+	}
+
+	void OutputSink::RethrowWriterError() {
+		if (m_pError) {
+			std::rethrow_exception(std::exchange(m_pError, {}));
+		}
+	}
+}
\ No newline at end of file
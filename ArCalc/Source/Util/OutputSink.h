@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Stream buffer that collects output in large chunks before handing it to another 
+	/// stream, so that printing millions of short results does not turn into millions of 
+	/// tiny writes. Meant to be wrapped in a std::ostream and given to a parser.
+	/// 
+	/// Nothing reaches the target before a flush point: a full chunk, Flush (or flushing the 
+	/// wrapping stream), or destruction. Whoever owns the sink flushes it before the output 
+	/// has to be seen, e.g. before prompting the user or reporting an error.
+	/// 
+	/// With a writer thread, full chunks are written while the next one is being filled.
+	class OutputSink : public std::streambuf {
+	public:
+		OutputSink(OutputSink const&)            = delete;
+		OutputSink(OutputSink&&)                 = delete;
+		OutputSink& operator=(OutputSink const&) = delete;
+		OutputSink& operator=(OutputSink&&)      = delete;
+
+		// [target] has to outlive the sink. There is no writer thread on single-core machines.
+		OutputSink(std::ostream& target, bool bAsync = false);
+
+		// Flushes what is left, but can not report failing to do so; call Flush for that.
+		~OutputSink() override;
+
+	public:
+		// Returns once everything written so far reached the target, which is flushed as well.
+		void Flush();
+
+		constexpr static size_t sc_ChunkSize{64U * 1024U};
+
+	protected:
+		int_type overflow(int_type c) override;
+		int sync() override;
+
+	private:
+		void HandOver();
+		void Write(std::span<char const> chunk);
+		void RunWriter(std::stop_token stopToken);
+		void RethrowWriterError(); // With m_Mutex held.
+
+	private:
+		std::ostream* m_pTarget;
+		std::vector<char> m_Chunk;
+
+		// Only used with a writer thread.
+		std::mutex m_Mutex{};
+		std::condition_variable_any m_CV{};
+		std::vector<char> m_Pending{}; // Being written, when m_PendingSize is not 0.
+		size_t m_PendingSize{};
+		std::exception_ptr m_pError{};
+		std::jthread m_Writer{}; // Last, so it is stopped before the rest is destroyed.
+	};
+}
\ No newline at end of file
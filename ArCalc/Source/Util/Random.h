@@ -4,12 +4,33 @@
 #include "Exception/ArCalcException.h"
 
 namespace ArCalc::Random {
+	using Generator = std::mt19937;
+
 	namespace Secret {
-		inline static std::random_device s_Urbg{};
-		inline static std::mt19937 s_Rng{s_Urbg()};
+		// One generator per thread, so that generating numbers never takes a lock.
+		inline thread_local Generator s_Rng{std::random_device{}()};
+
+		// The generator in use on this thread, see ScopedGenerator.
+		inline thread_local Generator* s_pRng{&s_Rng};
 	}
 
-	constexpr std::mt19937& Engine() { return Secret::s_Rng; }
+	inline Generator& Engine() { return *Secret::s_pRng; }
+
+	/// Makes everything in Random use [rng] on the current thread, until it goes out of
+	/// scope. This is how a session (see ArCalc::Engine) keeps its own random state.
+	class ScopedGenerator {
+	public:
+		ScopedGenerator(Generator& rng) 
+			: m_pPrev{std::exchange(Secret::s_pRng, &rng)} {}
+		ScopedGenerator(ScopedGenerator const&)            = delete;
+		ScopedGenerator(ScopedGenerator&&)                 = delete;
+		ScopedGenerator& operator=(ScopedGenerator const&) = delete;
+		ScopedGenerator& operator=(ScopedGenerator&&)      = delete;
+		~ScopedGenerator() { Secret::s_pRng = m_pPrev; }
+
+	private:
+		Generator* m_pPrev;
+	};
 
 #define ARCALC_DECLARE_RANDOM_INT_FUNC(_funcName, _type) \
 	_type _funcName();                                   \
@@ -30,11 +51,11 @@ namespace ArCalc::Random {
 	ValueType Generic(ValueType min, ValueType max) {
 		ARCALC_DA(min <= max, "Tried to generate a random number with the range reversed");
 		if constexpr (std::is_same_v<ValueType, bool>) {
-			return std::bernoulli_distribution{}(Secret::s_Rng);
+			return std::bernoulli_distribution{}(Engine());
 		} else if constexpr (std::is_integral_v<ValueType>) {
-			return std::uniform_int_distribution{min, max}(Secret::s_Rng);
+			return std::uniform_int_distribution{min, max}(Engine());
 		} else {
-			return std::uniform_real_distribution{min, max}(Secret::s_Rng);
+			return std::uniform_real_distribution{min, max}(Engine());
 		}
 	}
 
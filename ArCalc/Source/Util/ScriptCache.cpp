@@ -0,0 +1,206 @@
+#include "ScriptCache.h"
+#include "Exception/ArCalcException.h"
+#include "BinaryStream.h"
+#include "IO.h"
+
+namespace ArCalc {
+	fs::path ScriptCache::GetDirectory() {
+		return IO::GetSerializationPath() / "Cache";
+	}
+
+	fs::path ScriptCache::GetScriptPath(std::string_view source) {
+		return GetScriptPath(KeyOf(source));
+	}
+
+	fs::path ScriptCache::GetScriptPath(SourceKey key) {
+		return GetEntryPath(key, ".arscript");
+	}
+
+	fs::path ScriptCache::GetCategoryPath(std::string_view text) {
+		return GetEntryPath(KeyOf(text), ".arcat");
+	}
+
+	std::optional<std::vector<ScriptCache::CachedFunction>> ScriptCache::FindScript(std::string_view source) {
+		return FindScript(KeyOf(source));
+	}
+
+	std::optional<std::vector<ScriptCache::CachedFunction>> ScriptCache::FindScript(SourceKey key) {
+		auto const filePath{GetScriptPath(key)};
+		if (auto ec = std::error_code{}; !fs::exists(filePath, ec)) {
+			return {};
+		}
+
+		try {
+			auto const bytes{IO::FileToBytes(filePath)};
+			BinaryReader in{bytes};
+			if (in.ReadBytes(sc_Magic.size()) != sc_Magic || in.ReadU32() != sc_Version
+				|| in.ReadU64() != key.Hash || in.ReadU64() != key.Size)
+			{
+				throw IOError{"Cache entry [{}] does not belong to its source", filePath.string()};
+			}
+
+			auto res = std::vector<CachedFunction>(in.ReadCount(20U));
+			for (auto& func : res) {
+				func.FirstLine   = in.ReadU32();
+				func.LineCount   = in.ReadU32();
+				func.Record      = in.ReadString();
+				func.CalleesHash = in.ReadU64();
+			}
+
+			if (!in.IsAtEnd()) {
+				throw IOError{"Cache entry [{}] has trailing bytes", filePath.string()};
+			}
+
+			MarkUsed(filePath);
+			return res;
+		} catch (IOError const&) {
+			// Entries can't be removed while other processes have them open on some platforms, 
+			// which does not make them any less of a miss.
+			auto ec = std::error_code{};
+			fs::remove(filePath, ec);
+			return {};
+		} catch (fs::filesystem_error const&) {
+			return {};
+		}
+	}
+
+	void ScriptCache::StoreScript(SourceKey key, std::span<CachedFunction const> functions) {
+		std::string bytes{};
+		BinaryWriter out{bytes};
+		out.WriteBytes(sc_Magic);
+		out.WriteU32(sc_Version);
+		out.WriteU64(key.Hash);
+		out.WriteU64(key.Size);
+
+		out.WriteU32(static_cast<std::uint32_t>(functions.size()));
+		for (auto const& func : functions) {
+			out.WriteU32(func.FirstLine);
+			out.WriteU32(func.LineCount);
+			out.WriteString(func.Record);
+			out.WriteU64(func.CalleesHash);
+		}
+
+		fs::create_directories(GetDirectory());
+		TrimIfDue();
+		IO::ReplaceFile(GetScriptPath(key), bytes);
+	}
+
+	std::optional<fs::path> ScriptCache::FindCategory(std::string_view text) {
+		auto filePath{GetCategoryPath(text)};
+		if (auto ec = std::error_code{}; !fs::exists(filePath, ec)) {
+			return {};
+		}
+
+		try {
+			[[maybe_unused]] auto const index{CategoryFile::ReadIndex(filePath)};
+			MarkUsed(filePath);
+			return filePath;
+		} catch (IOError const&) {
+			// Entries can't be removed while other processes have them open on some platforms, 
+			// which does not make them any less of a miss.
+			auto ec = std::error_code{};
+			fs::remove(filePath, ec);
+			return {};
+		} catch (fs::filesystem_error const&) {
+			return {};
+		}
+	}
+
+	void ScriptCache::StoreCategory(std::string_view text, CategoryFile::Index index, 
+		std::string_view records) 
+	{
+		fs::create_directories(GetDirectory());
+		TrimIfDue();
+		CategoryFile::WriteWhole(GetCategoryPath(text), std::move(index), records);
+	}
+
+	void ScriptCache::Trim(std::uint64_t maxSize) {
+		struct Entry {
+			fs::path Path;
+			std::uint64_t Size;
+			fs::file_time_type LastUse;
+		};
+
+		// Other processes may be using the cache too, so entries can vanish at any point.
+		auto const versionTag{GetVersionTag()};
+		auto entries = std::vector<Entry>{};
+		auto totalSize = std::uint64_t{};
+		auto ec = std::error_code{};
+		for (auto const& entry : fs::directory_iterator{GetDirectory()}) {
+			if (entry.path().filename() == sc_TrimStampName) {
+				continue;
+			} else if (entry.path().extension() == ".tmp") {
+				// Being written by IO::ReplaceFile, unless left behind by a crash a while ago.
+				if (auto const lastWrite{entry.last_write_time(ec)}; 
+					!ec && fs::file_time_type::clock::now() - lastWrite > sc_TrimInterval) 
+				{
+					fs::remove(entry.path(), ec);
+				}
+				continue;
+			} else if (!entry.path().stem().string().ends_with(versionTag)) {
+				fs::remove(entry.path(), ec);
+				continue;
+			} else if (CategoryFile::GetUnloadedStubCount(entry.path()) != 0U) {
+				continue; // Converted categories some session still reads functions from.
+			}
+
+			auto const size{entry.file_size(ec)};
+			if (auto const lastUse{entry.last_write_time(ec)}; !ec) {
+				entries.push_back({.Path{entry.path()}, .Size{size}, .LastUse{lastUse}});
+				totalSize += size;
+			}
+		}
+
+		range::sort(entries, range::less{}, &Entry::LastUse);
+		for (auto const& entry : entries) {
+			if (totalSize <= maxSize) {
+				break;
+			} else if (fs::remove(entry.Path, ec)) {
+				totalSize -= entry.Size;
+			}
+		}
+	}
+
+	ScriptCache::SourceKey ScriptCache::KeyOf(std::string_view source) {
+		return {.Hash{Hash(source)}, .Size{source.size()}};
+	}
+
+	std::uint64_t ScriptCache::HashCallees(FunctionManager& funMan, std::string_view funcName) {
+		auto res{sc_HashBasis};
+		for (auto const& callee : funMan.GetReachable(funcName) | view::drop(1)) {
+			std::string record{};
+			BinaryWriter out{record};
+			funMan.SerializeBinary(callee, out);
+			res = Hash(record, res);
+		}
+		return res;
+	}
+
+	fs::path ScriptCache::GetEntryPath(SourceKey key, std::string_view extension) {
+		auto fileName{std::format("{:016x}-{}{}", key.Hash, key.Size, GetVersionTag())};
+		fileName.append(extension);
+		return GetDirectory() / fileName;
+	}
+
+	std::string ScriptCache::GetVersionTag() {
+		return std::format("-v{}.{}", sc_Version, CategoryFile::sc_Version);
+	}
+
+	void ScriptCache::MarkUsed(fs::path const& filePath) {
+		auto ec = std::error_code{};
+		fs::last_write_time(filePath, fs::file_time_type::clock::now(), ec);
+	}
+
+	void ScriptCache::TrimIfDue() {
+		auto const stampPath{GetDirectory() / sc_TrimStampName};
+		auto ec = std::error_code{};
+		if (auto const lastTrim{fs::last_write_time(stampPath, ec)}; 
+			!ec && fs::file_time_type::clock::now() - lastTrim < sc_TrimInterval) 
+		{
+			return;
+		}
+
+		std::ofstream{stampPath, std::ios::trunc};
+		Trim();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Core.h"
+#include "CategoryFile.h"
+#include "FunctionManager.h"
+
+namespace ArCalc {
+	/// Remembers the results of work that only depends on the contents of a file, so running 
+	/// the same script or loading the same text category again can skip it.
+	/// 
+	/// Entries are named after a hash of the source, its size, and the versions of the 
+	/// formats involved, so entries made by other versions are never picked up (and are 
+	/// removed by the next Trim). Entries that fail to read are removed, and treated as if 
+	/// they were never there.
+	/// 
+	/// Every hit updates the write time of its entry, so Trim can evict the ones used least 
+	/// recently once the cache grows past sc_MaxCacheSize. It runs at most once every 
+	/// sc_TrimInterval as new entries are stored, so the cap may be passed by what is stored 
+	/// in between.
+	class ScriptCache {
+	public:
+		// A function definition of a script, that was validated when the entry was made.
+		struct CachedFunction {
+			std::uint32_t FirstLine;
+			std::uint32_t LineCount;   // Including the header.
+			std::string Record;        // Same as in a binary category, tag included.
+			std::uint64_t CalleesHash; // See HashCallees.
+		};
+
+		// Identifies a source by its contents, see Hash.
+		struct SourceKey {
+			std::uint64_t Hash;
+			std::uint64_t Size;
+		};
+
+	public:
+		ScriptCache() = delete;
+
+	public:
+		constexpr static std::string_view sc_Magic{"ArCalcScript"};
+
+		// Must be bumped whenever the parser would validate or store functions differently.
+		constexpr static std::uint32_t sc_Version{2U};
+
+		// Scripts any larger are not looked up before they run, as hashing them first would 
+		// delay their output for too long.
+		constexpr static std::uint64_t sc_MaxScriptSize{16U * 1024U * 1024U};
+
+		constexpr static std::uint64_t sc_HashBasis{14'695'981'039'346'656'037ULL};
+
+		constexpr static std::uint64_t sc_MaxCacheSize{256U * 1024U * 1024U};
+		constexpr static std::chrono::hours sc_TrimInterval{1};
+		constexpr static std::string_view sc_TrimStampName{"LastTrim"};
+
+	public:
+		static fs::path GetDirectory();
+		static fs::path GetScriptPath(std::string_view source);
+		static fs::path GetScriptPath(SourceKey key);
+		static fs::path GetCategoryPath(std::string_view text);
+
+		static std::optional<std::vector<CachedFunction>> FindScript(std::string_view source);
+		static std::optional<std::vector<CachedFunction>> FindScript(SourceKey key);
+		static void StoreScript(SourceKey key, std::span<CachedFunction const> functions);
+
+		// Returns the path of a binary category, holding what the text category [text] does.
+		static std::optional<fs::path> FindCategory(std::string_view text);
+		static void StoreCategory(std::string_view text, CategoryFile::Index index, std::string_view records);
+
+		// Removes the entries of other versions, then the least recently used ones until the 
+		// rest take up at most [maxSize] bytes. Converted categories are kept while functions
+		// loaded from them are not read yet (see CategoryFile::GetUnloadedStubCount).
+		static void Trim(std::uint64_t maxSize = sc_MaxCacheSize);
+
+		static SourceKey KeyOf(std::string_view source);
+
+		// Hashes the records of every function [funcName] can end up calling, which ran when
+		// it was validated. A cached definition is only used while this stays the same, as 
+		// what the script loads (e.g. categories) may have changed since.
+		static std::uint64_t HashCallees(FunctionManager& funMan, std::string_view funcName);
+
+		// Hash(b, Hash(a)) is the same as hashing a and b concatenated, so sources can be 
+		// hashed while they are read.
+		constexpr static std::uint64_t Hash(std::string_view bytes, std::uint64_t seed = sc_HashBasis) {
+			// 64-bit FNV-1a.
+			auto res{seed};
+			for (auto const c : bytes) {
+				res = (res ^ static_cast<unsigned char>(c)) * 1'099'511'628'211ULL;
+			}
+			return res;
+		}
+
+	private:
+		static fs::path GetEntryPath(SourceKey key, std::string_view extension);
+		static std::string GetVersionTag();
+		static void MarkUsed(fs::path const& filePath);
+		static void TrimIfDue();
+	};
+}
\ No newline at end of file
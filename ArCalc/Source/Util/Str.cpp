@@ -5,13 +5,13 @@ namespace ArCalc::Str {
 		IndexPair GetFirstTokenIndices(std::string_view line) {
 			// Skip the spaces before the token.
 			IndexPair res{};
-			while (res.StartIndex < line.length() && std::isspace(line[res.StartIndex])) {
+			while (res.StartIndex < line.length() && IsWhiteSpace(line[res.StartIndex])) {
 				res.StartIndex += 1;
 			}
 
 			// Go until end of token.
 			res.EndIndex = res.StartIndex;
-			while (res.EndIndex < line.length() && !std::isspace(line[res.EndIndex])) {
+			while (res.EndIndex < line.length() && IsNotWhiteSpace(line[res.EndIndex])) {
 				res.EndIndex += 1;
 			}
 
@@ -5,8 +5,50 @@
 #include "Util.h"
 
 namespace ArCalc::Str {
+	namespace Secret {
+		/* Bits of the character class table */
+
+		inline constexpr std::uint8_t WhiteSpaceBit{1U << 0};
+		inline constexpr std::uint8_t AlphaBit     {1U << 1};
+		inline constexpr std::uint8_t DigitBit     {1U << 2};
+		inline constexpr std::uint8_t HexLetterBit {1U << 3};
+		inline constexpr std::uint8_t IdentBit     {1U << 4}; // Alphanumerics and `_`.
+
+		// Anything that may follow the first character of a number literal: hex digits, 
+		// base specifiers, the floating point, digit separators and exponent signs.
+		inline constexpr std::uint8_t NumberBit    {1U << 5};
+
+		consteval std::array<std::uint8_t, 256U> MakeCharClassTable() {
+			std::array<std::uint8_t, 256U> res{};
+			auto const set = [&](std::string_view chars, std::uint8_t bits) {
+				for (auto const c : chars) {
+					res[static_cast<unsigned char>(c)] |= bits;
+				}
+			};
+
+			set(" \t\n\v\f\r", WhiteSpaceBit);
+			for (auto c{'a'}; c <= 'z'; ++c) {
+				res[static_cast<unsigned char>(c)]            |= AlphaBit | IdentBit;
+				res[static_cast<unsigned char>(c - 'a' + 'A')] |= AlphaBit | IdentBit;
+			}
+			set("0123456789", DigitBit | IdentBit | NumberBit);
+			set("abcdefABCDEF", HexLetterBit | NumberBit);
+			set("_", IdentBit);
+			set("oOxXbB.'-", NumberBit);
+			return res;
+		}
+
+		// Indexed by the unsigned value of the character, so that unlike <cctype> it does
+		// not depend on the locale and is fine with negative chars.
+		inline constexpr auto CharClassTable{MakeCharClassTable()};
+
+		constexpr bool HasCharClass(char c, std::uint8_t bits) {
+			return CharClassTable[static_cast<unsigned char>(c)] & bits;
+		}
+	}
+
 	constexpr bool IsWhiteSpace(char c) {
-		return c == ' ' || c == '\t' || c == '\n';
+		return Secret::HasCharClass(c, Secret::WhiteSpaceBit);
 	}
 
 	constexpr bool IsNotWhiteSpace(char c) {
@@ -14,55 +56,87 @@ namespace ArCalc::Str {
 	}
 
 	constexpr bool IsAlpha(char c) {
-		return c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z';
+		return Secret::HasCharClass(c, Secret::AlphaBit);
 	}
 
 	constexpr bool IsDigit(char c) {
-		return c >= '0' && c <= '9';
+		return Secret::HasCharClass(c, Secret::DigitBit);
 	}
 
 	constexpr bool IsAlNum(char c) {
-		return IsAlpha(c) || IsDigit(c);
+		return Secret::HasCharClass(c, Secret::AlphaBit | Secret::DigitBit);
 	}
 
-	template <std::constructible_from<std::string_view> TReturn = std::string>
-	constexpr std::vector<TReturn> SplitOn(std::string_view str, std::string_view chars, 
-		bool bChain = true) 
-	{
-		if (str.empty()) { // Get rid of this edge case quickly.
-			return {TReturn{""}};
-		}
+	constexpr bool IsHexDigit(char c) {
+		return Secret::HasCharClass(c, Secret::DigitBit | Secret::HexLetterBit);
+	}
 
-		std::vector<TReturn> res{};
+	constexpr bool IsIdentChar(char c) {
+		return Secret::HasCharClass(c, Secret::IdentBit);
+	}
 
-		// Skip the separators at the begining.
-		auto ir = size_t{};
-		for (; ir < str.size() && range::any_of(chars, Util::Eq(str[ir])); ++ir)
-			;
+	constexpr bool IsNumberChar(char c) {
+		return Secret::HasCharClass(c, Secret::NumberBit);
+	}
 
-		auto il{ir};
-		for (; ir < str.size(); ++ir) {
-			if (range::none_of(chars, Util::Eq(str[ir]))) {
-				continue;
+	namespace Secret {
+		// Used by both versions of SplitOn.
+		template <class TReturn, class Container>
+		constexpr void SplitOnInto(Container& res, std::string_view str, std::string_view chars, 
+			bool bChain) 
+		{
+			if (str.empty()) { // Get rid of this edge case quickly.
+				res.push_back(TReturn{""});
+				return;
 			}
 
-			res.push_back(TReturn{str.substr(il, ir - il)});
-			if (bChain) {
-				// Setting this to false will insert an empty token in between each two 
-				// consecutive delimeters, otherwise the function will remove that token.
-
-				for (; ir < str.size() && range::any_of(chars, Util::Eq(str[ir])); ++ir)
-					;
-
-				il = ir;
-			} else {
-				il = ir + 1; // Do not increment ir ffs.
+			// Skip the separators at the begining.
+			auto ir = size_t{};
+			for (; ir < str.size() && range::any_of(chars, Util::Eq(str[ir])); ++ir)
+				;
+
+			auto il{ir};
+			for (; ir < str.size(); ++ir) {
+				if (range::none_of(chars, Util::Eq(str[ir]))) {
+					continue;
+				}
+
+				res.push_back(TReturn{str.substr(il, ir - il)});
+				if (bChain) {
+					// Setting this to false will insert an empty token in between each two 
+					// consecutive delimeters, otherwise the function will remove that token.
+
+					for (; ir < str.size() && range::any_of(chars, Util::Eq(str[ir])); ++ir)
+						;
+
+					il = ir;
+				} else {
+					il = ir + 1; // Do not increment ir ffs.
+				}
+			}
+			if (il != str.size()) { // So it does not push an empty token for the sake of it.
+				res.push_back(TReturn{str.substr(il, ir - il)});
 			}
 		}
-		if (il != str.size()) { // So it does not push an empty token for the sake of it.
-			res.push_back(TReturn{str.substr(il, ir - il)});
-		}
+	}
+
+	template <std::constructible_from<std::string_view> TReturn = std::string>
+	constexpr std::vector<TReturn> SplitOn(std::string_view str, std::string_view chars, 
+		bool bChain = true) 
+	{
+		std::vector<TReturn> res{};
+		Secret::SplitOnInto<TReturn>(res, str, chars, bChain);
+		return res;
+	}
 
+	// Same as above, except that the token list is allocated from [mem], which is 
+	// meant to be a short-lived arena (see LineArena).
+	template <std::constructible_from<std::string_view> TReturn = std::string_view>
+	std::pmr::vector<TReturn> SplitOn(std::pmr::memory_resource& mem, std::string_view str, 
+		std::string_view chars, bool bChain = true) 
+	{
+		std::pmr::vector<TReturn> res{&mem};
+		Secret::SplitOnInto<TReturn>(res, str, chars, bChain);
 		return res;
 	}
 
@@ -71,6 +145,11 @@ namespace ArCalc::Str {
 		return SplitOn<TReturn>(str, " \t");
 	}
 
+	template <std::constructible_from<std::string_view> TReturn = std::string_view>
+	std::pmr::vector<TReturn> SplitOnSpaces(std::pmr::memory_resource& mem, std::string_view str) {
+		return SplitOn<TReturn>(mem, str, " \t");
+	}
+
 	namespace Secret {
 		struct IndexPair {
 			size_t StartIndex;
@@ -102,7 +181,7 @@ namespace ArCalc::Str {
 	template <std::constructible_from<std::string_view> TReturn = std::string>
 	TReturn TrimLeft(std::string_view str) {
 		return TReturn{str.substr(range::distance(
-			str | view::take_while([](auto c) { return std::isspace(c); })
+			str | view::take_while(IsWhiteSpace)
 		))};
 	}
 
@@ -0,0 +1,152 @@
+#include "ThreadPool.h"
+
+namespace ArCalc {
+	ThreadPool::TaskGroup::TaskGroup(ThreadPool& pool) : m_pPool{&pool} {}
+
+	ThreadPool::TaskGroup::~TaskGroup() {
+		WaitWithoutRethrowing();
+	}
+
+	void ThreadPool::TaskGroup::Wait() {
+		WaitWithoutRethrowing();
+		if (auto pError{std::exchange(m_pError, {})}) {
+			std::rethrow_exception(pError);
+		}
+	}
+
+	void ThreadPool::TaskGroup::WaitWithoutRethrowing() {
+		while (m_PendingCount.load() != 0U) {
+			if (!m_pPool->TryRunOne()) {
+				// Everything left is already running on other threads.
+				auto lock = std::unique_lock{m_Mutex};
+				m_DoneCV.wait(lock, [this] { return m_PendingCount.load() == 0U; });
+			}
+		}
+
+		// The last task may still hold the lock, after it saw the count drop to 0.
+		auto const lock{std::scoped_lock{m_Mutex}};
+	}
+
+	ThreadPool::ThreadPool(size_t workerCount) {
+		if (workerCount == 0U) {
+			workerCount = std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		for ([[maybe_unused]] auto const _ : view::iota(size_t{}, workerCount)) {
+			m_Queues.push_back(std::make_unique<Queue>());
+		}
+
+		for (auto const i : view::iota(size_t{}, workerCount)) {
+			m_Workers.emplace_back([this, i](std::stop_token stopToken) { RunWorker(stopToken, i); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		for (auto& worker : m_Workers) {
+			worker.request_stop();
+		}
+		m_SleepCV.notify_all();
+		m_Workers.clear();
+
+		// Submitted from outside of the pool while the workers were stopping.
+		while (TryRunOne()) {}
+	}
+
+	void ThreadPool::Submit(Task&& task) {
+		auto const index{IsWorkerThread() 
+			? s_WorkerIndex : m_NextQueue.fetch_add(1U, std::memory_order_relaxed) % m_Queues.size()};
+		{
+			auto& queue{*m_Queues[index]};
+			auto const lock{std::scoped_lock{queue.Mutex}};
+			queue.Tasks.push_back(std::move(task));
+		}
+
+		// Workers only go to sleep after seeing no queued tasks, and only after counting 
+		// themselves as sleeping, so either this sees them, or they see the task.
+		m_QueuedCount.fetch_add(1U);
+		if (m_SleepingCount.load() != 0U) {
+			{ auto const lock{std::scoped_lock{m_SleepMutex}}; }
+			m_SleepCV.notify_one();
+		}
+	}
+
+	bool ThreadPool::TryRunOne() {
+		if (m_QueuedCount.load() == 0U) {
+			return false;
+		}
+
+		auto task{Take()};
+		if (!task) {
+			return false;
+		}
+
+		(*task)();
+		return true;
+	}
+
+	bool ThreadPool::IsWorkerThread() const {
+		return s_pWorkerPool == this;
+	}
+
+	std::optional<ThreadPool::Task> ThreadPool::Take() {
+		auto const takeFrom = [this](size_t index, bool bBack) -> std::optional<Task> {
+			auto& queue{*m_Queues[index]};
+			auto const lock{std::scoped_lock{queue.Mutex}};
+			if (queue.Tasks.empty()) {
+				return std::nullopt;
+			}
+
+			auto res = std::optional<Task>{};
+			if (bBack) {
+				res.emplace(std::move(queue.Tasks.back()));
+				queue.Tasks.pop_back();
+			} else {
+				res.emplace(std::move(queue.Tasks.front()));
+				queue.Tasks.pop_front();
+			}
+
+			m_QueuedCount.fetch_sub(1U);
+			return res;
+		};
+
+		auto const bWorker{IsWorkerThread()};
+		auto const first{bWorker ? s_WorkerIndex : 0U};
+		if (bWorker) {
+			if (auto task{takeFrom(first, true)}) {
+				return task;
+			}
+		}
+
+		for (auto const offset : view::iota(size_t{bWorker}, m_Queues.size())) {
+			if (auto task{takeFrom((first + offset) % m_Queues.size(), false)}) {
+				return task;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	void ThreadPool::RunWorker(std::stop_token stopToken, size_t index) {
+		s_pWorkerPool = this;
+		s_WorkerIndex = index;
+
+		// Whatever is still queued once stopped is run, as some group may be waiting for it.
+		while (true) {
+			if (TryRunOne()) {
+				continue;
+			} else if (stopToken.stop_requested()) {
+				break;
+			}
+
+			auto lock = std::unique_lock{m_SleepMutex};
+			m_SleepingCount.fetch_add(1U);
+			m_SleepCV.wait(lock, stopToken, [this] { return m_QueuedCount.load() != 0U; });
+			m_SleepingCount.fetch_sub(1U);
+		}
+	}
+
+	size_t ThreadPool::GetChunkSize(size_t count, size_t grainSize) const {
+		auto const maxChunkCount{(GetWorkerCount() + 1U) * sc_ChunksPerWorker};
+		return std::max({size_t{1U}, grainSize, (count + maxChunkCount - 1U) / maxChunkCount});
+	}
+}
\ No newline at end of file
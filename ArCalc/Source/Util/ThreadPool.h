@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Core.h"
+
+namespace ArCalc {
+	/// Work-stealing pool of threads, for splitting work between cores.
+	///
+	/// Every worker has a queue of its own. Tasks forked on a worker go to the back of its 
+	/// queue, and it takes its next task from the back as well, so it keeps working on what 
+	/// is still in its cache. Idle workers steal from the front of the other queues, where 
+	/// the oldest, and usually biggest, pieces of work are. Tasks submitted by other threads 
+	/// are spread between the queues.
+	///
+	/// Threads waiting for tasks (see TaskGroup) run queued tasks in the meantime, so forking 
+	/// from inside a task never deadlocks, however deep it goes.
+	///
+	/// Tasks share nothing but what they capture. State that must not be shared between 
+	/// threads, like the literals of a session, is made for every chunk of work by ForEach.
+	class ThreadPool {
+	public:
+		using Task = std::move_only_function<void()>;
+
+		/// Tasks forked together and waited for together. The first exception thrown by one 
+		/// of them is rethrown by Wait.
+		class TaskGroup {
+		public:
+			TaskGroup(TaskGroup const&)            = delete;
+			TaskGroup(TaskGroup&&)                 = delete;
+			TaskGroup& operator=(TaskGroup const&) = delete;
+			TaskGroup& operator=(TaskGroup&&)      = delete;
+
+			TaskGroup(ThreadPool& pool);
+
+			// Waits for the tasks that are left, but can not rethrow their exceptions.
+			~TaskGroup();
+
+		public:
+			template <class Func>
+			void Run(Func&& func) {
+				m_PendingCount.fetch_add(1U);
+				m_pPool->Submit([this, func = std::forward<Func>(func)]() mutable {
+					auto pError = std::exception_ptr{};
+					try {
+						func();
+					} catch (...) {
+						pError = std::current_exception();
+					}
+					
+					// Under the lock, as the group may be gone as soon as a waiter can take it.
+					auto const lock{std::scoped_lock{m_Mutex}};
+					if (pError && !m_pError) {
+						m_pError = std::move(pError);
+					}
+					if (m_PendingCount.fetch_sub(1U) == 1U) {
+						m_DoneCV.notify_all();
+					}
+				});
+			}
+
+			// Runs queued tasks until all the tasks of this group are done.
+			void Wait();
+
+		private:
+			void WaitWithoutRethrowing();
+
+		private:
+			ThreadPool* m_pPool;
+			std::atomic<size_t> m_PendingCount{};
+			std::mutex m_Mutex{};
+			std::condition_variable m_DoneCV{};
+			std::exception_ptr m_pError{};
+		};
+
+	public:
+		ThreadPool(ThreadPool const&)            = delete;
+		ThreadPool(ThreadPool&&)                 = delete;
+		ThreadPool& operator=(ThreadPool const&) = delete;
+		ThreadPool& operator=(ThreadPool&&)      = delete;
+
+		// 0 means one worker per core.
+		ThreadPool(size_t workerCount = 0U);
+
+		// Queued tasks are still run before the workers stop, so every group gets done.
+		~ThreadPool();
+
+	public:
+		// [task] must not throw, use a TaskGroup (or a std::packaged_task) to get its exceptions.
+		void Submit(Task&& task);
+
+		// Runs one queued task on the calling thread, returns false if there was none.
+		bool TryRunOne();
+
+		// Runs [first] on the calling thread and [second] on any, returning once both are done.
+		template <class First, class Second>
+		void Invoke(First&& first, Second&& second) {
+			auto group = TaskGroup{*this};
+			group.Run(std::forward<Second>(second));
+			first();
+			group.Wait();
+		}
+
+		// Calls [func](i) for every i in [0, count), in chunks of at least [grainSize] indices.
+		// The calling thread takes part as well.
+		template <class Func>
+		void ForEach(size_t count, size_t grainSize, Func&& func) {
+			ForEach(count, grainSize, [] { return std::monostate{}; }, 
+				[&func](std::monostate, size_t i) { func(i); });
+		}
+
+		// Same as above, but every chunk makes its own state with [makeState](), on the thread
+		// it runs on, then calls [func](state, i) with it.
+		template <class MakeState, class Func>
+		void ForEach(size_t count, size_t grainSize, MakeState&& makeState, Func&& func) {
+			auto const chunkSize{GetChunkSize(count, grainSize)};
+			auto const runChunk = [&](size_t begin) {
+				auto state{makeState()};
+				for (auto const i : view::iota(begin, std::min(begin + chunkSize, count))) {
+					func(state, i);
+				}
+			};
+
+			auto group = TaskGroup{*this};
+			for (auto begin{chunkSize}; begin < count; begin += chunkSize) {
+				group.Run([&runChunk, begin] { runChunk(begin); });
+			}
+
+			if (count != 0U) {
+				runChunk(0U);
+			}
+			group.Wait();
+		}
+
+		constexpr size_t GetWorkerCount() const {
+			return m_Queues.size();
+		}
+
+		// Tasks submitted but not started yet, which is only a hint by the time it returns.
+		size_t GetQueuedCount() const {
+			return m_QueuedCount.load(std::memory_order_relaxed);
+		}
+
+		// Whether the calling thread is one of the workers of this pool.
+		bool IsWorkerThread() const;
+
+	private:
+		struct Queue {
+			std::mutex Mutex{};
+			std::deque<Task> Tasks{};
+		};
+
+		std::optional<Task> Take();
+		void RunWorker(std::stop_token stopToken, size_t index);
+		size_t GetChunkSize(size_t count, size_t grainSize) const;
+
+		// Chunks per worker in ForEach, so that workers finishing early can steal some.
+		constexpr static size_t sc_ChunksPerWorker{4U};
+
+	private:
+		std::vector<std::unique_ptr<Queue>> m_Queues{};
+		std::atomic<size_t> m_QueuedCount{};
+		std::atomic<size_t> m_NextQueue{};
+
+		std::mutex m_SleepMutex{};
+		std::condition_variable_any m_SleepCV{};
+		std::atomic<size_t> m_SleepingCount{};
+
+		std::vector<std::jthread> m_Workers{}; // Last, so they are stopped before the rest is destroyed.
+
+		inline static thread_local ThreadPool* s_pWorkerPool{};
+		inline static thread_local size_t s_WorkerIndex{};
+	};
+}
\ No newline at end of file
@@ -4,7 +4,7 @@
 namespace ArCalc::Util {
 	bool IsValidIndentifier(std::string_view what) {
 		return !what.empty()
-			&& std::ranges::all_of(what, Union(Eq('_'), Str::IsAlNum))
+			&& std::ranges::all_of(what, Str::IsIdentChar)
 			&& !Str::IsDigit(what.front());
 	}
 }
\ No newline at end of file
@@ -45,4 +45,17 @@ namespace ArCalc::Util {
 	}
 
 	bool IsValidIndentifier(std::string_view what);
+
+	/// Allows string-keyed maps to be searched using a std::string_view, without 
+	/// constructing a std::string (and possibly allocating) just for the lookup.
+	struct StringHash {
+		using is_transparent = void;
+
+		size_t operator()(std::string_view str) const noexcept {
+			return std::hash<std::string_view>{}(str);
+		}
+	};
+
+	template <class ValueType>
+	using StringMap = std::unordered_map<std::string, ValueType, StringHash, std::equal_to<>>;
 }
\ No newline at end of file
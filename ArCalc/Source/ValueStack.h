@@ -69,6 +69,12 @@ namespace ArCalc {
 			return m_Data.back();
 		}
 
+		// From the bottom of the stack.
+		constexpr Entry& At(size_t index) {
+			ARCALC_DA(index < m_Data.size(), "ValueStack::At({}) on [{}] values", index, m_Data.size());
+			return m_Data[index];
+		}
+
 		constexpr size_t Size()  const { return m_Data.size(); }
 		constexpr bool IsEmpty() const { return m_Data.empty(); }
 		constexpr void Clear()         { m_Data.clear(); }
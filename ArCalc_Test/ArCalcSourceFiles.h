@@ -10,9 +10,29 @@
 #include <Util/IO.cpp>
 #include <Util/Random.cpp>
 #include <Util/NumberParser.cpp>
+#include <Util/LineArena.cpp>
+#include <Util/Lexer.cpp>
+#include <Util/BinaryStream.cpp>
+#include <Util/CategoryFile.cpp>
+#include <Util/MappedFile.cpp>
+#include <Util/ScriptCache.cpp>
+#include <Util/LineReader.cpp>
+#include <Util/OutputSink.cpp>
+#include <Util/NumberFormatter.cpp>
+#include <Util/LocalSocket.cpp>
+#include <Util/ThreadPool.cpp>
+#include <Util/ChildProcess.cpp>
 #include <Exception/ArCalcException.cpp>
 
 // Source/
 #include <Parser.cpp>
 #include <PostfixMathEvaluator.cpp>
 #include <ValueStack.cpp>
+#include <EvaluatorPool.cpp>
+#include <ScriptPipeline.cpp>
+#include <TextResultSink.cpp>
+#include <Engine.cpp>
+#include <Server.cpp>
+#include <Sweep.cpp>
+#include <ShardedSweep.cpp>
+#include <StatementGraph.cpp>
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "pch.h"
 
 #include <Util/IO.h>
+#include <Util/LineReader.h>
+#include <Util/OutputSink.h>
+#include <Util/ScriptCache.h>
 
 #define IO_TEST(_testName) TEST_F(IOTests, _testName)
 
@@ -97,4 +100,63 @@ IO_TEST(IStream_size) {
 	constexpr auto MyString{"Hello, baby!"};
 	std::stringstream ss{MyString};
 	ASSERT_EQ(std::string_view{MyString}.size(), IO::IStreamSize(ss));
+}
+
+IO_TEST(LineReader_reads_text_and_streams_the_same) {
+	using Lines = std::vector<std::string>;
+	std::pair<std::string_view, Lines> const cases[]{
+		{"a\n\nb c\n", Lines{"a", "", "b c"}},
+		{"a\nb",        Lines{"a", "b"}},
+		{"\n\n",        Lines{"", ""}},
+		{"",            Lines{}},
+	};
+
+	for (auto const& [text, expectedLines] : cases) {
+		auto const readLines = [&](LineReader& reader) {
+			std::vector<std::string> res{};
+			while (auto const line{reader.Next()}) {
+				res.emplace_back(*line);
+			}
+
+			EXPECT_EQ(res.size(), reader.GetLineCount());
+			EXPECT_EQ(ScriptCache::Hash(text), reader.GetHash()) << text;
+			EXPECT_EQ(text.size(), reader.GetSize()) << text;
+			return res;
+		};
+
+		LineReader fromText{text};
+		EXPECT_EQ(expectedLines, readLines(fromText)) << text;
+
+		std::istringstream is{std::string{text}};
+		LineReader fromStream{is};
+		EXPECT_EQ(expectedLines, readLines(fromStream)) << text;
+	}
+}
+
+IO_TEST(OutputSink_writes_in_chunks) {
+	for (auto const bAsync : {false, true}) {
+		std::ostringstream target{};
+		auto expected = std::string{};
+		{
+			OutputSink sink{target, bAsync};
+			std::ostream os{&sink};
+
+			os << "first\n";
+			EXPECT_TRUE(target.str().empty()) << "Written before a flush point";
+			os.flush();
+			EXPECT_EQ("first\n", target.str());
+			expected = "first\n";
+
+			for (auto const i : view::iota(0U, 100'000U)) {
+				os << i << '\n';
+				expected += std::to_string(i) + '\n';
+			}
+			sink.Flush();
+			EXPECT_EQ(expected, target.str());
+
+			os << "last";
+			expected += "last";
+		}
+		EXPECT_EQ(expected, target.str()) << "Not written by the destructor";
+	}
 }
\ No newline at end of file
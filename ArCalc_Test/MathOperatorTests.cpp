@@ -82,4 +82,17 @@ MATHOP_TEST(EvalUnary) {
 	// Evaluating unary function using EvalBinary
 	ASSERT_ANY_THROW(MathOperator::EvalUnary("+", A));
 #endif // ^^^^ Debug mode only.
+}
+
+MATHOP_TEST(Generated_conversion_operators) {
+	constexpr auto A{5.0};
+
+	ASSERT_DOUBLE_EQ(A * 12.0 * 30.0 * 24.0 * 60.0 * 60.0, MathOperator::EvalUnary("year_to_sec", A));
+	ASSERT_DOUBLE_EQ(A / 60.0, MathOperator::EvalUnary("min_to_hour", A));
+	ASSERT_DOUBLE_EQ(A * 3.28084, MathOperator::EvalUnary("m_to_ft", A));
+	ASSERT_DOUBLE_EQ(A, MathOperator::EvalUnary("day_to_month", MathOperator::EvalUnary("month_to_day", A)));
+
+	ASSERT_FALSE(MathOperator::IsValid("year_to_year"));
+	ASSERT_FALSE(MathOperator::IsValid("year_to_"));
+	ASSERT_FALSE(MathOperator::IsValid(""));
 }
\ No newline at end of file
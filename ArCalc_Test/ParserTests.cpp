@@ -1,8 +1,12 @@
 #include "pch.h"
 
 #include <../../ArCalc/Source/Parser.h>
+#include <../../ArCalc/Source/Engine.h>
+#include <../../ArCalc/Source/ShardedSweep.h>
 #include "Util/Str.h"
 #include <Util/IO.h>
+#include <Util/CategoryFile.h>
+#include <Util/ScriptCache.h>
 #include <Util/Random.h>
 #include <Util/MathConstant.h>
 
@@ -19,6 +23,28 @@ public:
 		par.ToggleOutput();
 		return par;
 	}
+
+	// Removed once the test is over, even if it stopped early.
+	void RemoveAfterwards(fs::path path) {
+		m_PathsToRemove.push_back(std::move(path));
+	}
+
+protected:
+	// Tests save everything under the name Testing, besides what they RemoveAfterwards.
+	void TearDown() override {
+		auto ec = std::error_code{};
+		for (auto const& path : m_PathsToRemove) {
+			fs::remove_all(path, ec);
+		}
+
+		fs::remove(CategoryFile::GetPath("Testing", CategoryFormat::Binary), ec);
+		fs::remove(CategoryFile::GetPath("Testing", CategoryFormat::Text), ec);
+		fs::remove(CategoryFile::GetSnapshotPath("Testing"), ec);
+		fs::remove(IO::GetSerializationPath() / "Testing.arc", ec);
+	}
+
+private:
+	std::vector<fs::path> m_PathsToRemove{};
 };
 
 PARSER_TEST(Semicolon_at_end_of_line) {
@@ -757,10 +783,6 @@ PARSER_TEST(Serializing_a_constant) {
 
 	EXPECT_NO_THROW(optPar->ParseLine("tenEighty"));
 	EXPECT_DOUBLE_EQ(1080.0, optPar->GetLitMan().GetLast());
-
-	// Can't use asserts because of this shit right here.
-	// Clean up by opening the file without the append flag.
-	std::ofstream{IO::GetSerializationPath() / "Testing.txt"};
 }
 
 PARSER_TEST(Serializing_a_function) {
@@ -786,10 +808,872 @@ PARSER_TEST(Serializing_a_function) {
 
 	EXPECT_NO_THROW(optPar->ParseLine("5 10 Sub;"));
 	EXPECT_DOUBLE_EQ(5 - 10, optPar->GetLitMan().GetLast());
+}
+
+PARSER_TEST(Serializing_in_both_formats) {
+	auto optPar = std::optional{GenerateTestingInstance()};
+
+	optPar->ParseLine("_Set third 1 3 /");
+	optPar->ParseLine("_Set seventh 1 7 /");
+	optPar->ParseLine("_Func Twice a");
+	optPar->ParseLine("    _Return a 2 *;");
+	EXPECT_NO_THROW(optPar->ParseLine("_Save third Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("_Save seventh Testing text;"));
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Twice Testing binary;"));
+	EXPECT_ANY_THROW(optPar->ParseLine("_Save Twice Testing json;"));
+
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+
+	// Binary saves keep every bit of the value.
+	EXPECT_NO_THROW(optPar->ParseLine("third;"));
+	EXPECT_EQ(1.0 / 3.0, optPar->GetLitMan().GetLast());
+	EXPECT_NO_THROW(optPar->ParseLine("seventh;"));
+	EXPECT_DOUBLE_EQ(1.0 / 7.0, optPar->GetLitMan().GetLast());
+	EXPECT_NO_THROW(optPar->ParseLine("21 Twice;"));
+	EXPECT_DOUBLE_EQ(42.0, optPar->GetLitMan().GetLast());
+}
+
+PARSER_TEST(Loading_a_single_symbol) {
+	auto optPar = std::optional{GenerateTestingInstance()};
+
+	optPar->ParseLine("_Set offset 100");
+	optPar->ParseLine("_Func Double a");
+	optPar->ParseLine("    _Return a 2 *;");
+	optPar->ParseLine("_Func Quadruple a");
+	optPar->ParseLine("    _Return a Double Double;");
+	optPar->ParseLine("_Func Half a");
+	optPar->ParseLine("    _Return a 2 /;");
+	EXPECT_NO_THROW(optPar->ParseLine("_Save offset Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Double Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Quadruple Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Half Testing;"));
+
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing Quadruple;"));
+	EXPECT_ANY_THROW(optPar->ParseLine("_Load Testing Triple;"));
+
+	// Only the function and what it calls were loaded.
+	EXPECT_NO_THROW(optPar->ParseLine("5 Quadruple;"));
+	EXPECT_DOUBLE_EQ(20.0, optPar->GetLitMan().GetLast());
+	EXPECT_TRUE(optPar->GetFunMan().IsDefined("Double"));
+	EXPECT_FALSE(optPar->GetFunMan().IsDefined("Half"));
+	EXPECT_FALSE(optPar->GetLitMan().IsVisible("offset"));
+
+	// Saving again replaces the index entry, only appending to the file.
+	auto const bytesBefore{IO::FileToBytes(CategoryFile::GetPath("Testing", CategoryFormat::Binary))};
+	optPar->ParseLine("_Set offset 200");
+	EXPECT_NO_THROW(optPar->ParseLine("_Save offset Testing;"));
+	EXPECT_TRUE(IO::FileToBytes(CategoryFile::GetPath("Testing", CategoryFormat::Binary)).starts_with(bytesBefore));
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing offset;"));
+	EXPECT_NO_THROW(optPar->ParseLine("offset;"));
+	EXPECT_DOUBLE_EQ(200.0, optPar->GetLitMan().GetLast());
+}
+
+PARSER_TEST(Loading_functions_lazily) {
+	auto optPar = std::optional{GenerateTestingInstance()};
+
+	optPar->ParseLine("_Func Double a");
+	optPar->ParseLine("    _Return a 2 *;");
+	optPar->ParseLine("_Func Quadruple a");
+	optPar->ParseLine("    _Return a Double Double;");
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Double Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Quadruple Testing;"));
+
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+	EXPECT_TRUE(optPar->GetFunMan().IsDefined("Quadruple"));
+	EXPECT_FALSE(optPar->GetFunMan().IsLoaded("Quadruple"));
+
+	EXPECT_NO_THROW(optPar->ParseLine("5 Quadruple;"));
+	EXPECT_DOUBLE_EQ(20.0, optPar->GetLitMan().GetLast());
+	EXPECT_TRUE(optPar->GetFunMan().IsLoaded("Quadruple"));
+
+	// Defining a function with the same name as a stub is still an error.
+	EXPECT_ANY_THROW(optPar->ParseLine("_Func Double a"));
+}
+
+PARSER_TEST(Compacting_categories) {
+	auto optPar = std::optional{GenerateTestingInstance()};
+	auto const binaryPath{CategoryFile::GetPath("Testing", CategoryFormat::Binary)};
+	auto const textPath{CategoryFile::GetPath("Testing", CategoryFormat::Text)};
+
+	optPar->ParseLine("_Func Double a");
+	optPar->ParseLine("    _Return a 2 *;");
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Double Testing;"));
+	for (auto const i : view::iota(0, 4)) {
+		optPar->ParseLine(std::format("_Set version {};", i));
+		EXPECT_NO_THROW(optPar->ParseLine("_Save version Testing;"));
+		EXPECT_NO_THROW(optPar->ParseLine("_Save version Testing text;"));
+	}
+
+	// Functions loaded lazily must survive their records being moved.
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+
+	auto const binarySize{fs::file_size(binaryPath)};
+	auto const textSize{fs::file_size(textPath)};
+	EXPECT_NO_THROW(optPar->ParseLine("_Compact Testing;"));
+	EXPECT_LT(fs::file_size(binaryPath), binarySize);
+	EXPECT_LT(fs::file_size(textPath), textSize);
+	EXPECT_ANY_THROW(optPar->ParseLine("_Compact NonExistantCategory;"));
+
+	EXPECT_NO_THROW(optPar->ParseLine("21 Double;"));
+	EXPECT_DOUBLE_EQ(42.0, optPar->GetLitMan().GetLast());
+
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("version;"));
+	EXPECT_DOUBLE_EQ(3.0, optPar->GetLitMan().GetLast());
+
+	// Not while another session has functions of the file it did not read yet.
+	auto other{GenerateTestingInstance()};
+	EXPECT_ANY_THROW(other.ParseLine("_Compact Testing;"));
+	EXPECT_ANY_THROW(other.ParseLine("_Compact Test/ing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("21 Double;"));
+	EXPECT_DOUBLE_EQ(42.0, optPar->GetLitMan().GetLast());
+	EXPECT_NO_THROW(other.ParseLine("_Compact Testing;"));
+
+	// Saves that would compact the file still succeed then, the next one compacts it.
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+	other.ParseLine("_Set version 4;");
+	while (fs::file_size(binaryPath) < CategoryFile::sc_AutoCompactMinSize) {
+		ASSERT_NO_THROW(other.ParseLine("_Save version Testing;"));
+	}
+	EXPECT_NO_THROW(other.ParseLine("_Save version Testing;"));
+	EXPECT_LE(CategoryFile::sc_AutoCompactMinSize, fs::file_size(binaryPath));
+
+	EXPECT_NO_THROW(optPar->ParseLine("21 Double;"));
+	EXPECT_NO_THROW(other.ParseLine("_Save version Testing;"));
+	EXPECT_GT(CategoryFile::sc_AutoCompactMinSize, fs::file_size(binaryPath));
+}
+
+PARSER_TEST(Snapshot_and_restore) {
+	auto optPar = std::optional{GenerateTestingInstance()};
+
+	optPar->ParseLine("_Set third 1 3 /");
+	optPar->ParseLine("_Func Double a");
+	optPar->ParseLine("    _Return a 2 *;");
+	optPar->ParseLine("_Func Quadruple a");
+	optPar->ParseLine("    _Return a Double Double;");
+	EXPECT_NO_THROW(optPar->ParseLine("_Snapshot Testing;"));
+
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_ANY_THROW(optPar->ParseLine("_Restore NonExistantSnapshot;"));
+
+	// Only snapshots in the save directory, even if there is one where the name leads.
+	auto const outsidePath{IO::GetSerializationPath().parent_path() / "Testing.arsnap"};
+	RemoveAfterwards(outsidePath);
+	fs::copy_file(CategoryFile::GetSnapshotPath("Testing"), outsidePath, fs::copy_options::overwrite_existing);
+	EXPECT_ANY_THROW(optPar->ParseLine("_Restore ../Testing;"));
+
+	EXPECT_NO_THROW(optPar->ParseLine("_Restore Testing;"));
+	EXPECT_FALSE(optPar->GetFunMan().IsLoaded("Quadruple"));
+
+	EXPECT_NO_THROW(optPar->ParseLine("third;"));
+	EXPECT_EQ(1.0 / 3.0, optPar->GetLitMan().GetLast());
+	EXPECT_NO_THROW(optPar->ParseLine("5 Quadruple;"));
+	EXPECT_DOUBLE_EQ(20.0, optPar->GetLitMan().GetLast());
+
+	// Replacing the snapshot while it is still mapped.
+	auto other{GenerateTestingInstance()};
+	other.ParseLine("_Set third 3");
+	EXPECT_NO_THROW(other.ParseLine("_Snapshot Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("third;"));
+	EXPECT_EQ(1.0 / 3.0, optPar->GetLitMan().GetLast());
+
+	auto restored{GenerateTestingInstance()};
+	EXPECT_NO_THROW(restored.ParseLine("_Restore Testing;"));
+	EXPECT_NO_THROW(restored.ParseLine("third;"));
+	EXPECT_EQ(3.0, restored.GetLitMan().GetLast());
+}
+
+PARSER_TEST(Caching_script_functions) {
+	std::string const script{
+		"_Func Triple a\n"
+		"    _Return a 3 *;\n"
+		"4 Triple\n"
+		"_Func abs n\n"
+		"    _Set twice n 2 *;\n"
+		"    _Return twice\n"
+		"-5 abs Triple\n"
+	};
+	auto const cachePath{ScriptCache::GetScriptPath(script)};
+	fs::remove(cachePath);
+	RemoveAfterwards(cachePath);
+
+	// Only files are looked up before running, streams are run as they are read.
+	auto const scriptPath{IO::GetSerializationPath() / "Testing.arc"};
+	fs::create_directory(scriptPath.parent_path());
+	std::ofstream{scriptPath, std::ios::binary} << script;
+
+	auto const run = [&] {
+		std::ostringstream os{};
+		Parser::ParseFile(scriptPath, os);
+		return os.str();
+	};
+
+	auto const coldOutput{run()};
+	EXPECT_NE(std::string::npos, coldOutput.find("shadows operator [abs]"));
+	auto const cachedFunctions{ScriptCache::FindScript(script)};
+	ASSERT_TRUE(cachedFunctions.has_value());
+	ASSERT_EQ(2U, cachedFunctions->size());
+	EXPECT_EQ(3U, (*cachedFunctions)[1].FirstLine);
+	EXPECT_EQ(3U, (*cachedFunctions)[1].LineCount);
+
+	EXPECT_EQ(coldOutput, run());
+
+	// Corrupted entries are dropped and made again.
+	std::ofstream{cachePath, std::ios::binary | std::ios::trunc} << "ArCalcScript garbage";
+	EXPECT_EQ(coldOutput, run());
+	EXPECT_TRUE(ScriptCache::FindScript(script).has_value());
+
+	// Streamed scripts still make the entry for the next time.
+	fs::remove(cachePath);
+	std::istringstream is{script};
+	std::ostringstream os{};
+	Parser::ParseIStream(is, os);
+	EXPECT_EQ(coldOutput, os.str());
+	EXPECT_TRUE(ScriptCache::FindScript(script).has_value());
+
+	// Entries of other versions go first, then the least recently used ones.
+	auto const staleEntryPath{ScriptCache::GetDirectory() / "0000000000000000-0-v0.0.arscript"};
+	std::ofstream{staleEntryPath, std::ios::binary} << "ArCalcScript";
+	auto const otherScript{script + "2 Triple\n"};
+	auto const otherCachePath{ScriptCache::GetScriptPath(otherScript)};
+	RemoveAfterwards(otherCachePath);
+	ScriptCache::StoreScript(ScriptCache::KeyOf(otherScript), *cachedFunctions);
+	fs::last_write_time(otherCachePath, fs::last_write_time(cachePath) - std::chrono::hours{1});
+
+	ScriptCache::Trim();
+	EXPECT_FALSE(fs::exists(staleEntryPath));
+	EXPECT_TRUE(fs::exists(otherCachePath));
+	EXPECT_TRUE(ScriptCache::FindScript(otherScript).has_value()); // Now the most recently used.
+	ScriptCache::Trim(fs::file_size(otherCachePath));
+	EXPECT_FALSE(fs::exists(cachePath));
+	EXPECT_TRUE(fs::exists(otherCachePath));
+}
+
+PARSER_TEST(Caching_script_functions_calling_loaded_ones) {
+	auto const binaryPath{CategoryFile::GetPath("Testing", CategoryFormat::Binary)};
+	fs::remove(binaryPath);
+	auto const saveHelper = [&](std::string_view returnLine) {
+		auto parser{GenerateTestingInstance()};
+		parser.ParseLine("_Func Helper n");
+		parser.ParseLine(returnLine);
+		parser.ParseLine("_Save Helper Testing;");
+	};
+
+	std::string const script{
+		"_Load Testing;\n"
+		"_Func Twice a\n"
+		"    _Return a Helper 2 *;\n"
+		"4 Twice\n"
+	};
+	auto const scriptPath{IO::GetSerializationPath() / "Testing.arc"};
+	std::ofstream{scriptPath, std::ios::binary | std::ios::trunc} << script;
+	fs::remove(ScriptCache::GetScriptPath(script));
+	RemoveAfterwards(ScriptCache::GetScriptPath(script));
+
+	auto const run = [&] {
+		std::ostringstream os{};
+		auto const errorLine = [&] {
+			try { Parser::ParseFile(scriptPath, os); } 
+			catch (ArCalcException const& err) { return err.GetLineNumber(); }
+			return size_t{};
+		}(/*)(*/);
+		return std::pair{errorLine, os.str()};
+	};
+
+	saveHelper("    _Return n 1 +;");
+	EXPECT_EQ((std::pair{size_t{}, std::string{"10\n"}}), run());
+	EXPECT_TRUE(ScriptCache::FindScript(script).has_value());
+
+	// Helper returning nothing makes Twice invalid, which the cached definition must not hide 
+	// until it is called.
+	fs::remove(binaryPath);
+	saveHelper("    _Return;");
+	auto const changedOutput{run()};
+	EXPECT_EQ(2U, changedOutput.first);
+	fs::remove(ScriptCache::GetScriptPath(script));
+	EXPECT_EQ(changedOutput, run());
+}
+
+PARSER_TEST(Loading_large_text_categories) {
+	auto pool = ThreadPool{3U};
+	auto optPar = std::optional{GenerateTestingInstance()};
+	auto const textPath{CategoryFile::GetPath("Testing", CategoryFormat::Text)};
+	fs::remove(textPath);
+	fs::remove(CategoryFile::GetPath("Testing", CategoryFormat::Binary));
+
+	// Enough records for the file to be split between threads, with names saved more than once.
+	optPar->ParseLine("_Func Double a");
+	optPar->ParseLine("    _Return a 2 *;");
+	EXPECT_NO_THROW(optPar->ParseLine("_Save Double Testing text;"));
+	for (auto const i : view::iota(0, 12000)) {
+		optPar->ParseLine(std::format("_Set value{} {};", i % 1000, i));
+		optPar->ParseLine(std::format("_Save value{} Testing text;", i % 1000));
+	}
+
+	auto const text{IO::FileToString(textPath)};
+	auto const chunks{CategoryFile::SplitText(text, 4U)};
+	EXPECT_LT(1U, chunks.size());
+	EXPECT_EQ(text, std::accumulate(chunks.begin(), chunks.end(), std::string{}, 
+		[](std::string acc, std::string_view chunk) { return acc.append(chunk); }));
+	for (auto const chunk : chunks) {
+		EXPECT_TRUE(chunk.front() == CategoryFile::sc_LiteralTag 
+			|| chunk.front() == CategoryFile::sc_FunctionTag);
+	}
+
+	optPar.emplace(GenerateTestingInstance());
+	optPar->SetThreadPool(&pool);
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+	EXPECT_NO_THROW(optPar->ParseLine("value7;"));
+	EXPECT_DOUBLE_EQ(11007.0, optPar->GetLitMan().GetLast());
+	EXPECT_NO_THROW(optPar->ParseLine("value999 Double;"));
+	EXPECT_DOUBLE_EQ(23998.0, optPar->GetLitMan().GetLast());
+
+	// Loaded again from the converted copy, which the cache keeps until Double is read.
+	auto const cachedPath{ScriptCache::GetCategoryPath(text)};
+	RemoveAfterwards(cachedPath);
+	optPar.emplace(GenerateTestingInstance());
+	EXPECT_NO_THROW(optPar->ParseLine("_Load Testing;"));
+	EXPECT_FALSE(optPar->GetFunMan().IsLoaded("Double"));
+	ScriptCache::Trim(0U);
+	EXPECT_TRUE(fs::exists(cachedPath));
+	EXPECT_NO_THROW(optPar->ParseLine("value7 Double;"));
+	EXPECT_DOUBLE_EQ(22014.0, optPar->GetLitMan().GetLast());
+	ScriptCache::Trim(0U);
+	EXPECT_FALSE(fs::exists(cachedPath));
+}
+
+PARSER_TEST(Pipelined_script_files) {
+	auto script = std::string{};
+	for (auto const i : view::iota(0, 4000)) {
+		script += std::format("_Set x{} {} -2 *\n", i, i);
+		script += std::format("x{} -x{} + 0.5 +\n", i, i);
+		if (i == 2000) { // Changes what Half refers to halfway through.
+			script += "_Func Half n\n    _Return n 2 /;\n";
+		} else if (i > 2000) {
+			script += std::format("{} Half\n", i);
+		}
+	}
+	ASSERT_LE(ScriptPipeline::sc_MinAsyncScriptSize, script.size());
+
+	auto const scriptPath{IO::GetSerializationPath() / "Testing.arc"};
+	fs::create_directory(scriptPath.parent_path());
+	auto const run = [&](std::string const& text) {
+		std::ofstream{scriptPath, std::ios::binary | std::ios::trunc} << text;
+		RemoveAfterwards(ScriptCache::GetScriptPath(text));
+		std::ostringstream pipelined{};
+		auto const bPipelinedThrew = [&] {
+			try { Parser::ParseFile(scriptPath, pipelined); } 
+			catch (ArCalcException const&) { return true; }
+			return false;
+		}(/*)(*/);
+
+		std::istringstream is{text};
+		std::ostringstream streamed{};
+		auto const bStreamedThrew = [&] {
+			try { Parser::ParseIStream(is, streamed); } 
+			catch (ArCalcException const&) { return true; }
+			return false;
+		}(/*)(*/);
+
+		EXPECT_EQ(bStreamedThrew, bPipelinedThrew);
+		EXPECT_EQ(streamed.str(), pipelined.str());
+		return pipelined.str();
+	};
+
+	EXPECT_NE(std::string::npos, run(script).find("\n1000.5\n"));
+
+	// Errors stop the script at the same line, while the rest is still being read ahead.
+	script.insert(script.find("_Set x999 "), "x1 undefinedName +\n");
+	auto const output{run(script)};
+	EXPECT_NE(std::string::npos, output.find("x998 = "));
+	EXPECT_EQ(std::string::npos, output.find("x999 = "));
+}
+
+PARSER_TEST(Independent_statements_in_parallel) {
+	auto script = std::string{
+		"_Set a 2\n"
+		"_Set b 3\n"
+		"a b *\n"
+		"_Last 1 +\n"
+		"_Set a a 10 +;\n" // Read by the line before, with the old value.
+		"a b + _Last -\n"
+		"\n"
+		"_Func Sq n\n"
+		"    _Return n n *;\n"
+		"_Set c a Sq b Sq +\n"
+		"c a -\n"
+		"_Last _Last +\n"
+	};
+	for (auto const i : view::iota(0, 500)) {
+		script += std::format("_Set x{} {} Sq c -\n", i, i);
+		script += std::format("x{} _Last +\n", i);
+	}
+
+	auto pool = ThreadPool{3U};
+	auto const scriptPath{IO::GetSerializationPath() / "Testing.arc"};
+	fs::create_directory(scriptPath.parent_path());
+	auto const run = [&](std::string const& text, bool bThrows) {
+		std::ofstream{scriptPath, std::ios::binary | std::ios::trunc} << text;
+		fs::remove(ScriptCache::GetScriptPath(text));
+		RemoveAfterwards(ScriptCache::GetScriptPath(text));
+
+		std::ostringstream sequential{};
+		auto const bSequentialThrew = [&] {
+			try { Parser::ParseFile(scriptPath, sequential); } 
+			catch (ArCalcException const&) { return true; }
+			return false;
+		}(/*)(*/);
+
+		// Cached and streamed scripts go through the graph as well.
+		for (auto const bStreamed : {false, false, true}) {
+			std::ostringstream parallel{};
+			auto const bParallelThrew = [&] {
+				try {
+					if (std::istringstream is{text}; bStreamed) {
+						Parser::ParseIStream(is, parallel, &pool);
+					} else {
+						Parser::ParseFile(scriptPath, parallel, &pool);
+					}
+				} catch (ArCalcException const&) { return true; }
+				return false;
+			}(/*)(*/);
+
+			EXPECT_EQ(bThrows, bParallelThrew);
+			EXPECT_EQ(sequential.str(), parallel.str());
+		}
+
+		EXPECT_EQ(bThrows, bSequentialThrew);
+		return sequential.str();
+	};
 
-	// Can't use asserts because of this shit right here.
-	// Clean up by opening the file without the append flag.
-	std::ofstream{IO::GetSerializationPath() / "Testing.txt"};
+	auto const output{run(script, false)};
+	EXPECT_TRUE(output.starts_with("a = 2\nb = 3\n6\n7\n8\nc = 153\n141\n282\n"));
+	EXPECT_NE(std::string::npos, output.find("x499 = "));
+
+	// Nothing after an error is applied, however independent it is.
+	script += "_Set y 3 5 mod\n_Set z y 1 +\n-1 3 mod\n_Set w z 1 +\n";
+	for (auto const i : view::iota(0, 100)) {
+		script += std::format("{} Sq\n", i);
+	}
+
+	auto const failedOutput{run(script, true)};
+	EXPECT_TRUE(failedOutput.ends_with("y = 3\nz = 4\n"));
+}
+
+PARSER_TEST(Structured_result_sink) {
+	struct RecordingSink : IResultSink {
+		std::vector<std::string> Events{};
+
+		void OnValue(size_t lineNumber, std::optional<double> value) override {
+			Events.push_back(std::format("{} value {}", lineNumber, value ? std::format("{}", *value) : "None"));
+		}
+
+		void OnLiteralSet(size_t lineNumber, std::string_view name, double value) override {
+			Events.push_back(std::format("{} set {} {}", lineNumber, name, value));
+		}
+
+		void OnSweepPoint(size_t lineNumber, std::span<double const> args, double value) override {
+			auto event{std::format("{} point", lineNumber)};
+			for (auto const arg : args) {
+				event += std::format(" {}", arg);
+			}
+			Events.push_back(std::format("{} {}", event, value));
+		}
+
+		void OnFunctionDefined(size_t lineNumber, std::string_view name) override {
+			Events.push_back(std::format("{} func {}", lineNumber, name));
+		}
+
+		void OnError(size_t lineNumber, ArCalcException const& err) override {
+			Events.push_back(std::format("{} error {}", lineNumber, err.GetType()));
+		}
+	} sink{};
+
+	std::ostringstream os{};
+	auto par = Parser{os};
+	par.SetResultSink(&sink);
+
+	par.ParseLine("_Set a 0.1 0.2 +");
+	par.ParseLine("_Set b 5;");
+	par.ParseLine("_Func Twice n");
+	par.ParseLine("    _Return n 2 *");
+	par.ParseLine("a Twice");
+	EXPECT_ANY_THROW(par.ParseLine("a undefinedName +"));
+	par.ExceptionReset();
+
+	std::vector<std::string> const expected{
+		"0 set a 0.30000000000000004",
+		"2 func Twice",
+		"4 value 0.6000000000000001",
+		"5 error EE",
+	};
+	EXPECT_EQ(expected, sink.Events);
+	EXPECT_TRUE(os.str().empty()) << os.str();
+
+	// Without a sink of its own, the parser prints the results again.
+	par.SetResultSink(nullptr);
+	par.ParseLine("b Twice");
+	EXPECT_EQ("10\n", os.str());
+}
+
+PARSER_TEST(Evaluating_a_batch) {
+	std::ostringstream os{};
+	auto par = Parser{os};
+	par.ParseLine("_Set x 4;");
+	par.ParseLine("_Func Twice n;");
+	par.ParseLine("    _Return n 2 *;");
+	par.ParseLine("7;");
+
+	std::vector<std::string_view> const exprs{
+		"x 2 *", "undefinedName", "x Twice", "1 +", "x -x +", "_Last 1 +", "", "_pi", "x Twice",
+	};
+	auto const results{par.EvalBatch(exprs)};
+	ASSERT_EQ(exprs.size(), results.size());
+
+	auto const expectValue = [&](size_t index, double expected) {
+		EXPECT_FALSE(results[index].pError) << exprs[index];
+		ASSERT_TRUE(results[index].Value.has_value()) << exprs[index];
+		EXPECT_DOUBLE_EQ(expected, *results[index].Value) << exprs[index];
+	};
+	auto const expectError = [&](size_t index) {
+		EXPECT_FALSE(results[index].Value.has_value()) << exprs[index];
+		EXPECT_THROW(std::rethrow_exception(results[index].pError), ExprEvalError) << exprs[index];
+	};
+
+	expectValue(0U, 8.0);
+	expectError(1U);
+	expectValue(2U, 8.0);
+	expectError(3U);
+	expectValue(4U, 0.0);
+	expectValue(5U, 8.0);
+	expectError(6U);
+	expectValue(7U, std::numbers::pi);
+	expectValue(8U, 8.0);
+
+	EXPECT_DOUBLE_EQ(7.0, par.GetLitMan().GetLast());
+	EXPECT_TRUE(os.str().empty()) << os.str();
+
+	// Names are looked up again for every batch.
+	par.ParseLine("_Set y 1;");
+	std::vector<std::string_view> const secondExprs{"y x +"};
+	ASSERT_EQ(5.0, par.EvalBatch(secondExprs)[0].Value);
+}
+
+PARSER_TEST(Evaluating_a_batch_in_parallel) {
+	auto engine = Engine{1U, 3U};
+	std::ostringstream os{};
+	auto session{engine.CreateSession(os)};
+	auto par = Parser{os};
+	for (auto const line : {"_Set x 4;", "_Func Twice n;", "    _Return n 2 *;"}) {
+		session.ParseLine(line);
+		par.ParseLine(line);
+	}
+
+	auto texts = std::vector<std::string>{};
+	for (auto const i : view::iota(0, 20'000)) {
+		texts.push_back(i % 1000 == 0 ? std::format("{} undefinedName", i) : std::format("{} x + Twice", i));
+	}
+	std::vector<std::string_view> const exprs(texts.begin(), texts.end());
+
+	auto const expected{par.EvalBatch(exprs)};
+	auto const results{session.GetParser().EvalBatch(exprs)};
+	ASSERT_EQ(expected.size(), results.size());
+	for (auto const i : view::iota(0U, exprs.size())) {
+		ASSERT_EQ(expected[i].Value, results[i].Value) << exprs[i];
+		ASSERT_EQ(static_cast<bool>(expected[i].pError), static_cast<bool>(results[i].pError)) << exprs[i];
+	}
+	EXPECT_EQ(2.0 * (19'999 + 4), results.back().Value);
+
+	// Functions that reach the output or files keep the batch on one thread.
+	EXPECT_TRUE(session.GetParser().GetFunMan().CanCallFromCopiesInParallel());
+	session.ParseLine("_Func Listed n;");
+	session.ParseLine("    _List x;");
+	session.ParseLine("    _Return n;");
+	EXPECT_FALSE(session.GetParser().GetFunMan().CanCallFromCopiesInParallel());
+}
+
+PARSER_TEST(Sweeping_a_function_over_a_grid) {
+	std::ostringstream os{};
+	auto par = Parser{os};
+	for (auto const line : {
+		"_Func Dist a b;",       "    _Return a a * b b * + 2 ^;",
+		"_Func Clamp x lo;",     "    _If x lo <: _Return lo;", "    _Return x;",
+		"_Func Mod3 x;",         "    _Return x 3 mod;",
+		"_Func Store &where x;", "    _Set where x;", "    _Return x;",
+	}) {
+		par.ParseLine(line);
+	}
+
+	// Evaluated in place, the last parameter of the line changing the fastest.
+	par.ParseLine("_Sweep Dist b 1 2 1 a 0 1 0.5");
+	EXPECT_EQ("1 0 1\n1 0.5 1.5625\n1 1 4\n2 0 16\n2 0.5 18.0625\n2 1 25\n", os.str());
+
+	// Called through the function manager, like from an expression.
+	os.str("");
+	par.ParseLine("_Sweep Clamp x -1 1 1 lo 0 0 1");
+	EXPECT_EQ("-1 0 0\n0 0 0\n1 0 1\n", os.str());
+
+	os.str("");
+	par.ParseLine("_Sweep Clamp x -1 1 1 lo 0 0 1;");
+	EXPECT_TRUE(os.str().empty()) << os.str();
+
+	// Points before the failing one are still reported.
+	EXPECT_THROW(par.ParseLine("_Sweep Mod3 x 5 -5 -1"), MathError);
+	EXPECT_EQ("5 2\n4 1\n3 0\n2 2\n1 1\n0 0\n", os.str());
+
+	for (auto const line : {
+		"_Sweep Store where 0 1 1 x 0 1 1", 
+		"_Sweep Dist a 0 1 1", 
+		"_Sweep Dist a 0 1 1 c 0 1 1", 
+		"_Sweep Dist a 0 1 1 a 0 1 1", 
+		"_Sweep Dist a 0 1 -1 b 0 1 1", 
+		"_Sweep Dist a 0 1 0 b 0 1 1", 
+	}) {
+		EXPECT_THROW(par.ParseLine(line), SyntaxError) << line;
+	}
+	EXPECT_THROW(par.ParseLine("_Sweep Nothing a 0 1 1"), ParseError);
+	EXPECT_THROW(par.ParseLine("_Sweep Dist a 0 1"), ParseError);
+}
+
+PARSER_TEST(Sweeping_in_parallel_to_a_file) {
+	auto const sequentialPath{fs::temp_directory_path() / "ArCalc_sweep_sequential.txt"};
+	auto const parallelPath{fs::temp_directory_path() / "ArCalc_sweep_parallel.txt"};
+	RemoveAfterwards(sequentialPath);
+	RemoveAfterwards(parallelPath);
+
+	auto engine = Engine{1U, 3U};
+	std::ostringstream os{};
+	auto session{engine.CreateSession(os)};
+	auto par = Parser{os};
+	for (auto const line : {"_Func Inner s;", "    _Return s s * 1 +;",
+		"_Func Wave x y;", "    _Return x sin y cos * x y + Inner /;"}) 
+	{
+		session.ParseLine(line);
+		par.ParseLine(line);
+	}
+
+	par.ParseLine(std::format("_Sweep Wave x 0 3 0.01 y -1 1 0.01 {}", sequentialPath.string()));
+	session.ParseLine(std::format("_Sweep Wave x 0 3 0.01 y -1 1 0.01 {}", parallelPath.string()));
+	EXPECT_TRUE(os.str().empty()) << os.str();
+
+	auto const expected{IO::FileToString(sequentialPath)};
+	EXPECT_EQ(301U * 201U, range::count(expected, '\n'));
+	EXPECT_TRUE(expected == IO::FileToString(parallelPath));
+
+	// Functions reaching files or the output are swept on one thread.
+	session.ParseLine("_Func Listed x;");
+	session.ParseLine("    _List x;");
+	session.ParseLine("    _Return x Inner;");
+	auto funMan{session.GetParser().GetFunMan()};
+	EXPECT_TRUE(funMan.CanCallFromCopiesInParallel("Wave"));
+	EXPECT_FALSE(funMan.CanCallFromCopiesInParallel("Listed"));
+}
+
+PARSER_TEST(Sweeping_in_worker_processes) {
+	auto const bWorkerFound = [] {
+		try {
+			return !ShardedSweep::GetWorkerPath().empty();
+		} catch (IOError const&) {
+			return false;
+		}
+	}(/*)(*/);
+	if (!bWorkerFound) {
+		GTEST_SKIP() << "No ArCalc executable next to the tests to run the shards in";
+	}
+
+	auto const sequentialPath{fs::temp_directory_path() / "ArCalc_sweep_sequential.txt"};
+	auto const shardedPath{fs::temp_directory_path() / "ArCalc_sweep_sharded.txt"};
+	auto const shardsPath{ShardedSweep::GetDirectory(shardedPath)};
+	RemoveAfterwards(sequentialPath);
+	RemoveAfterwards(shardedPath);
+	RemoveAfterwards(shardsPath);
+
+	std::ostringstream os{};
+	auto par = Parser{os};
+	for (auto const line : {"_Func Inner s;", "    _Return s s * 1 +;",
+		"_Func Wave x y;", "    _Return x sin y cos * x y + Inner /;",
+		"_Func Flaky x y;", "    _Return 250 x - 7 mod y +;"}) 
+	{
+		par.ParseLine(line);
+	}
+
+	par.ParseLine(std::format("_Sweep Wave x 0 3 0.01 y -1 1 0.004 {}", sequentialPath.string()));
+	par.ParseLine(std::format("_Sweep Wave x 0 3 0.01 y -1 1 0.004 {} 3", shardedPath.string()));
+	EXPECT_TRUE(os.str().empty()) << os.str();
+	EXPECT_TRUE(IO::FileToString(sequentialPath) == IO::FileToString(shardedPath));
+	EXPECT_FALSE(fs::exists(shardsPath));
+
+	// The points past x = 250 are all in the second of the two shards.
+	auto const flakySweep{std::format("_Sweep Flaky x 0 300 1 y 0 400 1 {} 2", shardedPath.string())};
+	fs::remove(shardedPath);
+	EXPECT_THROW(par.ParseLine(flakySweep), ParseError);
+	EXPECT_FALSE(fs::exists(shardedPath));
+
+	auto const firstShardPath{shardsPath / "shard-000000.txt"};
+	ASSERT_TRUE(fs::is_regular_file(firstShardPath));
+	auto const firstShardTime{fs::last_write_time(firstShardPath)};
+	auto const manifest{IO::FileToString(shardsPath / "manifest")};
+	EXPECT_EQ("0", Str::Trim<std::string_view>(manifest.substr(manifest.find('\n'))));
+
+	// Only the failed shard runs again.
+	try {
+		par.ParseLine(flakySweep);
+		ADD_FAILURE() << "Expected the second shard to fail again";
+	} catch (ParseError const& err) {
+		EXPECT_TRUE(err.GetMessage().contains("1 of the 2 shards")) << err.GetMessage();
+		EXPECT_TRUE(err.GetMessage().contains("negative")) << err.GetMessage();
+	}
+	EXPECT_TRUE(firstShardTime == fs::last_write_time(firstShardPath));
+}
+
+PARSER_TEST(Pure_sibling_calls_run_in_parallel) {
+	auto engine = Engine{1U, 3U};
+	std::ostringstream os{};
+	auto session{engine.CreateSession(os)};
+	auto par = Parser{os};
+	for (auto const line : {
+		"_Func Fib n;",     "    _If n 2 <: _Return n;", "    _Return n 1 - Fib n 2 - Fib +;",
+		"_Func Probe n d;", "    _If n 2 <: _Return 0 n d * - 1 mod;", 
+		"    _Return n 1 - d 2 * Probe n 2 - d 2 * 1 + Probe +;",
+		"_Func Bump &x;",   "    _Set x x 1 +;", "    _Return x;",
+		"_Func Counted n;", "    _Set c n;", "    _Return c Bump n Fib +;",
+		"_Func Listed n;",  "    _List;", "    _Return n Fib;",
+	}) {
+		session.ParseLine(line);
+		par.ParseLine(line);
+	}
+
+	auto funMan{par.GetFunMan()};
+	EXPECT_TRUE(funMan.IsPure("Fib"));
+	EXPECT_FALSE(funMan.IsPure("Counted"));
+	EXPECT_FALSE(funMan.IsPure("Listed"));
+
+	for (auto const [expr, expected] : std::initializer_list<std::pair<std::string_view, double>>{
+		{"18 Fib", 2584.0}, {"12 Fib 13 Fib * 2 Fib -", 33551.0}, {"10 Counted 11 Fib +", 155.0}}) 
+	{
+		par.ParseLine(expr);
+		session.ParseLine(expr);
+		EXPECT_EQ(expected, par.GetLitMan().GetLast()) << expr;
+		EXPECT_EQ(expected, session.GetParser().GetLitMan().GetLast()) << expr;
+	}
+
+	// Every branch fails, at a [d] of its own, the first one in order is reported either way.
+	auto const errorOf = [](auto&& parseLine) {
+		try {
+			parseLine("12 1 Probe");
+		} catch (ArCalcException const& err) {
+			return std::format("{} on line {}", err.GetMessage(), err.GetLineNumber());
+		}
+		return std::string{"no error"};
+	};
+	auto const expected{errorOf([&](auto line) { par.ParseLine(line); })};
+	EXPECT_TRUE(expected.contains("[-2048]")) << expected;
+	for ([[maybe_unused]] auto const _ : view::iota(0, 5)) {
+		EXPECT_EQ(expected, errorOf([&](auto line) { session.ParseLine(line); }));
+	}
+}
+
+PARSER_TEST(Engine_sessions_run_concurrently) {
+	constexpr auto SessionCount{8U};
+	constexpr auto LineCount{500U};
+
+	auto engine = Engine{42U};
+	std::vector<std::ostringstream> outputs(SessionCount);
+	std::vector<Engine::Session> sessions{};
+	for (auto& os : outputs) {
+		sessions.push_back(engine.CreateSession(os));
+	}
+
+	std::vector<std::vector<std::uint32_t>> draws(SessionCount);
+	{
+		std::vector<std::jthread> threads{};
+		for (auto const i : view::iota(0U, SessionCount)) {
+			threads.emplace_back([&, i] {
+				auto& session{sessions[i]};
+				// Same names in every session, different values.
+				session.ParseLine(std::format("_Set step {};", i + 1));
+				session.ParseLine("_Func Next n step;");
+				session.ParseLine("    _Return n step +;");
+				session.ParseLine("_Set acc 0;");
+				for (auto const _ : view::iota(0U, LineCount)) {
+					session.ParseLine("_Set acc acc step Next;");
+				}
+				session.ParseLine("acc");
+
+				auto const boundRng{Random::ScopedGenerator{session.GetGenerator()}};
+				for (auto const _ : view::iota(0U, 4U)) {
+					draws[i].push_back(Random::Uint32());
+				}
+			});
+		}
+	}
+
+	auto otherEngine = Engine{42U};
+	for (auto const i : view::iota(0U, SessionCount)) {
+		EXPECT_EQ(std::format("{}\n", (i + 1) * LineCount), outputs[i].str());
+
+		// Sessions start with the same random state as their counterparts of another engine
+		// with the same seed, but not as the other sessions of the same engine.
+		std::ostringstream os{};
+		auto counterpart{otherEngine.CreateSession(os)};
+		auto const boundRng{Random::ScopedGenerator{counterpart.GetGenerator()}};
+		for (auto const draw : draws[i]) {
+			EXPECT_EQ(draw, Random::Uint32());
+		}
+		if (i > 0U) {
+			EXPECT_NE(draws[0], draws[i]);
+		}
+	}
+}
+
+PARSER_TEST(Engine_sessions_save_concurrently) {
+	constexpr auto SessionCount{8U};
+	constexpr auto SaveCount{25U};
+
+	fs::remove(CategoryFile::GetPath("Testing", CategoryFormat::Binary));
+
+	auto engine = Engine{42U};
+	std::vector<std::ostringstream> outputs(SessionCount);
+	std::vector<Engine::Session> sessions{};
+	for (auto& os : outputs) {
+		sessions.push_back(engine.CreateSession(os));
+	}
+
+	std::atomic<size_t> failureCount{};
+	{
+		std::vector<std::jthread> threads{};
+		for (auto const i : view::iota(0U, SessionCount)) {
+			threads.emplace_back([&, i] {
+				for (auto const j : view::iota(0U, SaveCount)) {
+					try {
+						sessions[i].ParseLine(std::format("_Set value{}_{} {};", i, j, i * SaveCount + j));
+						sessions[i].ParseLine(std::format("_Save value{}_{} Testing;", i, j));
+						sessions[i].ParseLine("_Snapshot Testing;");
+					} catch (ArCalcException const&) { ++failureCount; }
+				}
+			});
+		}
+	}
+	EXPECT_EQ(0U, failureCount.load());
+
+	// No save may drop what another one wrote at the same time.
+	std::ostringstream os{};
+	auto loaded{engine.CreateSession(os)};
+	EXPECT_NO_THROW(loaded.ParseLine("_Load Testing;"));
+	for (auto const i : view::iota(0U, SessionCount)) {
+		for (auto const j : view::iota(0U, SaveCount)) {
+			EXPECT_NO_THROW(loaded.ParseLine(std::format("value{}_{};", i, j)));
+			EXPECT_EQ(i * SaveCount + j, loaded.GetParser().GetLitMan().GetLast());
+		}
+	}
+	EXPECT_NO_THROW(loaded.ParseLine("_Restore Testing;"));
 }
 
 PARSER_TEST(Unscope_in_global_scope) {
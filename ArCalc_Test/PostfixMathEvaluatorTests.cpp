@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include <PostfixMathEvaluator.h>
+#include <EvaluatorPool.h>
 #include <../../ArCalc/Source/Parser.h>	
 #include <Util/MathOperator.h>
 #include <Util/IO.h>
@@ -10,7 +11,7 @@
 using namespace ArCalc;
 
 class PostfixMathEvaluatorTests : public testing::Test {
-private:
+protected:
 	inline static FunctionManager s_FunMan{std::cout};
 
 public:
@@ -170,6 +171,32 @@ EVALUATOR_TEST(Normal_number_parsing) {
 	ASSERT_ANY_THROW(ev.Eval("1234e456."));
 }
 
+EVALUATOR_TEST(Correctly_rounded_number_parsing) {
+	auto ev{GenerateTestingInstance()};
+
+	// Exact comparisons on purpose, these must round the same way the compiler does.
+	ASSERT_EQ(0.1, *ev.Eval("0.1"));
+	ASSERT_EQ(0.3, *ev.Eval(".3"));
+	ASSERT_EQ(123.456e-7, *ev.Eval("123.456e-7"));
+	ASSERT_EQ(1.7976931348623157e308, *ev.Eval("1.7976931348623157e308"));
+	ASSERT_EQ(2.2250738585072014e-308, *ev.Eval("2.2250738585072014e-308"));
+	ASSERT_EQ(9007199254740993.0, *ev.Eval("9'007'199'254'740'993"));
+	ASSERT_EQ(std::numbers::pi, *ev.Eval("3.14159'26535'89793'23846'26433'83279"));
+	ASSERT_EQ(123456789012345678901234567890.0, *ev.Eval("123456789012345678901234567890"));
+	ASSERT_EQ(0x1.8p0, *ev.Eval("0x1.8"));
+	ASSERT_EQ(0x123456789ABCDEF0123.0p0, *ev.Eval("0x123456789ABCDEF0123"));
+
+	ASSERT_ANY_THROW(ev.Eval("1e999999999999999999"));
+	ASSERT_ANY_THROW(ev.Eval("1" + std::string(400U, '0') + "e-10"));
+
+	// Too small values become denormals or zero instead.
+	ASSERT_EQ(4.9406564584124654e-324, *ev.Eval("4.9406564584124654e-324"));
+	ASSERT_EQ(0.0, *ev.Eval("1e-400"));
+	ASSERT_TRUE(std::signbit(*ev.Eval("-1e-400")));
+	ASSERT_EQ(0.0, *ev.Eval("1e-999999999999999999"));
+	ASSERT_EQ(0.0, *ev.Eval("0." + std::string(400U, '0') + "1e10"));
+}
+
 EVALUATOR_TEST(Identifier_parsing) {
 	constexpr std::array Names{
 		"some", // Alphabetic characters
@@ -230,6 +257,17 @@ EVALUATOR_TEST(Unary_operators) {
 	ASSERT_DOUBLE_EQ(std::sqrt(A*A + B*B + C*C), *ev.Eval("a a * b b * c c * + + sqrt"));
 }
 
+EVALUATOR_TEST(Operators_next_to_signed_operands) {
+	auto litMan{LitManFromLits({{"a", 4.0}})};
+	auto ev{GenerateTestingInstance(litMan)};
+
+	// A `-` directly followed by an operand is its sign, not part of the operator.
+	ASSERT_DOUBLE_EQ(3.0 * 2.0 + -1.0, *ev.Eval("3 2*-1+"));
+	ASSERT_DOUBLE_EQ(3.0 * -4.0, *ev.Eval("3 -a*"));
+	ASSERT_DOUBLE_EQ(3.0 - 2.0, *ev.Eval("3 2 -"));
+	ASSERT_DOUBLE_EQ(-0.5 - 0.5, *ev.Eval("\t-.5\r\n.5 -\r\n"));
+}
+
 
 EVALUATOR_TEST(Hex_number_parsing) {
 	auto ev{GenerateTestingInstance()};
@@ -395,4 +433,38 @@ EVALUATOR_TEST(Octal_number_parsing) {
 	// No ' at the end.
 	ASSERT_ANY_THROW(ev.Eval("0o1101'"));
 	ASSERT_ANY_THROW(ev.Eval("0o1101.011'"));
+}
+
+EVALUATOR_TEST(Rebinding_to_another_scope) {
+	auto lhsLitMan{LitManFromLits({{"x", 1.0}})};
+	auto rhsLitMan{LitManFromLits({{"x", 2.0}})};
+	auto ev{GenerateTestingInstance(lhsLitMan)};
+
+	ASSERT_DOUBLE_EQ(1.0, *ev.Eval("x"));
+	// Leave the evaluator in the middle of an expression.
+	ASSERT_ANY_THROW(ev.Eval("x 5"));
+
+	ev.Rebind(rhsLitMan, s_FunMan);
+	ASSERT_DOUBLE_EQ(2.0, *ev.Eval("x"));
+	ASSERT_DOUBLE_EQ(12.0, *ev.Eval("x 10 +"));
+}
+
+EVALUATOR_TEST(Pooled_evaluators_are_reused) {
+	auto litMan{LitManFromLits({{"x", 4.0}})};
+
+	{ auto lease{EvaluatorPool::Acquire(litMan, s_FunMan)}; } // Warm-up.
+	auto const idleCount{EvaluatorPool::IdleCount()};
+	ASSERT_NE(0U, idleCount);
+
+	for (auto const i : view::iota(0U, 10U)) {
+		auto lease{EvaluatorPool::Acquire(litMan, s_FunMan)};
+		ASSERT_EQ(idleCount - 1, EvaluatorPool::IdleCount()) << i;
+		ASSERT_DOUBLE_EQ(4.0 + i, *lease->Eval(std::format("x {} +", i))) << i;
+	}
+	ASSERT_EQ(idleCount, EvaluatorPool::IdleCount());
+
+	// Throwing must still give the evaluator back, and in a clean state.
+	ASSERT_ANY_THROW(EvaluatorPool::Acquire(litMan, s_FunMan)->Eval("x x"));
+	ASSERT_EQ(idleCount, EvaluatorPool::IdleCount());
+	ASSERT_DOUBLE_EQ(4.0, *EvaluatorPool::Acquire(litMan, s_FunMan)->Eval("x"));
 }
\ No newline at end of file
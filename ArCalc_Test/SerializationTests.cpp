@@ -3,6 +3,9 @@
 #include <Util/IO.h>
 #include <Util/LiteralManager.h>
 #include <Util/FunctionManager.h>
+#include <Util/BinaryStream.h>
+#include <Util/NumberFormatter.h>
+#include <Exception/ArCalcException.h>
 
 #define SER_TEST(_testName) TEST_F(SerializationTests, _testName)
 
@@ -34,6 +37,31 @@ SER_TEST(Serializing_a_math_constant) {
 	}
 }
 
+SER_TEST(Numbers_are_saved_exactly) {
+	constexpr std::array Values{
+		0.1 + 0.2, 1.0 / 3.0, 413.0, -0.0, 1e-300, 6.02214076e23, 
+		std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min(), -2.2250738585072014e-308,
+	};
+
+	std::stringstream outputSS{};
+	LiteralManager litMan{outputSS};
+	for (auto const value : Values) {
+		NumberFormatter::Buffer buffer{};
+		auto const str{NumberFormatter::Format(value, buffer)};
+		EXPECT_EQ(std::format("{}", value), str);
+
+		litMan.Add("_Value", value);
+		std::stringstream ss{};
+		litMan.Serialize("_Value", ss);
+		litMan.Delete("_Value");
+
+		(void) IO::Input<char>(ss);
+		litMan.Deserialize(ss);
+		EXPECT_EQ(std::bit_cast<std::uint64_t>(value), std::bit_cast<std::uint64_t>(*litMan.Get("_Value"))) << str;
+		litMan.Delete("_Value");
+	}
+}
+
 SER_TEST(Serializing_a_function) {
 	constexpr auto RepCount{2U};
 	constexpr auto Name{"_MyFunc"};
@@ -82,4 +110,71 @@ SER_TEST(Serializing_a_function) {
 				<< std::format("iteration: {}, line index: {}", nSer, nCodeLine);
 		}
 	}
+}
+
+SER_TEST(Binary_round_trip) {
+	constexpr auto LitName{"_Hello"};
+	constexpr auto FuncName{"_MyFunc"};
+	constexpr auto Value{0.1 + 0.2}; // Not exactly representable in a short decimal.
+
+	std::stringstream outputSS{};
+	LiteralManager litMan{outputSS};
+	litMan.Add(LitName, Value);
+
+	auto funMan = FunctionManager{outputSS};
+	funMan.BeginDefination(FuncName, 0U);
+	funMan.AddParam("a");
+	funMan.AddRefParam("c");
+	funMan.AddCodeLine("_Set c a;");
+	funMan.AddCodeLine("_Return;");
+	funMan.EndDefination();
+	auto const func{funMan.Get(FuncName)};
+
+	std::string bytes{};
+	BinaryWriter out{bytes};
+	litMan.SerializeBinary(LitName, out);
+	funMan.SerializeBinary(FuncName, out);
+
+	litMan.Delete(LitName);
+	funMan.Delete(FuncName);
+
+	BinaryReader in{bytes};
+	ASSERT_EQ('C', static_cast<char>(in.ReadU8()));
+	litMan.DeserializeBinary(in);
+	ASSERT_EQ('F', static_cast<char>(in.ReadU8()));
+	funMan.DeserializeBinary(in);
+	ASSERT_TRUE(in.IsAtEnd());
+
+	ASSERT_EQ(Value, *litMan.Get(LitName));
+	auto const& deserialized{funMan.Get(FuncName)};
+	ASSERT_EQ(func.ReturnType, deserialized.ReturnType);
+	ASSERT_EQ(func.CodeLines, deserialized.CodeLines);
+	ASSERT_EQ(func.Params.size(), deserialized.Params.size());
+	for (auto const i : view::iota(0U, func.Params.size())) {
+		ASSERT_EQ(func.Params[i].GetName(), deserialized.Params[i].GetName()) << i;
+		ASSERT_EQ(func.Params[i].IsPassedByRef(), deserialized.Params[i].IsPassedByRef()) << i;
+	}
+
+	// Truncated data must be reported, not read out of bounds.
+	BinaryReader truncated{std::string_view{bytes}.substr(0U, bytes.size() - 1)};
+	(void) truncated.ReadU8();
+	litMan.DeserializeBinary(truncated);
+	(void) truncated.ReadU8();
+	ASSERT_ANY_THROW(funMan.DeserializeBinary(truncated));
+
+	// So must counts that could not fit in what is left, before anything is allocated for them.
+	for (auto const bBadLineCount : {false, true}) {
+		std::string corrupted{};
+		BinaryWriter corruptedOut{corrupted};
+		corruptedOut.WriteString(FuncName);
+		if (bBadLineCount) {
+			corruptedOut.WriteU32(0U);
+			corruptedOut.WriteU8(0U);
+		}
+		corruptedOut.WriteU32(0xFFFF'FFFFU);
+		corruptedOut.WriteString("_Return;");
+
+		BinaryReader corruptedIn{corrupted};
+		ASSERT_THROW(funMan.DeserializeBinary(corruptedIn), IOError) << bBadLineCount;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "pch.h"
+
+#include <../../ArCalc/Source/Server.h>
+#include <Util/LocalSocket.h>
+
+#define SERVER_TEST(_testName) TEST_F(ServerTests, _testName)
+
+using namespace ArCalc;
+using namespace std::chrono_literals;
+
+class ServerTests : public testing::Test {
+public:
+	/// Serves on another thread for as long as it lives.
+	class RunningServer {
+	public:
+		RunningServer(Server::Options const& options) 
+			: m_Server{fs::temp_directory_path() / "ArCalcServerTests.sock", options} {}
+
+		~RunningServer() { 
+			m_Server.Stop(); 
+		}
+
+		Server& operator*() { return m_Server; }
+		Server* operator->() { return &m_Server; }
+
+	private:
+		Server m_Server;
+		std::jthread m_Thread{[this] { m_Server.Run(); }};
+	};
+
+	// Reads [count] answers, or as many as arrive before giving up.
+	static std::vector<std::string> ReadAnswers(LocalSocket& socket, size_t count) {
+		auto res = std::vector<std::string>{};
+		auto received = std::string{};
+		auto buffer = std::array<char, 4096U>{};
+		auto const giveUpAt{std::chrono::steady_clock::now() + 10s};
+
+		auto answer = std::string{};
+		auto lineStart = size_t{};
+		while (res.size() < count && std::chrono::steady_clock::now() < giveUpAt) {
+			auto const size{socket.Receive(buffer, 100ms)};
+			if (size == 0U) {
+				break; // Closed by the server.
+			}
+
+			if (size) {
+				received.append(buffer.data(), *size);
+			}
+
+			for (auto end{received.find('\n', lineStart)}; end != std::string::npos && res.size() < count; 
+				end = received.find('\n', lineStart)) 
+			{
+				auto const line{std::string_view{received}.substr(lineStart, end + 1U - lineStart)};
+				lineStart = end + 1U;
+				if (line == Server::sc_EndOfAnswer) {
+					res.push_back(std::exchange(answer, {}));
+				} else {
+					answer += line;
+				}
+			}
+		}
+
+		return res;
+	}
+};
+
+SERVER_TEST(Every_connection_has_its_own_session) {
+	constexpr auto ClientCount{6U};
+	constexpr auto PipelinedCount{1000U};
+
+	auto server = RunningServer{{.WorkerCount = 2U}};
+	{
+		std::vector<std::jthread> clients{};
+		for (auto const i : view::iota(0U, ClientCount)) {
+			clients.emplace_back([&, i] {
+				auto socket{LocalSocket::Connect(server->GetPath())};
+				socket.Send(std::format("_Set x {}\nx 2 *\n", i));
+				socket.Send("undefinedName\n");
+
+				auto const answers{ReadAnswers(socket, 3U)};
+				ASSERT_EQ(3U, answers.size());
+				EXPECT_EQ(std::format("x = {}\n", i), answers[0]);
+				EXPECT_EQ(std::format("{}\n", i * 2U), answers[1]);
+				EXPECT_TRUE(answers[2].starts_with("ERROR: ")) << answers[2];
+				EXPECT_TRUE(answers[2].ends_with("[EE 2]\n")) << answers[2];
+
+				// Sent without waiting, so they are evaluated in batches.
+				auto lines = std::string{};
+				for (auto const _ : view::iota(0U, PipelinedCount)) {
+					lines += "_Set x x 1 +;\n";
+				}
+				socket.Send(lines + "x\n");
+
+				auto const pipelined{ReadAnswers(socket, PipelinedCount + 1U)};
+				ASSERT_EQ(PipelinedCount + 1U, pipelined.size());
+				EXPECT_EQ(std::format("{}\n", i + PipelinedCount), pipelined.back());
+			});
+		}
+	}
+
+	auto const report{server->GetReport()};
+	EXPECT_EQ(ClientCount, report.ConnectionCount);
+	EXPECT_EQ(ClientCount * (PipelinedCount + 4U), report.RequestCount);
+	EXPECT_LT(report.BatchCount, report.RequestCount);
+	EXPECT_LE(report.LatencyP50, report.LatencyP99);
+	EXPECT_LE(report.LatencyP99, report.LatencyMax);
+	EXPECT_GT(report.RequestsPerSecond, 0.0);
+}
+
+SERVER_TEST(Idle_sessions_are_evicted) {
+	auto server = RunningServer{{.WorkerCount = 1U, .IdleTimeout = 200ms}};
+
+	auto socket{LocalSocket::Connect(server->GetPath())};
+	socket.Send("_Set x 1\n");
+	ASSERT_EQ(std::vector<std::string>{"x = 1\n"}, ReadAnswers(socket, 1U));
+
+	// Closed by the server after going idle, so nothing more arrives.
+	EXPECT_TRUE(ReadAnswers(socket, 1U).empty());
+	EXPECT_EQ(1U, server->GetReport().EvictionCount);
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <Util/Util.h>
 #include <Util/Str.h>
 #include <Util/Random.h>
+#include <Util/LineArena.h>
 
 using namespace ArCalc;
 
@@ -75,6 +76,32 @@ STR_TEST(SplitOn_no_chaining) {
 	}
 }
 
+STR_TEST(SplitOn_using_an_arena) {
+	constexpr auto Line{"  _Save   myFunc\tmyCategory "};
+	std::vector<std::string_view> const expected{"_Save", "myFunc", "myCategory"};
+
+	LineArena arena{};
+	for (auto const i : view::iota(0U, 3U)) {
+		auto const tokens{Str::SplitOnSpaces(arena.Resource(), Line)};
+		ASSERT_TRUE(range::equal(expected, tokens)) << i;
+		ASSERT_EQ(Str::SplitOn(arena.Resource(), "", "+"), std::pmr::vector<std::string_view>{""});
+		arena.Reset();
+	}
+}
+
+STR_TEST(Character_classes) {
+	for (auto const i : view::iota(0, 256)) {
+		auto const c{static_cast<char>(i)};
+		auto const uc{static_cast<unsigned char>(i)};
+		ASSERT_EQ(Str::IsWhiteSpace(c), std::isspace(uc) != 0) << i;
+		ASSERT_EQ(Str::IsAlpha(c), std::isalpha(uc) != 0) << i;
+		ASSERT_EQ(Str::IsDigit(c), std::isdigit(uc) != 0) << i;
+		ASSERT_EQ(Str::IsAlNum(c), std::isalnum(uc) != 0) << i;
+		ASSERT_EQ(Str::IsHexDigit(c), std::isxdigit(uc) != 0) << i;
+		ASSERT_EQ(Str::IsIdentChar(c), std::isalnum(uc) != 0 || c == '_') << i;
+	}
+}
+
 STR_TEST(GetFirstTokenIndices) {
 	using Str::Secret::GetFirstTokenIndices;
 
@@ -2,6 +2,8 @@
 
 #include <Util/Util.h>
 #include <Util/Random.h>
+#include <Util/Keyword.h>
+#include <Util/ThreadPool.h>
 
 #define UTIL_TEST(_testName) TEST_F(UtilTests, _testName)
 
@@ -94,4 +96,100 @@ UTIL_TEST(Union) {
 			}
 		}
 	}
+}
+
+UTIL_TEST(Keyword_lookup) {
+	auto const [begin, end] {Keyword::GetAllKeywordTypes()};
+	for (auto const& info : range::subrange(begin, end)) {
+		ASSERT_EQ(info.Type, Keyword::FromString(info.Glyph));
+		ASSERT_TRUE(Keyword::IsValid(info.Glyph));
+
+		// Near misses must not be picked up.
+		ASSERT_FALSE(Keyword::IsValid(info.Glyph.substr(1)));
+		ASSERT_FALSE(Keyword::IsValid(info.Glyph.substr(0, info.Glyph.size() - 1)));
+		ASSERT_FALSE(Keyword::IsValid(std::string{info.Glyph} + 'e'));
+	}
+
+	ASSERT_FALSE(Keyword::IsValid(""));
+	ASSERT_FALSE(Keyword::IsValid("_"));
+	ASSERT_FALSE(Keyword::IsValid("_pi"));
+}
+
+UTIL_TEST(Thread_pool_fork_join) {
+	auto pool = ThreadPool{3U};
+	ASSERT_EQ(3U, pool.GetWorkerCount());
+
+	// Nested forks, deeper than there are threads.
+	std::function<std::int64_t(int)> fib{};
+	fib = [&](int n) -> std::int64_t {
+		if (n < 2) {
+			return n;
+		}
+
+		auto lhs = std::int64_t{};
+		auto rhs = std::int64_t{};
+		pool.Invoke([&] { lhs = fib(n - 1); }, [&] { rhs = fib(n - 2); });
+		return lhs + rhs;
+	};
+	ASSERT_EQ(6765, fib(20));
+
+	constexpr auto Count{100'000U};
+	std::vector<std::uint32_t> squares(Count);
+	pool.ForEach(Count, 64U, [&](size_t i) { squares[i] = static_cast<std::uint32_t>(i * i % 1000U); });
+	for (auto const i : view::iota(size_t{}, size_t{Count})) {
+		ASSERT_EQ(i * i % 1000U, squares[i]);
+	}
+
+	// The first exception thrown by a task comes out of the join.
+	ASSERT_THROW(pool.ForEach(Count, 64U, [](size_t i) { 
+		if (i == Count / 2U) {
+			throw std::runtime_error{"Task failed"};
+		}
+	}), std::runtime_error);
+}
+
+UTIL_TEST(Thread_pool_short_lived_groups) {
+	std::atomic<size_t> runCount{};
+	{
+		auto pool = ThreadPool{2U};
+
+		// Freed as soon as they are done, so their last task must not touch them after that.
+		for ([[maybe_unused]] auto const _ : view::iota(0, 2000)) {
+			auto pGroup = std::make_unique<ThreadPool::TaskGroup>(pool);
+			pGroup->Run([&] { ++runCount; });
+			pGroup->Wait();
+		}
+
+		// Still queued when the pool goes away, which runs them rather than dropping them.
+		for ([[maybe_unused]] auto const _ : view::iota(0, 1000)) {
+			pool.Submit([&] { ++runCount; });
+		}
+	}
+	ASSERT_EQ(3000U, runCount);
+}
+
+UTIL_TEST(Thread_pool_state_per_chunk) {
+	auto pool = ThreadPool{3U};
+
+	std::atomic<size_t> total{};
+	std::atomic<bool> bShared{};
+
+	// Made and destroyed once per chunk, on the thread running it.
+	struct State {
+		State(std::atomic<size_t>& total) : pTotal{&total} {}
+		State(State const&) = delete;
+		~State() { *pTotal += Sum; }
+
+		std::atomic<size_t>* pTotal;
+		std::thread::id Owner{std::this_thread::get_id()};
+		size_t Sum{};
+	};
+
+	pool.ForEach(10'000U, 100U, [&] { return State{total}; }, [&](State& state, size_t i) {
+		bShared = bShared || state.Owner != std::this_thread::get_id();
+		state.Sum += i;
+	});
+
+	ASSERT_FALSE(bShared);
+	ASSERT_EQ(9'999U * 10'000U / 2U, total);
 }
\ No newline at end of file